@@ -0,0 +1,340 @@
+// Copyright (c) 2025 Clarisma / GeoDesk contributors
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace clarisma {
+
+/// Counters collected by a WorkStealingTaskEngine
+///
+struct WorkStealingStats
+{
+	uint64_t tasks = 0;				// tasks processed by workers
+	uint64_t spawned = 0;			// child tasks created via spawn()
+	uint64_t steals = 0;			// tasks taken from another worker
+	uint64_t failedSteals = 0;		// scans of all workers that found nothing
+	uint64_t workerWaits = 0;		// times a worker went idle
+	uint64_t producerWaits = 0;		// times postWork() blocked on a full queue
+	uint64_t outputWaits = 0;		// times postOutput() blocked on a full queue
+
+	void add(const WorkStealingStats& other)
+	{
+		tasks += other.tasks;
+		spawned += other.spawned;
+		steals += other.steals;
+		failedSteals += other.failedSteals;
+		workerWaits += other.workerWaits;
+		producerWaits += other.producerWaits;
+		outputWaits += other.outputWaits;
+	}
+};
+
+/// A variant of TaskEngine that gives each worker its own deque
+/// instead of having all workers contend for one shared queue.
+///
+/// It follows the same CRTP protocol, so an engine can switch
+/// between the two simply by changing its base class:
+///
+/// - WorkContext is constructed with a `Derived*` (in start()) and
+///   implements processTask(Task&), afterTasks() and harvestResults()
+/// - Derived implements processTask(OutputTask&), which is called on
+///   the single output thread
+///
+/// In addition:
+///
+/// - A worker may call spawn() to create child tasks, which it will
+///   process next (they go to the front of its deque), unless an idle
+///   worker steals them first. This allows large tasks to be split up.
+/// - Derived may implement reportStats(const WorkStealingStats&),
+///   which end() calls once all threads have finished.
+///
+/// Tasks posted via postWork() are distributed round-robin; each
+/// worker processes its own deque in FIFO order, so the order in
+/// which tasks are posted is largely preserved. A worker whose deque
+/// is empty steals from the front of the others.
+///
+template <typename Derived, typename WorkContext, typename Task, typename OutputTask>
+class WorkStealingTaskEngine
+{
+public:
+	explicit WorkStealingTaskEngine(int threadCount, int queueSize = 0) :
+		threadCount_(threadCount > 0 ? threadCount : 1),
+		queueSize_(queueSize > 0 ? queueSize : threadCount_ * 8)
+	{
+	}
+
+	~WorkStealingTaskEngine()
+	{
+		if (started_) end();
+	}
+
+	int threadCount() const { return threadCount_; }
+	std::deque<WorkContext>& workContexts() { return contexts_; }
+	const WorkStealingStats& stats() const { return stats_; }
+
+	void start()
+	{
+		Derived* self = static_cast<Derived*>(this);
+		for (int i = 0; i < threadCount_; i++)
+		{
+			contexts_.emplace_back(self);
+		}
+		workers_ = std::make_unique<Worker[]>(threadCount_);
+		stats_ = WorkStealingStats();
+		ending_ = false;
+		outputEnding_ = false;
+		started_ = true;
+		outputThread_ = std::thread(&WorkStealingTaskEngine::processOutput, this);
+		threads_.reserve(threadCount_);
+		for (int i = 0; i < threadCount_; i++)
+		{
+			threads_.emplace_back(&WorkStealingTaskEngine::work, this, i);
+		}
+	}
+
+	/// Posts a task from the producer (i.e. any thread other than
+	/// the workers). Blocks while the workers' deques are full.
+	///
+	void postWork(Task&& task)
+	{
+		if (queued_.load() >= queueSize_)
+		{
+			std::unique_lock lock(idleMutex_);
+			stats_.producerWaits++;
+			producerWaiting_ = true;
+			spaceAvailable_.wait(lock, [this]() { return queued_.load() < queueSize_; });
+			producerWaiting_ = false;
+		}
+		pending_.fetch_add(1);
+		Worker& worker = workers_[nextWorker_];
+		nextWorker_ = (nextWorker_ + 1) % threadCount_;
+		{
+			std::lock_guard lock(worker.mutex);
+			worker.tasks.push_back(std::move(task));
+		}
+		taskQueued();
+	}
+
+	/// Creates a child task. Must be called from within
+	/// WorkContext::processTask(). Never blocks.
+	///
+	void spawn(Task&& task)
+	{
+		pending_.fetch_add(1);
+		int index = (currentEngine_ == this) ? currentWorker_ : 0;
+		Worker& worker = workers_[index];
+		{
+			std::lock_guard lock(worker.mutex);
+			worker.tasks.push_front(std::move(task));
+		}
+		worker.stats.spawned++;
+		taskQueued();
+	}
+
+	void postOutput(OutputTask&& task)
+	{
+		std::unique_lock lock(outputMutex_);
+		if (output_.size() >= static_cast<size_t>(queueSize_))
+		{
+			outputStats_.outputWaits++;
+			outputSpace_.wait(lock, [this]()
+			{
+				return output_.size() < static_cast<size_t>(queueSize_);
+			});
+		}
+		output_.push(std::move(task));
+		lock.unlock();
+		outputAvailable_.notify_one();
+	}
+
+	/// Waits for all tasks (including their children) and all output
+	/// to be processed, then shuts down the threads.
+	///
+	void end()
+	{
+		{
+			std::lock_guard lock(idleMutex_);
+			ending_ = true;
+		}
+		workAvailable_.notify_all();
+		for (std::thread& thread : threads_) thread.join();
+		threads_.clear();
+		{
+			std::lock_guard lock(outputMutex_);
+			outputEnding_ = true;
+		}
+		outputAvailable_.notify_one();
+		outputThread_.join();
+		started_ = false;
+
+		for (WorkContext& context : contexts_) context.harvestResults();
+		for (int i = 0; i < threadCount_; i++) stats_.add(workers_[i].stats);
+		stats_.add(outputStats_);
+		static_cast<Derived*>(this)->reportStats(stats_);
+	}
+
+protected:
+	/// CRTP hook, called at the end of end()
+	///
+	void reportStats(const WorkStealingStats&) {}
+
+private:
+	struct Worker
+	{
+		std::mutex mutex;
+		std::deque<Task> tasks;
+		WorkStealingStats stats;
+		uint32_t random = 0;
+	};
+
+	void taskQueued()
+	{
+		queued_.fetch_add(1);
+		if (idleCount_.load() > 0)
+		{
+			std::lock_guard lock(idleMutex_);
+			workAvailable_.notify_one();
+		}
+	}
+
+	void taskDequeued()
+	{
+		queued_.fetch_sub(1);
+		if (producerWaiting_.load())
+		{
+			std::lock_guard lock(idleMutex_);
+			spaceAvailable_.notify_one();
+		}
+	}
+
+	bool popOwn(Worker& worker, Task& task)
+	{
+		std::lock_guard lock(worker.mutex);
+		if (worker.tasks.empty()) return false;
+		task = std::move(worker.tasks.front());
+		worker.tasks.pop_front();
+		return true;
+	}
+
+	bool steal(int index, Task& task)
+	{
+		Worker& self = workers_[index];
+		self.random = self.random * 1664525 + 1013904223;
+		int start = static_cast<int>((self.random >> 8) % threadCount_);
+		for (int i = 0; i < threadCount_; i++)
+		{
+			int victimIndex = (start + i) % threadCount_;
+			if (victimIndex == index) continue;
+			Worker& victim = workers_[victimIndex];
+			std::lock_guard lock(victim.mutex);
+			if (victim.tasks.empty()) continue;
+			task = std::move(victim.tasks.front());
+			victim.tasks.pop_front();
+			self.stats.steals++;
+			return true;
+		}
+		self.stats.failedSteals++;
+		return false;
+	}
+
+	void work(int index)
+	{
+		currentEngine_ = this;
+		currentWorker_ = index;
+		Worker& self = workers_[index];
+		self.random = static_cast<uint32_t>(index) * 2654435761u + 1;
+		WorkContext& context = contexts_[index];
+		Task task;
+		for (;;)
+		{
+			if (popOwn(self, task) || steal(index, task))
+			{
+				taskDequeued();
+				context.processTask(task);
+				self.stats.tasks++;
+				if (pending_.fetch_sub(1) == 1 && ending_.load())
+				{
+					// Last task is done: let idle workers exit
+					std::lock_guard lock(idleMutex_);
+					workAvailable_.notify_all();
+				}
+				continue;
+			}
+
+			std::unique_lock lock(idleMutex_);
+			if (ending_.load() && pending_.load() == 0) break;
+			if (queued_.load() > 0) continue;
+				// another worker still has tasks; retry stealing
+			self.stats.workerWaits++;
+			idleCount_.fetch_add(1);
+			workAvailable_.wait(lock, [this]()
+			{
+				return queued_.load() > 0 || (ending_.load() && pending_.load() == 0);
+			});
+			idleCount_.fetch_sub(1);
+		}
+		context.afterTasks();
+		currentEngine_ = nullptr;
+	}
+
+	void processOutput()
+	{
+		Derived* self = static_cast<Derived*>(this);
+		std::unique_lock lock(outputMutex_);
+		for (;;)
+		{
+			outputAvailable_.wait(lock, [this]() { return !output_.empty() || outputEnding_; });
+			if (output_.empty()) break;
+			OutputTask task = std::move(output_.front());
+			output_.pop();
+			lock.unlock();
+			outputSpace_.notify_one();
+			self->processTask(task);
+			lock.lock();
+		}
+	}
+
+	static inline thread_local const void* currentEngine_ = nullptr;
+	static inline thread_local int currentWorker_ = 0;
+
+	const int threadCount_;
+	const int queueSize_;
+	int nextWorker_ = 0;			// producer thread only
+	bool started_ = false;
+	std::unique_ptr<Worker[]> workers_;
+	std::deque<WorkContext> contexts_;
+	std::vector<std::thread> threads_;
+
+	/// Tasks sitting in any deque
+	std::atomic<int> queued_ = 0;
+	/// Tasks posted or spawned but not yet completed
+	std::atomic<int64_t> pending_ = 0;
+	std::atomic<int> idleCount_ = 0;
+	std::atomic<bool> producerWaiting_ = false;
+	std::atomic<bool> ending_ = false;
+	std::mutex idleMutex_;
+	std::condition_variable workAvailable_;
+	std::condition_variable spaceAvailable_;
+
+	std::queue<OutputTask> output_;
+	bool outputEnding_ = false;
+	std::mutex outputMutex_;
+	std::condition_variable outputAvailable_;
+	std::condition_variable outputSpace_;
+	std::thread outputThread_;
+	WorkStealingStats outputStats_;
+
+	WorkStealingStats stats_;
+};
+
+} // namespace clarisma
@@ -0,0 +1,70 @@
+// Copyright (c) 2025 Clarisma / GeoDesk contributors
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#ifdef CLARISMA_WITH_ZSTD
+
+#pragma once
+
+#include <vector>
+#include <clarisma/alloc/Block.h>
+
+struct ZSTD_CCtx_s;
+struct ZSTD_DCtx_s;
+
+namespace clarisma {
+
+/// Compresses chunks with zstd, optionally using a dictionary.
+/// Each thread needs its own compressor; the dictionary is
+/// digested once and reused for every chunk.
+///
+class ZstdCompressor
+{
+public:
+    static constexpr int DEFAULT_LEVEL = 9;
+
+    explicit ZstdCompressor(int level = DEFAULT_LEVEL);
+    ~ZstdCompressor();
+    ZstdCompressor(const ZstdCompressor&) = delete;
+    ZstdCompressor& operator=(const ZstdCompressor&) = delete;
+
+    void setDictionary(const uint8_t* data, size_t size);
+
+    /// @brief Compresses the given data into a chunk with the following format:
+    /// Byte 0-3  size_uncompressed
+    /// Byte 4-7  checksum (CRC32C)
+    /// Byte 8-n  zstd frame
+    ///
+    ByteBlock compressSealedChunk(const uint8_t* data, size_t size);
+
+private:
+    ZSTD_CCtx_s* ctx_;
+};
+
+class ZstdDecompressor
+{
+public:
+    ZstdDecompressor();
+    ~ZstdDecompressor();
+    ZstdDecompressor(const ZstdDecompressor&) = delete;
+    ZstdDecompressor& operator=(const ZstdDecompressor&) = delete;
+
+    void setDictionary(const uint8_t* data, size_t size);
+    ByteBlock uncompressSealedChunk(const uint8_t* data, size_t size);
+
+private:
+    ZSTD_DCtx_s* ctx_;
+};
+
+namespace Zstd
+{
+/// Trains a dictionary of at most `maxSize` bytes on the given
+/// samples (zstd recommends about 100 times as much sample data
+/// as the size of the dictionary). Returns an empty block if
+/// the samples are unsuitable (e.g. too few or too small).
+///
+ByteBlock trainDictionary(const std::vector<ByteBlock>& samples, size_t maxSize);
+}
+
+} // namespace clarisma
+
+#endif
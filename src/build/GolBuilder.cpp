@@ -3,6 +3,7 @@
 
 #include "GolBuilder.h"
 
+#include <clarisma/cli/ConsoleWriter.h>
 #include <clarisma/io/FilePath.h>
 #include <clarisma/io/FileSystem.h>
 #include <clarisma/sys/SystemInfo.h>
@@ -39,6 +40,12 @@ void GolBuilder::build(const char* golPath, int startPhase)
 		threadCount_ = 4 * cores;
 	}
 
+	for (int& phaseThreadCount : phaseThreadCounts_)
+	{
+		phaseThreadCount = threadCount_;
+	}
+	memory_.start(settings_.maxMemory());
+
 	console().start("Analyzing...");
 	// SystemInfo sysinfo;
 	calculateWork();
@@ -69,8 +76,18 @@ void GolBuilder::build(const char* golPath, int startPhase)
 		featurePiles_.openExisting(path.c_str());
 	}
 	if (startPhase <= SORT) sort();
-	if (startPhase <= VALIDATE) validate();
-	compile();
+	if (startPhase <= VALIDATE && settings_.overlapPhases())
+	{
+		validateAndCompile();
+	}
+	else
+	{
+		if (startPhase <= VALIDATE) validate();
+		compile();
+	}
+
+	memory_.stop();
+	reportMemory();
 
 	if(indexFinalizerThread_.joinable()) indexFinalizerThread_.join();
 		// we have to wait for the indexes to be released and closed
@@ -89,8 +106,10 @@ void GolBuilder::analyze(bool full)
 	NodeCountTable nodeCounts;
 	if (full)
 	{
+		beginPhase(ANALYZE, workerMemory(ANALYZE));
 		Analyzer analyzer(this);
 		analyzer.analyze(settings_.sourcePath().c_str());
+		endPhase(ANALYZE);
 		stats_ = analyzer.osmStats();
 		metadata_ = analyzer.metadata();
 
@@ -171,8 +190,10 @@ void GolBuilder::prepare()
 
 void GolBuilder::sort()
 {
+	beginPhase(SORT, workerMemory(SORT));
 	Sorter sorter(this);
 	sorter.sort(settings_.sourcePath().c_str());
+	endPhase(SORT);
 
 	// Console::get()->setTask("Clearing indexes...");
 	indexFinalizerThread_ = std::thread(&GolBuilder::finalizeIndexes, this);
@@ -200,14 +221,115 @@ void GolBuilder::finalizeIndexes()
 
 void GolBuilder::validate()
 {
+	beginPhase(VALIDATE, workerMemory(VALIDATE));
 	Validator validator(this);
 	validator.validate();
+	endPhase(VALIDATE);
 }
 
 void GolBuilder::compile()
 {
+	beginPhase(COMPILE, workerMemory(COMPILE));
 	Compiler compiler(this);
 	compiler.compile();
+	endPhase(COMPILE);
+}
+
+void GolBuilder::validateAndCompile()
+{
+	if(Console::verbosity() >= Console::Verbosity::VERBOSE)
+	{
+		Console::log("Started validating & compiling");
+	}
+	// Both phases share the budget, with the same number of workers each
+	beginPhase(VALIDATE, workerMemory(VALIDATE) + workerMemory(COMPILE));
+	phaseThreadCounts_[COMPILE] = phaseThreadCounts_[VALIDATE];
+	Validator validator(this);
+	Compiler compiler(this);
+	compiler.beginOverlapped(validator.exportTables());
+	validator.validate(&compiler);
+	compiler.endCompile();
+	endPhase(VALIDATE);
+	peakMemory_[COMPILE] = peakMemory_[VALIDATE];
+}
+
+static const char* PHASE_NAMES[] = { "Analyze", "Sort", "Validate", "Compile" };
+
+void GolBuilder::beginPhase(int phase, uint64_t workerMemory)
+{
+	phaseThreadCounts_[phase] = memory_.beginPhase(threadCount_, workerMemory);
+	if(memory_.limit() && Console::verbosity() >= Console::Verbosity::VERBOSE)
+	{
+		ConsoleWriter().timestamp() << PHASE_NAMES[phase] << ": Using "
+			<< phaseThreadCounts_[phase] << " of " << threadCount_ << " threads ("
+			<< workerMemory / (1024 * 1024) << " MB per thread)";
+	}
+	// The Analyzer and Sorter are paced by the single thread that
+	// reads the PBF, so only the pile-based phases are governed
+	if (settings_.adaptiveThreads() && phase >= VALIDATE)
+	{
+		int workers = phaseThreadCounts_[phase];
+		if (settings_.overlapPhases()) workers *= 2;
+			// Validator and Compiler workers share the same limit
+		concurrency_.begin(workers);
+	}
+}
+
+void GolBuilder::endPhase(int phase)
+{
+	peakMemory_[phase] = memory_.endPhase();
+	if (settings_.adaptiveThreads() && phase >= VALIDATE)
+	{
+		concurrency_.end();
+		concurrency_.report(PHASE_NAMES[phase]);
+	}
+}
+
+/// Returns a rough estimate of the memory used by each worker thread
+/// during the given phase.
+///
+uint64_t GolBuilder::workerMemory(int phase) const
+{
+	constexpr uint64_t MB = 1024 * 1024;
+	switch (phase)
+	{
+	case ANALYZE:
+		// Node-count table, string statistics and the OSM blocks
+		// being decoded
+		return sizeof(uint32_t) * NodeCountTable::TABLE_SIZE + 64 * MB;
+	case SORT:
+		// Piles and feature data of the current batch of blocks
+		return 256 * MB;
+	default:
+	{
+		// The Validator and the Compiler work on one pile at a time,
+		// so their memory use is governed by the largest pile: the
+		// Validator's arena and index are about twice the size of the
+		// pile, the Compiler's TileModel and output about five times
+		uint64_t largestPile = 0;
+		for (int pile = 1; pile <= tileCatalog_.tileCount(); pile++)
+		{
+			largestPile = std::max<uint64_t>(largestPile, tileSizeEstimates_[pile]);
+		}
+		largestPile *= settings_.featurePilesPageSize();
+		return std::max(largestPile * (phase == VALIDATE ? 3 : 6), 64 * MB);
+	}
+	}
+}
+
+void GolBuilder::reportMemory() const
+{
+	if(Console::verbosity() < Console::Verbosity::VERBOSE) return;
+	for (int phase = ANALYZE; phase <= COMPILE; phase++)
+	{
+		if (peakMemory_[phase] == 0) continue;
+			// phase was skipped
+		char buf[128];
+		snprintf(buf, sizeof(buf), "%-10s peak memory %8.1f MB (%d threads)",
+			PHASE_NAMES[phase], peakMemory_[phase] / (1024.0 * 1024.0),
+			phaseThreadCounts_[phase]);
+		ConsoleWriter().timestamp() << buf;
+	}
 }
 
 #ifdef GEODESK_PYTHON
@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: AGPL-3.0-only
 
 #pragma once
+#include <atomic>
 #include <filesystem>
 #include <clarisma/cli/Console.h>
 #include <clarisma/store/PileFile.h>
@@ -9,7 +10,9 @@
 
 #include "build/analyze/OsmStatistics.h"
 #include "build/util/BuildSettings.h"
+#include "build/util/ConcurrencyGovernor.h"
 #include "build/util/MappedIndex.h"
+#include "build/util/MemoryBudget.h"
 #include "build/util/StringCatalog.h"
 #include "build/util/TileCatalog.h"
 
@@ -39,6 +42,14 @@ public:
 	const BuildSettings& settings() const { return settings_; }
 	BuildSettings& settings() { return settings_; }
 	int threadCount() const { return threadCount_; }
+
+	/// Returns the number of worker threads to use for the given
+	/// phase (which may be lower than threadCount() in order to
+	/// stay within the memory budget)
+	///
+	int threadCount(int phase) const { return phaseThreadCounts_[phase]; }
+	MemoryBudget& memory() { return memory_; }
+	ConcurrencyGovernor& concurrency() { return concurrency_; }
 	const StringCatalog& stringCatalog() const { return stringCatalog_; }
 	const TileCatalog& tileCatalog() const { return tileCatalog_; }
 	const OsmPbfMetadata& metadata() const { return metadata_; }
@@ -52,8 +63,10 @@ public:
 	double phaseWork(int phase) const { return workPerPhase_[phase]; }
 	void progress(double work)
 	{
-		workCompleted_ += work;
-		console().setProgress(static_cast<int>(workCompleted_));
+		double completed = workCompleted_.fetch_add(work) + work;
+			// may be called by the output threads of Validator
+			// and Compiler at the same time
+		console().setProgress(static_cast<int>(completed));
 	}
 
 	std::filesystem::path golPath() const noexcept { return golPath_; }
@@ -61,12 +74,26 @@ public:
 
 	std::unique_ptr<uint32_t[]> takeTileIndex() { return std::move(tileIndex_); }
 
+	/// Returns the estimated size of the given pile (in pages),
+	/// based on the node counts gathered during analysis.
+	///
+	uint32_t tileSizeEstimate(int pile) const
+	{
+		assert(pile > 0 && pile <= tileCatalog_.tileCount());
+		return tileSizeEstimates_[pile];
+	}
+
 private:
 	void analyze(bool full);
 	void prepare();
 	void sort();
 	void validate();
 	void compile();
+	void validateAndCompile();
+	void beginPhase(int phase, uint64_t workerMemory);
+	void endPhase(int phase);
+	uint64_t workerMemory(int phase) const;
+	void reportMemory() const;
 
 	void calculateWork();
 	void createIndex(MappedIndex& index, const char* name, int64_t maxId, int extraBits);
@@ -85,8 +112,12 @@ private:
 	PileFile featurePiles_;
 	OsmStatistics stats_;
 	int threadCount_;
+	int phaseThreadCounts_[4] = {};
+	uint64_t peakMemory_[4] = {};
+	MemoryBudget memory_;
+	ConcurrencyGovernor concurrency_;
 	double workPerPhase_[4];
-	double workCompleted_;
+	std::atomic<double> workCompleted_;
 	bool debug_ = true;
 	OsmPbfMetadata metadata_;
 };
\ No newline at end of file
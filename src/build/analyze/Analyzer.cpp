@@ -17,7 +17,7 @@
 //  any bad UTF-8 data in the .osm.pbf
 
 Analyzer::Analyzer(GolBuilder* builder) :
-	OsmPbfReader(builder->threadCount()),
+	OsmPbfReader(builder->threadCount(GolBuilder::Phase::ANALYZE)),
 	builder_(builder),
 	strings_(outputTableSize(), outputArenaSize()),
 	minStringCount_(2)
@@ -156,6 +156,11 @@ void AnalyzerWorker::stringTable(ByteSpan strings)  // CRTP override
 }
 
 
+void AnalyzerWorker::startBlock()	// CRTP override
+{
+	reader()->builder()->memory().throttle();
+}
+
 void AnalyzerWorker::endBlock()	// CRTP override
 {
 	stringCodeLookup_.clear();
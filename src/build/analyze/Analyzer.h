@@ -18,6 +18,7 @@ public:
 
 	// CRTP overrides
 	void stringTable(ByteSpan strings);
+	void startBlock();
 	void endBlock(); 
 	const uint8_t* node(int64_t id, int32_t lon100nd, int32_t lat100nd, ByteSpan tags);
 	void way(int64_t id, ByteSpan keys, ByteSpan values, ByteSpan nodes);
@@ -92,6 +93,7 @@ class Analyzer : public OsmPbfReader<Analyzer, AnalyzerWorker, AnalyzerOutputTas
 {
 public:
 	explicit Analyzer(GolBuilder* builder);
+	GolBuilder* builder() const { return builder_; }
 
 	uint32_t workerTableSize() const { return 1 * 1024 * 1024; }
 	uint32_t workerArenaSize() const { return 2 * 1024 * 1024; }
@@ -3,9 +3,11 @@
 
 #include "Compiler.h"
 
+#include <algorithm>
 #include <clarisma/io/FileTime.h>
 #include <clarisma/util/log.h>
 #include <geodesk/geom/LonLat.h>
+#include <geodesk/geom/index/hilbert.h>
 #include "build/GolBuilder.h"
 #include "tile/compiler/IndexSettings.h"
 #include "tile/compiler/NodeTableWriter.h"
@@ -38,16 +40,30 @@ CompilerWorker::CompilerWorker(Compiler* compiler) :
 	orphanTags_(nullptr),
 	includeWayNodeIds_(compiler->builder_->settings().includeWayNodeIds())
 {
+#if defined(GOL_BUILD_STATS) && defined(GOL_DIAGNOSTICS)
+	// Page stats are only reported in verbose diagnostic builds
+	collectPageStats_ = Console::verbosity() >= Console::Verbosity::VERBOSE;
+#endif
 }
 
 void CompilerWorker::processTask(int pile)
 {
+	compiler_->builder_->memory().throttle();
+	compiler_->builder_->concurrency().acquire();
 	// TODO
 	Tile tile = tileCatalog_.tileOfPile(pile);
 	Tip tip = tileCatalog_.tipOfPile(pile);
 	LOGS << "Compiling " << tile << " (" << tip << ")\n";
 	compiler_->builder_->featurePiles().load(pile, data_);
 	tile_.init(tile, data_.size());
+	// Only part of a pile consists of anonymous nodes (ways refer to
+	// them, and the pile holds tags and relations as well), so we size
+	// coords_ for a typical mix rather than for the densest possible
+	// pile; foreign features are much rarer. All three tables grow on
+	// demand (and retain their capacity for subsequent tiles)
+	coords_.init(data_.size() / BYTES_PER_COORD);
+	foreignNodes_.init(data_.size() / 64);
+	foreignFeatures_.init(data_.size() / 64);
 	Box tileBounds = tile_.bounds();
 	tileMinX_ = tileBounds.minX();
 	tileMaxY_ = tileBounds.maxY();
@@ -60,17 +76,29 @@ void CompilerWorker::processTask(int pile)
 	FeatureStore::IndexedKeyMap keysToCategories = settings.keysToCategories();
 	IndexSettings indexSettings(keysToCategories,
 		settings.rtreeBranchsize(), settings.maxKeyIndexes(),
-		settings.keyIndexMinFeatures());
+		settings.keyIndexMinFeatures(), settings.rtreePacking(),
+		settings.adaptiveBranchSize());
 	THeader indexer(indexSettings);
 	indexer.addFeatures(tile_);
 		// TODO: more efficient to use the lists
 	indexer.setExportTable(tile_.exportTable());
 	indexer.build(tile_);
 
-	Layout layout(tile_);
+	Layout layout(tile_, settings.featureLayout());
+	#ifdef GOL_BUILD_STATS
+	layout.collectPageStats(collectPageStats_);
+	#endif
 	indexer.place(layout);
 	layout.flush();
 	layout.placeBodies();
+	#ifdef GOL_BUILD_STATS
+	if (collectPageStats_)
+	{
+		Layout::PageStats pageStats = layout.pageStats();
+		stats_.leafCount += pageStats.leafCount;
+		stats_.leafPageCount += pageStats.leafPageCount;
+	}
+	#endif
 
 	uint8_t* newTileData = tile_.write(layout);
 	compiler_->postOutput(CompilerOutputTask(tip,
@@ -78,10 +106,15 @@ void CompilerWorker::processTask(int pile)
 			static_cast<size_t>(layout.size() + 4))));
 			// TODO: cleanup
 	#ifdef GOL_BUILD_STATS
+	stats_.tagTableCacheHits = tagsBuilder_.cacheHits();
+	stats_.tagTableCacheMisses = tagsBuilder_.cacheMisses();
+	tagsBuilder_.resetCacheStats();
 	compiler_->addStats(stats_);
 	stats_.clear();
 	#endif
+	compiler_->builder_->concurrency().release(data_.size());
 	reset();
+	compiler_->tail_.taskCompleted();
 }
 
 
@@ -200,14 +233,14 @@ void CompilerWorker::foreignNode(uint64_t id, Coordinate xy, ForeignFeatureRef r
 		return;
 	}
 
-	auto it = foreignNodes_.find(id);
-	if (it != foreignNodes_.end())
+	ForeignNode* existing = foreignNodes_.find(id);
+	if (existing)
 	{
-		LOGS << "Duplicate foreign node/" << id << " (old: " << it->second
-			<< " @ " << LonLat(it->second.xy) << ", new"
+		LOGS << "Duplicate foreign node/" << id << " (old: " << *existing
+			<< " @ " << LonLat(existing->xy) << ", new"
 			<< ref << LonLat(xy);
 	}
-	foreignNodes_.emplace(id, ForeignNode(ref, xy));
+	foreignNodes_.insert(id, ForeignNode(ref, xy));
 
 #ifdef GOL_BUILD_STATS
 	stats_.importedFeatureCount++;
@@ -216,7 +249,8 @@ void CompilerWorker::foreignNode(uint64_t id, Coordinate xy, ForeignFeatureRef r
 
 void CompilerWorker::foreignFeature(FeatureType type, uint64_t id, const Box& bounds, ForeignFeatureRef ref)
 {
-	ForeignFeature& ff = foreignFeatures_[TypedFeatureId::ofTypeAndId(type, id)];
+	ForeignFeature& ff = foreignFeatures_[static_cast<uint64_t>(
+		TypedFeatureId::ofTypeAndId(type, id))];
 	if (!bounds.isEmpty())
 	{
 		assert(ff.bounds.isEmpty());
@@ -336,11 +370,11 @@ void CompilerWorker::buildWay(TWay* way)
 	for (int i = 0; i < nodeCount; i++)
 	{
 		nodeId += readSignedVarint64(p);
-		auto it = coords_.find(nodeId);
-		if (it != coords_.end())
+		const Coordinate* pCoord = coords_.find(nodeId);
+		if (pCoord)
 		{
 			// Plain coordinate (local or foreign) -- most likely case
-			wayNodes_.emplace_back(FeatureRef(), it->second);
+			wayNodes_.emplace_back(FeatureRef(), *pCoord);
 		}
 		else
 		{
@@ -353,14 +387,14 @@ void CompilerWorker::buildWay(TWay* way)
 			else
 			{
 				// Must be a foreign feature node
-				auto it = foreignNodes_.find(nodeId);
-				if (it == foreignNodes_.end())
+				const ForeignNode* foreign = foreignNodes_.find(nodeId);
+				if (!foreign)
 				{
 					// TODO: We have a problem
 					// Console::msg("Compiler: Missing node/%lld", nodeId);
 					assert(false);
 				}
-				wayNodes_.emplace_back(it->second);
+				wayNodes_.emplace_back(*foreign);
 			}
 			featureNodeCount++;
 		}
@@ -624,8 +658,8 @@ TNode* CompilerWorker::promoteAnonymousMemberNode(uint64_t nodeId)
 	// in coords_, buildWay() will miss the fact that the node
 	// is now a feature node, and won't add it to its node table)
 
-	auto entry = coords_.extract(nodeId);
-	if (entry.empty())		[[unlikely]]
+	Coordinate xy;
+	if (!coords_.extract(nodeId, xy))		[[unlikely]]
 	{
 		Console::msg("Missing local node/%lld", nodeId);
 		assert(false);
@@ -633,7 +667,7 @@ TNode* CompilerWorker::promoteAnonymousMemberNode(uint64_t nodeId)
 	TNode* node = tile_.createFeature<TNode, SNode>(nodeId);
 	// TODO: different struct (with pointer to rels)
 	MutableFeaturePtr pFeature(node->feature());
-	pFeature.setNodeXY(entry.mapped());
+	pFeature.setNodeXY(xy);
 	pFeature.setTags(node->handle(), readTags(ByteSpan(), false));
 		// TODO: make more efficient, can cache empty tagtable
 	nodes_.addHead(node);
@@ -728,9 +762,9 @@ void CompilerWorker::buildRelation(TRelation* rel)
 			if (typedMemberId.isNode())
 			{
 				Coordinate xy;
-				auto it = foreignNodes_.find(typedMemberId.id());
+				const ForeignNode* foreign = foreignNodes_.find(typedMemberId.id());
 					// lookup is just by ID (without type)
-				if (it == foreignNodes_.end())
+				if (!foreign)
 				{
 					TNode* localNode = promoteAnonymousMemberNode(typedMemberId.id());
 					assert(localNode);
@@ -740,23 +774,24 @@ void CompilerWorker::buildRelation(TRelation* rel)
 				}
 				else
 				{
-					relBodyBuilder.addForeign(it->second, {}, role);
-					xy = it->second.xy;
+					relBodyBuilder.addForeign(*foreign, {}, role);
+					xy = foreign->xy;
 				}
 				bounds.expandToInclude(xy);
 			}
 			else
 			{
-				auto it = foreignFeatures_.find(typedMemberId);
-				if (it == foreignFeatures_.end())
+				const ForeignFeature* foreign = foreignFeatures_.find(
+					static_cast<uint64_t>(typedMemberId));
+				if (!foreign)
 				{
 					Console::msg("relation/%lld: Missing member %s",
 						rel->id(), typedMemberId.toString().c_str());
 					assert(false);
 				}
 				// TODO: choose ref depending on parent tile overlap
-				relBodyBuilder.addForeign(it->second.ref1, it->second.ref2, role);
-				bounds.expandToIncludeSimple(it->second.bounds);
+				relBodyBuilder.addForeign(foreign->ref1, foreign->ref2, role);
+				bounds.expandToIncludeSimple(foreign->bounds);
 			}
 		}
 	}
@@ -798,7 +833,7 @@ void CompilerWorker::reset()
 
 
 Compiler::Compiler(GolBuilder* builder) :
-	TaskEngine(builder->threadCount()),
+	TaskEngine(builder->threadCount(GolBuilder::Phase::COMPILE)),
 	builder_(builder),
 	areaClassifier_(
 		builder->settings().areaRules(),
@@ -808,8 +843,8 @@ Compiler::Compiler(GolBuilder* builder) :
 		}),
 	workPerTile_(builder->phaseWork(GolBuilder::Phase::COMPILE)
 		/ builder->tileCatalog().tileCount()),
-	exportFile_(builder->workPath() / "exports.bin"),
-	transaction_(store_)
+	transaction_(store_),
+	tail_(builder->threadCount(GolBuilder::Phase::COMPILE))
 {
 }
 
@@ -843,7 +878,7 @@ void Compiler::initStore()
 	settings.zoomLevels = buildSettings.zoomLevels();
 	settings.reserved = 0;
 	settings.rtreeBranchSize = buildSettings.rtreeBranchsize();
-	settings.rtreeAlgo = 0; // TODO
+	settings.rtreeAlgo = static_cast<uint8_t>(buildSettings.rtreePacking());
 	settings.maxKeyIndexes = buildSettings.maxKeyIndexes();
 	settings.keyIndexMinFeatures = buildSettings.keyIndexMinFeatures();
 
@@ -906,16 +941,134 @@ void Compiler::reportStat(const char* label, int64_t count, int64_t baseCount)
 void Compiler::compile()
 {
 	builder_->console().setTask("Compiling...");
-	initStore();
-	start();
+	exportFile_ = std::make_unique<ExportFile>(builder_->workPath() / "exports.bin");
+	beginCompile();
 	int tileCount = builder_->tileCatalog().tileCount();
+	std::vector<int> piles(tileCount);
 	for (int i = 0; i < tileCount; i++)
 	{
-		postWork(i+1);
+		piles[i] = i+1;
 		// Pile numbers start at 1, not 0
 	}
+	compilePiles(piles);
+	endCompile();
+}
+
+/// Starts compiling while the Validator is still running. The
+/// Validator posts piles via compilePiles() once their tiles (and
+/// the tiles that hold their parent relations) have been validated.
+/// Since exports.bin is only complete once validation has finished,
+/// relation TEXes are looked up in the Validator's in-memory copies
+/// of the export tables.
+///
+void Compiler::beginOverlapped(const std::vector<Block<ForeignRelationLookup::Entry>>* exportTables)
+{
+	exportTables_ = exportTables;
+	beginCompile();
+}
+
+void Compiler::beginCompile()
+{
+	initStore();
+	initLayout();
+	start();
+	tail_.begin();
+}
+
+/// Assigns each tile its position in the GOL, according to
+/// the configured TileLayout.
+///
+/// Tiles are placed by zoom level in descending order (the order
+/// in which the Validator releases them when phases overlap), so
+/// the reorder buffer never has to hold back the tiles of the higher
+/// zoom levels while waiting for the lower ones. A plain Hilbert
+/// layout cannot be honored in overlapped mode for the same reason;
+/// we fall back to ZOOM_HILBERT instead.
+///
+/// The layout takes precedence over --tile-order for the Compile
+/// phase: compilePiles() hands out piles in layout order, and only
+/// uses largest-first ordering if tiles are placed as they complete.
+///
+void Compiler::initLayout()
+{
+	BuildSettings::TileLayout layout = builder_->settings().tileLayout();
+	if (layout == BuildSettings::TileLayout::COMPLETION) return;
+	if (layout == BuildSettings::TileLayout::HILBERT &&
+		builder_->settings().overlapPhases())
+	{
+		if (Console::verbosity() >= Console::Verbosity::VERBOSE)
+		{
+			ConsoleWriter().timestamp() << "Overlapping phases: "
+				"placing tiles by zoom level, then along a Hilbert curve";
+		}
+		layout = BuildSettings::TileLayout::ZOOM_HILBERT;
+	}
+
+	const TileCatalog& tc = builder_->tileCatalog();
+	int tileCount = tc.tileCount();
+	std::vector<std::pair<uint64_t,uint32_t>> keys;
+	keys.reserve(tileCount);
+	uint32_t maxTip = 0;
+	for (int pile = 1; pile <= tileCount; pile++)
+	{
+		Tile tile = tc.tileOfPile(pile);
+		uint32_t tip = tc.tipOfPile(pile);
+		uint64_t key = hilbert::calculateHilbertDistance(
+			tile.bounds().center(), Box::ofWorld());
+		if (layout == BuildSettings::TileLayout::ZOOM_HILBERT)
+		{
+			// Highest zoom level first
+			key |= static_cast<uint64_t>(TileCatalog::MAX_ZOOM - tile.zoom()) << 32;
+		}
+		keys.emplace_back(key, tip);
+		maxTip = std::max(maxTip, tip);
+	}
+	std::ranges::sort(keys);
+
+	layoutRanks_.reset(new uint32_t[maxTip + 1]);
+	for (int i = 0; i < tileCount; i++)
+	{
+		layoutRanks_[keys[i].second] = i;
+	}
+	reorderBuffer_.resize(tileCount);
+	tileStates_.resize(tileCount, PENDING);
+}
+
+void Compiler::compilePiles(std::span<int> piles)
+{
+	if (layoutRanks_)
+	{
+		// Compile tiles in the order in which they will be placed,
+		// so the reorder buffer only needs to absorb the differences
+		// in compile time between tiles that are in flight
+		const TileCatalog& tc = builder_->tileCatalog();
+		std::ranges::sort(piles, [this, &tc](int a, int b)
+		{
+			return layoutRanks_[tc.tipOfPile(a)] < layoutRanks_[tc.tipOfPile(b)];
+		});
+	}
+	else if (builder_->settings().largestTilesFirst())
+	{
+		std::ranges::stable_sort(piles, [this](int a, int b)
+		{
+			return builder_->tileSizeEstimate(a) > builder_->tileSizeEstimate(b);
+		});
+	}
+	for (int pile : piles)
+	{
+		postWork(pile);
+	}
+}
+
+void Compiler::endCompile()
+{
 	end();
+	assert(nextRank_ == tileStates_.size());
+		// all tiles must have been written
+	tail_.end();
+	tail_.report("Compile");
 	builder_->console().setTask("Cleaning up...");
+	int tileCount = builder_->tileCatalog().tileCount();
 
 	FeatureStore::Header& header = transaction_.header();
 
@@ -954,6 +1107,27 @@ void Compiler::compile()
 		reportStat("Total relation members:", stats_.grossMemberCount);
 		reportStat("  of these, foreign:", stats_.grossForeignMemberCount);
 		reportStat("    of these, wide TEX:", stats_.grossWideTexMemberCount);
+		reportStat("Index leaves:", stats_.leafCount);
+		reportStat("  pages touched by their features:", stats_.leafPageCount);
+		if(stats_.leafCount > 0)
+		{
+			ConsoleWriter out;
+			char buf[200];
+			snprintf(buf, sizeof(buf), "  %-40s %12.2f\n", "    per leaf:",
+				static_cast<double>(stats_.leafPageCount) / stats_.leafCount);
+			out.timestamp() << buf;
+		}
+		int64_t tagTableLookups = stats_.tagTableCacheHits + stats_.tagTableCacheMisses;
+		reportStat("Tag-table lookups:", tagTableLookups);
+		reportStat("  of these, cache hits:", stats_.tagTableCacheHits);
+		if(tagTableLookups > 0)
+		{
+			ConsoleWriter out;
+			char buf[200];
+			snprintf(buf, sizeof(buf), "  %-40s %11.1f%%\n", "    hit rate:",
+				stats_.tagTableCacheHits * 100.0 / tagTableLookups);
+			out.timestamp() << buf;
+		}
 	}
 #endif
 }
@@ -969,6 +1143,54 @@ void Compiler::processTask(CompilerOutputTask& task)
 	uint32_t page = transaction_.addBlob(task.data());
 	tileIndex_[task.tip()] = TileIndexEntry(page, TileIndexEntry::CURRENT);
 	*/
+
+	if (!layoutRanks_)
+	{
+		putTile(task);
+		return;
+	}
+
+	uint32_t rank = layoutRanks_[task.tip()];
+	reorderBufferSize_ += task.data().size();
+	reorderBuffer_[rank] = std::move(task);
+	tileStates_[rank] = BUFFERED;
+	for (;;)
+	{
+		// Skip past tiles that have been written out of turn
+		while (nextRank_ < tileStates_.size() && tileStates_[nextRank_] == WRITTEN)
+		{
+			nextRank_++;
+		}
+		if (nextRank_ == tileStates_.size()) break;
+		if (tileStates_[nextRank_] == BUFFERED)
+		{
+			writeBuffered(nextRank_);
+		}
+		else if (reorderBufferSize_ > MAX_REORDER_BUFFER_SIZE)
+		{
+			// Buffer is full: write the next tile that is available,
+			// leaving a gap for the one we're still waiting for
+			rank = nextRank_ + 1;
+			while (tileStates_[rank] != BUFFERED) rank++;
+			writeBuffered(rank);
+		}
+		else
+		{
+			break;
+		}
+	}
+}
+
+void Compiler::writeBuffered(uint32_t rank)
+{
+	putTile(reorderBuffer_[rank]);
+	reorderBufferSize_ -= reorderBuffer_[rank].data().size();
+	reorderBuffer_[rank] = CompilerOutputTask();
+	tileStates_[rank] = WRITTEN;
+}
+
+void Compiler::putTile(const CompilerOutputTask& task)
+{
 	transaction_.putTile(task.tip(), task.data());
 
 	builder_->progress(workPerTile_);
@@ -982,7 +1204,24 @@ ForeignFeatureRef Compiler::lookupForeignRelation(Tile childTile, ParentTileLoca
 	Tile tile = childTile.zoomedOut(childTile.zoom() - locator.zoomDelta());
 	int pile =  builder_->tileCatalog().pileOfTile(tile);
 	Tip tip =  builder_->tileCatalog().tipOfPile(pile);
-	Tex tex = exportFile_.texOfRelation(pile, id);
+	Tex tex;
+	if (exportTables_)
+	{
+		const Block<ForeignRelationLookup::Entry>& table = (*exportTables_)[pile];
+		auto entry = ForeignRelationLookup::lookup(
+			Span<const ForeignRelationLookup::Entry>(table.data(), table.size()), id);
+		if (entry == nullptr)
+		{
+			LOGS << "Relation " << id << " not found in Exports ("
+				<< table.size() << " rels searched in pile #" << pile;
+			assert(false);
+		}
+		tex = entry->tex;
+	}
+	else
+	{
+		tex = exportFile_->texOfRelation(pile, id);
+	}
 	return ForeignFeatureRef(tip, tex);
 }
 
@@ -2,15 +2,19 @@
 // SPDX-License-Identifier: AGPL-3.0-only
 
 #pragma once
-#include <clarisma/data/HashMap.h>
+#include <memory>
+#include <span>
+#include <vector>
 #include <clarisma/thread/TaskEngine.h>
 #include <geodesk/feature/FeatureStore_Transaction.h>
 #include <geodesk/geom/Coordinate.h>
+#include "build/util/FlatIdMap.h"
 #include "build/util/ProtoGolReader.h"
 #include "build/util/TileCatalog.h"
 #include "tag/AreaClassifier.h"
 #include "tile/model/TileModel.h"
 #include "tile/model/TNode.h"
+#include "tile/util/TailLatencyTracker.h"
 #include "ExportFile.h"
 #include "FeatureRef.h"
 #include "TagTableBuilder.h"
@@ -51,6 +55,10 @@ struct TileStats
 		grossWideTexParentRelationCount = 0;
 		importedFeatureCount = 0;
 		importedNodeCount = 0;
+		tagTableCacheHits = 0;
+		tagTableCacheMisses = 0;
+		leafCount = 0;
+		leafPageCount = 0;
 	}
 
 	TileStats& operator+=(const TileStats& other)
@@ -71,6 +79,10 @@ struct TileStats
 		grossWideTexParentRelationCount += other.grossWideTexParentRelationCount;
 		importedFeatureCount += other.importedFeatureCount;
 		importedNodeCount += other.importedNodeCount;
+		tagTableCacheHits += other.tagTableCacheHits;
+		tagTableCacheMisses += other.tagTableCacheMisses;
+		leafCount += other.leafCount;
+		leafPageCount += other.leafPageCount;
 		return *this;
 	}
 
@@ -90,6 +102,10 @@ struct TileStats
 	int64_t grossWideTexParentRelationCount{};
 	int64_t importedFeatureCount{};
 	int64_t importedNodeCount{};
+	int64_t tagTableCacheHits{};
+	int64_t tagTableCacheMisses{};
+	int64_t leafCount{};
+	int64_t leafPageCount{};
 };
 #endif
 
@@ -114,8 +130,15 @@ public:
 	void harvestResults() {}
 
 private:
+	/// Bytes of pile data per anonymous node in a typical pile (a node
+	/// takes about 7 bytes, the ways that refer to it about 3 more);
+	/// used for the initial size of coords_
+	///
+	static constexpr size_t BYTES_PER_COORD = 12;
+
 	struct ForeignNode : ForeignFeatureRef
 	{
+		ForeignNode() {}
 		ForeignNode(Tip tip_, Tex tex_, Coordinate xy_) : 
 			ForeignFeatureRef(tip_, tex_), xy(xy_) {}
 		ForeignNode(ForeignFeatureRef ref, Coordinate xy_) :
@@ -176,9 +199,9 @@ private:
 	TileModel tile_;
 	int32_t tileMinX_;
 	int32_t tileMaxY_;
-	HashMap<uint64_t, Coordinate> coords_;
-	HashMap<uint64_t, ForeignNode> foreignNodes_;
-	HashMap<TypedFeatureId, ForeignFeature> foreignFeatures_;
+	FlatIdMap<Coordinate> coords_;
+	FlatIdMap<ForeignNode> foreignNodes_;
+	FlatIdMap<ForeignFeature> foreignFeatures_;
 	LinkedList<TNode> nodes_;
 	LinkedList<TWay> ways_;
 	LinkedList<TRelation> relations_;
@@ -190,6 +213,7 @@ private:
 		// TODO: should this be moved to TileModel?
 	#ifdef GOL_BUILD_STATS
 	TileStats stats_;
+	bool collectPageStats_ = false;
 	#endif
 };
 
@@ -218,10 +242,17 @@ public:
 	explicit Compiler(GolBuilder* builder);
 
 	void compile();
+	void beginOverlapped(const std::vector<Block<ForeignRelationLookup::Entry>>* exportTables);
+	void compilePiles(std::span<int> piles);
+	void endCompile();
 	void processTask(CompilerOutputTask& task);
 
 private:
+	void beginCompile();
 	void initStore();
+	void initLayout();
+	void putTile(const CompilerOutputTask& task);
+	void writeBuffered(uint32_t rank);
 	std::unique_ptr<uint32_t[]> createIndexedKeySchema() const;
 	ForeignFeatureRef lookupForeignRelation(Tile childTile, ParentTileLocator locator, uint64_t id);
 
@@ -232,10 +263,28 @@ private:
 
 	GolBuilder* builder_;
 	AreaClassifier areaClassifier_;
-	ExportFile exportFile_;
+	std::unique_ptr<ExportFile> exportFile_;
+	const std::vector<Block<ForeignRelationLookup::Entry>>* exportTables_ = nullptr;
 	double workPerTile_;
 	FeatureStore store_;
 	FeatureStore::Transaction transaction_;
+	TailLatencyTracker tail_;
+
+	// Tiles are written to the store in layout order; tiles that
+	// are compiled ahead of their turn wait in the reorder buffer
+	std::unique_ptr<uint32_t[]> layoutRanks_;		// by TIP
+	enum TileState : uint8_t { PENDING, BUFFERED, WRITTEN };
+	std::vector<CompilerOutputTask> reorderBuffer_;	// by rank
+	std::vector<TileState> tileStates_;				// by rank
+	uint32_t nextRank_ = 0;
+	size_t reorderBufferSize_ = 0;
+
+	/// If the reorder buffer grows beyond this size (which may happen
+	/// if compilation overlaps with validation and tiles aren't
+	/// compiled in layout order), tiles are written out of turn
+	///
+	static constexpr size_t MAX_REORDER_BUFFER_SIZE = 512 * 1024 * 1024;
+
 	#ifdef GOL_BUILD_STATS
 	TileStats stats_;
 	std::mutex statsMutex_;
@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: AGPL-3.0-only
 
 #include "TagTableBuilder.h"
+#include <cstring>
 #include "build/util/ProtoGol.h"
 #include <geodesk/feature/TagValues.h>
 #include <tag/AreaClassifier.h>
@@ -23,6 +24,18 @@ TTagTable* TagTableBuilder::getTagTable(ByteSpan protoTags, bool determineIfArea
 	assert(globalTagsSize_ == 0);
 	assert(localTagsSize_ == 0);
 
+	TagTableCache::Entry* cached = cache_.find(protoTags);
+	if (cached && (!determineIfArea || cached->areaType >= 0))
+	{
+		#ifdef GOL_BUILD_STATS
+		cacheHits_++;
+		#endif
+		return addCachedTagTable(*cached, determineIfArea);
+	}
+	#ifdef GOL_BUILD_STATS
+	cacheMisses_++;
+	#endif
+
 	const uint8_t* p = protoTags.data();
 	while (p < protoTags.end())
 	{
@@ -51,11 +64,39 @@ TTagTable* TagTableBuilder::getTagTable(ByteSpan protoTags, bool determineIfArea
 			}
 		}
 	}
-	return getTagTable(determineIfArea);
+
+	TTagTable* tags = buildTagTable(determineIfArea);
+	if (!tags->hasLocalTags() && !tags->needsFixup())
+	{
+		// The table only consists of global keys and values that
+		// don't reference any strings of the tile, so its encoding
+		// can be copied as-is into other tiles
+		int areaType = determineIfArea ? areaTypeOf(tags) : -1;
+		if (cached)
+		{
+			// Cached earlier for a node, now needed for a way or relation
+			cached->areaType = areaType;
+		}
+		else
+		{
+			cache_.insert(protoTags, tags->data().ptr(), tags->size(),
+				tags->hash(), areaType);
+		}
+	}
+	clear();
+	return tags;
 }
 
 
 TTagTable* TagTableBuilder::getTagTable(bool determineIfArea)
+{
+	TTagTable* tags = buildTagTable(determineIfArea);
+	clear();
+	return tags;
+}
+
+
+TTagTable* TagTableBuilder::buildTagTable(bool determineIfArea)
 {
 	normalize();
 	TTagTable* tags = tile_.beginTagTable(globalTagsSize_ + localTagsSize_, localTagsSize_);
@@ -101,21 +142,46 @@ TTagTable* TagTableBuilder::getTagTable(bool determineIfArea)
 	{
 		if(!tags->isBuilt())
 		{
-			int areaType = areaClassifier_.isArea(*this);
-			tags->setFlag(TTagTable::Flags::WAY_AREA_TAGS,
-				(areaType & AreaClassifier::AREA_FOR_WAY) != 0);
-			tags->setFlag(TTagTable::Flags::RELATION_AREA_TAGS,
-				(areaType & AreaClassifier::AREA_FOR_RELATION) != 0);
-			tags->setFlag(TTagTable::Flags::BUILT, true);
+			setAreaFlags(tags, areaClassifier_.isArea(*this));
 		}
 	}
+	return tags;
+}
 
-	clear();
 
+TTagTable* TagTableBuilder::addCachedTagTable(
+	const TagTableCache::Entry& entry, bool determineIfArea)
+{
+	TTagTable* tags = tile_.beginTagTable(entry.size, 0);
+	memcpy(const_cast<uint8_t*>(tags->data().ptr()), entry.data, entry.size);
+	tags = tile_.completeTagTable(tags, entry.hash, false);
+	if(determineIfArea && !tags->isBuilt())
+	{
+		assert(entry.areaType >= 0);
+		setAreaFlags(tags, entry.areaType);
+	}
 	return tags;
 }
 
 
+void TagTableBuilder::setAreaFlags(TTagTable* tags, int areaType)
+{
+	tags->setFlag(TTagTable::Flags::WAY_AREA_TAGS,
+		(areaType & AreaClassifier::AREA_FOR_WAY) != 0);
+	tags->setFlag(TTagTable::Flags::RELATION_AREA_TAGS,
+		(areaType & AreaClassifier::AREA_FOR_RELATION) != 0);
+	tags->setFlag(TTagTable::Flags::BUILT, true);
+}
+
+
+int TagTableBuilder::areaTypeOf(const TTagTable* tags)
+{
+	assert(tags->isBuilt());
+	return (tags->isArea(false) ? AreaClassifier::AREA_FOR_WAY : 0) |
+		(tags->isArea(true) ? AreaClassifier::AREA_FOR_RELATION : 0);
+}
+
+
 
 
 
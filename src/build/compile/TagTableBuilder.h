@@ -7,6 +7,7 @@
 #include <clarisma/data/Span.h>
 #include "tag/TagTableModel.h"
 #include "tile/model/TString.h"
+#include "TagTableCache.h"
 
 class AreaClassifier;
 class StringCatalog;
@@ -26,8 +27,28 @@ public:
 	TTagTable* getTagTable(ByteSpan tags, bool determineIfArea);
 	TTagTable* getTagTable(bool determineIfArea);
 
+	#ifdef GOL_BUILD_STATS
+	int64_t cacheHits() const { return cacheHits_; }
+	int64_t cacheMisses() const { return cacheMisses_; }
+	void resetCacheStats()
+	{
+		cacheHits_ = 0;
+		cacheMisses_ = 0;
+	}
+	#endif
+
 private:
+	TTagTable* buildTagTable(bool determineIfArea);
+	TTagTable* addCachedTagTable(const TagTableCache::Entry& entry, bool determineIfArea);
+	static void setAreaFlags(TTagTable* tags, int areaType);
+	static int areaTypeOf(const TTagTable* tags);
+
 	TileModel& tile_;
 	const StringCatalog& strings_;
 	const AreaClassifier& areaClassifier_;
+	TagTableCache cache_;
+	#ifdef GOL_BUILD_STATS
+	int64_t cacheHits_ = 0;
+	int64_t cacheMisses_ = 0;
+	#endif
 };
@@ -0,0 +1,84 @@
+// Copyright (c) 2025 Clarisma / GeoDesk contributors
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#pragma once
+
+#include <cassert>
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <clarisma/data/HashMap.h>
+#include <clarisma/data/Span.h>
+
+using namespace clarisma;
+
+/// Maps the proto-GOL encoding of a tag set to its encoded TagTable,
+/// so a CompilerWorker only has to parse, sort and encode a common
+/// tag set (and classify it as area or non-area) once, rather than
+/// once per tile.
+///
+/// Only tables that consist entirely of global keys and non-string
+/// or global-string values are cached, since these contain no
+/// references to other elements of the tile and hence can be copied
+/// verbatim into any TileModel.
+///
+/// The cache is filled first-come, first-served, until its storage
+/// is used up; common tag sets appear in almost every tile, so they
+/// are captured by the first few tiles a worker compiles.
+///
+class TagTableCache
+{
+public:
+	struct Entry
+	{
+		const uint8_t* data;
+		uint32_t size;
+		uint32_t hash;
+		int areaType;		// -1 if not yet classified
+	};
+
+	static constexpr size_t MAX_KEY_SIZE = 64;
+	static constexpr size_t MAX_TABLE_SIZE = 64;
+
+	Entry* find(ByteSpan protoTags)
+	{
+		auto it = entries_.find(toKey(protoTags));
+		return it != entries_.end() ? &it->second : nullptr;
+	}
+
+	/// Adds the encoded tag-table for the given proto-GOL tags,
+	/// unless the cache has run out of space.
+	///
+	Entry* insert(ByteSpan protoTags, const uint8_t* data,
+		uint32_t size, uint32_t hash, int areaType)
+	{
+		if (protoTags.size() > MAX_KEY_SIZE || size > MAX_TABLE_SIZE) return nullptr;
+		if (!pool_)
+		{
+			pool_.reset(new uint8_t[POOL_SIZE]);
+		}
+		if (poolUsed_ + protoTags.size() + size > POOL_SIZE) return nullptr;
+		uint8_t* key = pool_.get() + poolUsed_;
+		memcpy(key, protoTags.data(), protoTags.size());
+		uint8_t* table = key + protoTags.size();
+		memcpy(table, data, size);
+		poolUsed_ += protoTags.size() + size;
+		auto [it, inserted] = entries_.try_emplace(
+			std::string_view(reinterpret_cast<const char*>(key), protoTags.size()),
+			Entry{ table, size, hash, areaType });
+		assert(inserted);
+		return &it->second;
+	}
+
+private:
+	static constexpr size_t POOL_SIZE = 2 * 1024 * 1024;
+
+	static std::string_view toKey(ByteSpan protoTags)
+	{
+		return { reinterpret_cast<const char*>(protoTags.data()), protoTags.size() };
+	}
+
+	HashMap<std::string_view, Entry> entries_;
+	std::unique_ptr<uint8_t[]> pool_;
+	size_t poolUsed_ = 0;
+};
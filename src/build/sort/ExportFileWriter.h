@@ -24,7 +24,7 @@ public:
 		assert(offsets_.data() == nullptr);	
 	}
 
-	void write(int pile, Block<ForeignRelationLookup::Entry>&& lookup)
+	void write(int pile, const Block<ForeignRelationLookup::Entry>& lookup)
 	{
 		offsets_[pile-1] = fileSize_;
 		size_t size = lookup.size();
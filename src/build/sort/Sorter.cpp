@@ -38,6 +38,11 @@ SorterWorker::~SorterWorker()
 {
 }
 
+void SorterWorker::startBlock()
+{
+    builder_->memory().throttle();
+}
+
 void SorterWorker::stringTable(ByteSpan strings)
 {
     assert(stringTranslationTable_.empty());
@@ -736,13 +741,13 @@ void SorterWorker::harvestResults() const
 
 
 Sorter::Sorter(GolBuilder* builder) :
-    OsmPbfReader(builder->threadCount()),
+    OsmPbfReader(builder->threadCount(GolBuilder::Phase::SORT)),
     builder_(builder),
     workPerByte_(0)
 {
     for (int& phaseCountdown : phaseCountdowns_)
     {
-        phaseCountdown = builder->threadCount();
+        phaseCountdown = builder->threadCount(GolBuilder::Phase::SORT);
     }
 }
 
@@ -95,6 +95,7 @@ public:
 	LinkedQueue<SuperRelation> superRelations() const { return superRelations_; }
 
 	// CRTP overrides
+	void startBlock();
 	void stringTable(ByteSpan strings);
 	const uint8_t* node(int64_t id, int32_t lon100nd, int32_t lat100nd, ByteSpan tags);
 	void beginWayGroup();
@@ -39,7 +39,7 @@ struct VFeature
 	};
 
 	VFeature(uint64_t typedId, int flags) :
-		idAndFlags((typedId << 6) | flags), next(nullptr) {}
+		idAndFlags((typedId << 6) | flags), tex(0) {}
 	
 	int type() const {	return static_cast<int>(idAndFlags >> 6) & 3; }
 	uint64_t id() const { return idAndFlags >> 8; }
@@ -87,11 +87,7 @@ struct VFeature
 		// Bit 3-5		twin_code (ways and relations only)
 		// Bit 6-7		type (0=node, 1=way, 2=relation)
 		// Bit 8-31		ID
-	union
-	{
-		VFeature* next;
-		int tex;
-	};
+	int tex;
 };
 
 struct VNode : VFeature
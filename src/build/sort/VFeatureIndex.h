@@ -2,40 +2,64 @@
 // SPDX-License-Identifier: AGPL-3.0-only
 
 #pragma once
+#include <algorithm>
+#include <bit>
 #include <clarisma/alloc/Block.h>
 #include "VFeature.h"
 
+/// An open-addressing hash table that indexes the features of
+/// a pile by their typed ID (or local nodes by their location).
+///
+/// The table has a power-of-two capacity and uses linear probing.
+/// Each slot holds the key alongside the feature pointer, so probing
+/// walks a contiguous run of slots and never needs to dereference
+/// a feature that doesn't match. A slot is empty if its feature
+/// pointer is null (which leaves the entire key range usable,
+/// including coordinate 0/0).
+///
+/// The storage is owned by the worker and retained across piles;
+/// it is only reallocated if a pile needs a larger table than any
+/// previous one. The table also grows on its own if the initial
+/// estimate turns out to be too low.
+///
 class VFeatureIndex
 {
 public:
-	void init(size_t size)
+	/// Prepares the index for a pile of the given size (in bytes).
+	///
+	void init(size_t pileSize)
 	{
-		table_ = Block<VFeature*>(size);
+		size_t capacity = std::bit_ceil(std::max(
+			pileSize / BYTES_PER_FEATURE, MIN_CAPACITY));
+		if (capacity > table_.size())
+		{
+			table_ = Block<Slot>(capacity);
+		}
+		setCapacity(capacity);
 		clear();
 	}
 
 	void clear()
 	{
-		memset(table_.data(), 0, sizeof(VFeature*) * table_.size());
+		memset(table_.data(), 0, sizeof(Slot) * capacity_);
+		count_ = 0;
 	}
 
 	void addFeature(VFeature* f)
 	{
-		size_t slot = static_cast<uint64_t>(f->typedId()) % table_.size();
-		f->next = table_[slot];
-		table_[slot] = f;
+		uint64_t key = static_cast<uint64_t>(f->typedId());
+		Slot& slot = table_[slotOf(key)];
+		bool isNew = slot.feature == nullptr;
+		slot.key = key;
+		slot.feature = f;
+			// If the ID is already indexed, the latest feature wins
+			// (same as with the former chained index)
+		if (isNew) added();
 	}
 
 	VFeature* getFeature(TypedFeatureId typedId) const
 	{
-		size_t slot = static_cast<uint64_t>(typedId) % table_.size();
-		VFeature* f = table_[slot];
-		while (f)
-		{
-			if (typedId == f->typedId()) return f;
-			f = f->next;
-		}
-		return nullptr;
+		return table_[slotOf(static_cast<uint64_t>(typedId))].feature;
 	}
 
 	VNode* getNode(uint64_t id) const
@@ -46,28 +70,96 @@ public:
 		return node;
 	}
 
+	/// Checks whether another local node has already been indexed
+	/// at the location of the given node. If so, returns that node;
+	/// otherwise, indexes the given node and returns `nullptr`.
+	///
+	/// Since only the first node at a given location is indexed,
+	/// callers are merely able to determine whether there is at
+	/// least one other node at this location.
+	///
 	VLocalNode* checkSharedLocation(VLocalNode* node)
 	{
-		size_t slot = std::hash<Coordinate>()(node->xy) % table_.size();
-		VFeature* first = table_[slot];
-		VFeature* f = first;
-		while (f)
+		uint64_t key = locationKey(node->xy);
+		Slot& slot = table_[slotOf(key)];
+		if (slot.feature)
 		{
-			VLocalNode* otherNode = f->asLocalNode();
-			assert(std::hash<Coordinate>()(otherNode->xy) % table_.size() == slot);
-			if (node->xy == otherNode->xy)
-			{
-				return otherNode;
-					// no need to index this node, we're just interested
-					// if there is at least one node at this location
-			}
-			f = f->next;
+			VLocalNode* otherNode = slot.feature->asLocalNode();
+			assert(otherNode->xy == node->xy);
+			return otherNode;
 		}
-		node->next = first;
-		table_[slot] = node;
+		slot.key = key;
+		slot.feature = node;
+		added();
 		return nullptr;
 	}
 
 private:
-	Block<VFeature*> table_;
+	struct Slot
+	{
+		uint64_t key;
+		VFeature* feature;
+	};
+
+	/// The smallest Proto-GOL record is a local node (ID delta plus
+	/// two coordinate deltas); we assume at least this many bytes per
+	/// feature, which keeps the table sparse enough that growing is rare
+	///
+	static constexpr size_t BYTES_PER_FEATURE = 4;
+	static constexpr size_t MIN_CAPACITY = 1024;
+
+	static uint64_t locationKey(Coordinate xy)
+	{
+		return (static_cast<uint64_t>(static_cast<uint32_t>(xy.x)) << 32) |
+			static_cast<uint32_t>(xy.y);
+	}
+
+	void setCapacity(size_t capacity)
+	{
+		capacity_ = capacity;
+		shift_ = 64 - std::countr_zero(capacity);
+		maxCount_ = capacity - capacity / 4;		// max. load factor 0.75
+	}
+
+	/// Returns the index of the slot that holds the given key,
+	/// or of the empty slot where it would be placed.
+	///
+	size_t slotOf(uint64_t key) const
+	{
+		size_t mask = capacity_ - 1;
+		// Fibonacci hashing: spreads the (mostly sequential) IDs and
+		// packed coordinates across the table, taking the high bits
+		size_t i = (key * 0x9E3779B97F4A7C15ULL) >> shift_;
+		for (;;)
+		{
+			const Slot& slot = table_[i];
+			if (!slot.feature || slot.key == key) return i;
+			i = (i + 1) & mask;
+		}
+	}
+
+	void added()
+	{
+		if (++count_ > maxCount_) [[unlikely]] grow();
+	}
+
+	void grow()
+	{
+		Block<Slot> oldTable = std::move(table_);
+		size_t oldCapacity = capacity_;
+		table_ = Block<Slot>(oldCapacity * 2);
+		setCapacity(oldCapacity * 2);
+		memset(table_.data(), 0, sizeof(Slot) * capacity_);
+		for (size_t i = 0; i < oldCapacity; i++)
+		{
+			const Slot& old = oldTable[i];
+			if (old.feature) table_[slotOf(old.key)] = old;
+		}
+	}
+
+	Block<Slot> table_;
+	size_t capacity_ = 0;
+	size_t count_ = 0;
+	size_t maxCount_ = 0;
+	int shift_ = 64;
 };
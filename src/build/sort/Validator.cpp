@@ -7,6 +7,7 @@
 #include <clarisma/util/BitIterator.h>
 #include <clarisma/util/varint.h>
 #include "build/GolBuilder.h"
+#include "build/compile/Compiler.h"
 #include "build/util/ProtoGol.h"
 #include <geodesk/feature/types.h>
 #include <geodesk/feature/TypedFeatureId.h>
@@ -29,11 +30,12 @@ ValidatorWorker::ValidatorWorker(Validator* validator) :
 
 
 Validator::Validator(GolBuilder* builder) :
-	TaskEngine(builder->threadCount()),
+	TaskEngine(builder->threadCount(GolBuilder::Phase::VALIDATE)),
 	builder_(builder),
 	workPerTile_ (builder->phaseWork(GolBuilder::Phase::VALIDATE) 
 		/ builder->tileCatalog().tileCount()),
-	exportsWriter_(builder->workPath() / "exports.bin", builder->tileCatalog().tileCount())
+	exportsWriter_(builder->workPath() / "exports.bin", builder->tileCatalog().tileCount()),
+	tail_(builder->threadCount(GolBuilder::Phase::VALIDATE))
 {
 }
 
@@ -42,11 +44,14 @@ Validator::Validator(GolBuilder* builder) :
 void ValidatorWorker::processTask(ValidatorTask& task)
 {
 	// Console::msg("Validating %s (Pile %d)...", task.tile().toString().c_str(), task.pile());
+	validator_->builder_->memory().throttle();
+	validator_->builder_->concurrency().acquire();
 	currentTile_ = task.tile();
 	validator_->builder_->featurePiles().load(task.pile(), data_);
-	index_.init(data_.size() / 4);		// TODO: tune table size
+	index_.init(data_.size());
 	exportTable_.init(currentTile_);
 	pileWriter_.init(task.pile(), currentTile_);
+	requiredZoom_ = currentTile_.zoom();
 	readTile();
 	useSection(SECTION_OTHER);
 		// Ensure sections are initialized properly if there are no exported features
@@ -63,7 +68,11 @@ void ValidatorWorker::processTask(ValidatorTask& task)
 	exportNodes();
 	exportFeatures(SECTION_LOCAL_WAYS);
 	exportFeatures(SECTION_LOCAL_RELATIONS);
-	validator_->postOutput(ValidatorOutputTask(task.pile(),
+	validator_->builder_->concurrency().release(data_.size());
+	validator_->tail_.taskCompleted();
+		// must happen before we post the output, since the batch
+		// may complete as soon as the output has been processed
+	validator_->postOutput(ValidatorOutputTask(task.pile(), requiredZoom_,
 		std::move(pileWriter_), std::move(foreignRelations)));
 
 	arena_.clear();
@@ -156,6 +165,10 @@ void ValidatorWorker::membership(uint64_t relId, ParentTileLocator locator, Type
 {
 	VFeature* feature = index_.getFeature(typedMemberId);
 	assert(feature);
+	requiredZoom_ = std::min(requiredZoom_,
+		currentTile_.zoom() - locator.zoomDelta());
+		// The Compiler will need the parent tile's export table
+		// to look up the TEX of the relation
 	uint64_t tiles = childExports(locator);
 	if (feature->isNode())
 	{
@@ -366,8 +379,8 @@ void ValidatorWorker::processNodes()
 	{
 		VLocalNode* node = it.next();
 
-		// checkSharedLocation() uses `next`, thereby invalidating
-		// the ability to look up nodes by ID (That's why processNodes
+		// The index now holds locations instead of IDs, so nodes can
+		// no longer be looked up by ID (That's why processNodes
 		// must be called after processWays and processRelations)
 
 		VLocalNode* otherNode = index_.checkSharedLocation(node);
@@ -483,7 +496,13 @@ void ValidatorWorker::exportFeatures(int section)
 	pileWriter_.closePiles();
 }
 
-void Validator::validate()
+/// Validates all piles. If a Compiler is given, piles are handed to
+/// it as soon as they are ready to be compiled, which is the case once
+/// all tiles at their zoom level (the tile itself and its twin) have
+/// been validated, as well as all parent tiles that contain relations
+/// of which features in the tile are members.
+///
+void Validator::validate(Compiler* compiler)
 {
 	if(Console::verbosity() >= Console::Verbosity::VERBOSE)
 	{
@@ -519,20 +538,96 @@ void Validator::validate()
 	assert(batchCount >= 1);
 	assert(batchCount < MAX_BATCHES);
 
+	if (builder_->settings().largestTilesFirst())
+	{
+		// Tiles within a batch are independent, so we can hand them
+		// out in any order; starting with the largest avoids having
+		// a single big tile hold up the end of the batch
+		ValidatorTask* pBatch = tasks.data();
+		for (int i = 0; i < batchCount; i++)
+		{
+			orderBatchBySize(pBatch, pBatch + batchSizes[i]);
+			pBatch += batchSizes[i];
+		}
+	}
+
+	compiler_ = compiler;
+	std::vector<int> compilable;
+	if (compiler_)
+	{
+		exportTables_.resize(tileCount + 1);
+		requiredZoomOfPile_.resize(tileCount + 1);
+		uncompiledPiles_.reserve(tileCount);
+	}
+
 	start();
 
 	ValidatorTask* pTask = tasks.data();
 	for (int currentBatch = 0; currentBatch < batchCount; currentBatch++)
 	{
+		ValidatorTask* pBatch = pTask;
 		batchCountdown_ = batchSizes[currentBatch];
+		tail_.begin();
 		for (int i = 0; i < batchSizes[currentBatch]; i++)
 		{
 			postWork(std::move(*pTask++));
 		}
+		if (!compilable.empty())
+		{
+			// Only post compile tasks once the current batch has been
+			// posted, so validation isn't held up if posting blocks
+			// because the Compiler's queue is full
+			compiler_->compilePiles(compilable);
+			compilable.clear();
+		}
 		awaitBatchCompletion();
+		tail_.end();
+
+		if (compiler_)
+		{
+			for (ValidatorTask* p = pBatch; p < pTask; p++)
+			{
+				uncompiledPiles_.push_back(p->pile());
+			}
+			int zoom = pBatch->tile().zoom();
+			if (pTask == tasks.data() + tileCount || pTask->tile().zoom() != zoom)
+			{
+				// Both batches (even and odd tiles) of this zoom level
+				// have been validated
+				collectCompilablePiles(zoom, compilable);
+			}
+		}
 	}
 	end();
+	if (compiler_)
+	{
+		assert(uncompiledPiles_.empty());
+		compiler_->compilePiles(compilable);
+	}
 	exportsWriter_.close();
+	tail_.report("Validate");
+}
+
+
+void Validator::collectCompilablePiles(int completedZoom, std::vector<int>& compilable)
+{
+	auto remaining = std::ranges::remove_if(uncompiledPiles_, [&](int pile)
+	{
+		if (requiredZoomOfPile_[pile] < completedZoom) return false;
+		compilable.push_back(pile);
+		return true;
+	});
+	uncompiledPiles_.erase(remaining.begin(), remaining.end());
+}
+
+
+void Validator::orderBatchBySize(ValidatorTask* start, ValidatorTask* end) const
+{
+	std::stable_sort(start, end, [this](ValidatorTask a, ValidatorTask b)
+	{
+		return builder_->tileSizeEstimate(a.pile()) >
+			builder_->tileSizeEstimate(b.pile());
+	});
 }
 
 
@@ -546,7 +641,12 @@ void Validator::awaitBatchCompletion()
 void Validator::processTask(ValidatorOutputTask& task)
 {
 	task.piles_.writeTo(builder_->featurePiles());
-	exportsWriter_.write(task.pile_, std::move(task.foreignRelations_));
+	exportsWriter_.write(task.pile_, task.foreignRelations_);
+	if (compiler_)
+	{
+		exportTables_[task.pile_] = std::move(task.foreignRelations_);
+		requiredZoomOfPile_[task.pile_] = static_cast<int8_t>(task.requiredZoom_);
+	}
 	builder_->progress(workPerTile_);
 
 	std::unique_lock lock(countdownMutex_);
@@ -8,12 +8,14 @@
 #include <clarisma/util/TaggedPtr.h>
 #include <geodesk/geom/Tile.h>
 #include "build/util/ProtoGolReader.h"
+#include "tile/util/TailLatencyTracker.h"
 #include "ExportFileWriter.h"
 #include "ExportTableBuilder.h"
 #include "ValidatorPileWriter.h"
 #include "VArena.h"
 #include "VFeatureIndex.h"
 
+class Compiler;
 class GolBuilder;
 
 class Validator;
@@ -169,6 +171,9 @@ private:
 	// std::vector<TaggedPtr<VLocalNode,1>> specialNodes_;
 	Tile currentTile_;
 	int currentSection_;
+	int requiredZoom_;
+		// lowest zoom level that must be validated before
+		// the current tile can be compiled
 	// bool isOddBatch_;
 };
 
@@ -177,14 +182,16 @@ class ValidatorOutputTask
 public:
 	ValidatorOutputTask() {} // TODO: not needed, only to satisfy compiler
 	ValidatorOutputTask(
-		int pile,
+		int pile, int requiredZoom,
 		PileSet&& piles, Block<ForeignRelationLookup::Entry> foreignRelations) :
 		pile_(pile),
+		requiredZoom_(requiredZoom),
 		piles_(std::move(piles)), foreignRelations_(std::move(foreignRelations))
 	{
 	}
 
 	int pile_;
+	int requiredZoom_;
 	PileSet piles_;
 	Block<ForeignRelationLookup::Entry> foreignRelations_;
 };
@@ -193,11 +200,21 @@ class Validator : public TaskEngine<Validator, ValidatorWorker, ValidatorTask, V
 {
 public:
 	explicit Validator(GolBuilder* builder);
-	void validate();
+	void validate(Compiler* compiler = nullptr);
 	void processTask(ValidatorOutputTask& task);
 
+	/// The export tables of all validated piles (indexed by pile
+	/// number), retained only if validation overlaps with compilation
+	///
+	const std::vector<Block<ForeignRelationLookup::Entry>>* exportTables() const
+	{
+		return &exportTables_;
+	}
+
 private:
 	void awaitBatchCompletion();
+	void orderBatchBySize(ValidatorTask* start, ValidatorTask* end) const;
+	void collectCompilablePiles(int completedZoom, std::vector<int>& compilable);
 
 	GolBuilder* builder_;
 	double workPerTile_;
@@ -205,6 +222,11 @@ private:
 	int batchCountdown_;
 	std::condition_variable batchCompleted_;
 	ExportFileWriter exportsWriter_;
+	TailLatencyTracker tail_;
+	Compiler* compiler_ = nullptr;
+	std::vector<Block<ForeignRelationLookup::Entry>> exportTables_;
+	std::vector<int8_t> requiredZoomOfPile_;
+	std::vector<int> uncompiledPiles_;
 
 	friend class ValidatorWorker;
 };
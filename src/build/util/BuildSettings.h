@@ -9,6 +9,8 @@
 #include <geodesk/feature/FeatureStore.h>
 #include <geodesk/feature/ZoomLevels.h>
 #include "tag/AreaClassifier.h"
+#include "tile/compiler/RTreePacker.h"
+#include "tile/model/FeatureLayout.h"
 #include "IndexedKey.h"
 
 
@@ -22,6 +24,15 @@ public:
 
 	static const uint32_t MAX_GLOBAL_STRING_CODE = (1 << 16) - 3;
 
+	/// Order in which compiled tiles are placed in the GOL
+	///
+	enum class TileLayout
+	{
+		COMPLETION,		// as the Compiler finishes them
+		HILBERT,		// along a Hilbert curve
+		ZOOM_HILBERT	// by zoom level, then along a Hilbert curve
+	};
+
 	enum
 	{
 		AREA_TAGS,
@@ -74,19 +85,27 @@ public:
 		return indexedKeyStrings_; 
 	}
 	*/
+	bool adaptiveBranchSize() const { return adaptiveBranchSize_; }
+	bool adaptiveThreads() const { return adaptiveThreads_; }
+	FeatureLayout featureLayout() const { return featureLayout_; }
 	bool includeWayNodeIds() const { return includeWayNodeIds_; }
 	const std::vector<IndexedKey>& indexedKeys() const { return indexedKeys_; }
 	bool keepIndexes() const { return keepIndexes_; }
 	bool keepWork() const { return keepWork_; }
+	bool largestTilesFirst() const { return largestTilesFirst_; }
+	bool overlapPhases() const { return overlapPhases_; }
+	TileLayout tileLayout() const { return tileLayout_; }
 	FeatureStore::IndexedKeyMap keysToCategories() const;
 	int keyIndexMinFeatures() const { return keyIndexMinFeatures_; }
 	int maxKeyIndexes() const { return maxKeyIndexes_; }
+	uint64_t maxMemory() const { return maxMemory_; }
 	int maxStrings() const { return maxStrings_; }
 	int maxTiles() const { return maxTiles_; }
 	int minStringUsage() const { return minStringUsage_; }
 	int minTileDensity() const { return minTileDensity_; }
 	int leafZoomLevel() const { return 12; }
 	int rtreeBranchsize() const { return rtreeBranchSize_; }
+	RTreePacking rtreePacking() const { return rtreePacking_; }
 	int threadCount() const { return threadCount_; }
 	ZoomLevels zoomLevels() const { return zoomLevels_; }
 	std::vector<AreaClassifier::Entry>& areaRules() { return areaRules_; };
@@ -96,9 +115,15 @@ public:
 	void setAreaRules(const char* rules);
 	void setIndexedKeys(const char *s);
 
+	void setAdaptiveBranchSize(bool b) { adaptiveBranchSize_ = b; }
+	void setAdaptiveThreads(bool b) { adaptiveThreads_ = b; }
+	void setFeatureLayout(FeatureLayout layout) { featureLayout_ = layout; }
 	void setIncludeWayNodeIds(bool b) { includeWayNodeIds_ = b; }
 	void setKeepIndexes(bool b) { keepIndexes_ = b; }
 	void setKeepWork(bool b) { keepWork_ = b; }
+	void setLargestTilesFirst(bool b) { largestTilesFirst_ = b; }
+	void setOverlapPhases(bool b) { overlapPhases_ = b; }
+	void setTileLayout(TileLayout layout) { tileLayout_ = layout; }
 	
 	void setKeyIndexMinFeatures(int v)
 	{
@@ -112,6 +137,8 @@ public:
 		maxKeyIndexes_ = Validate::intValue(v, 0, 30);
 	}
 
+	void setMaxMemory(uint64_t v) { maxMemory_ = v; }
+
 	void setMaxStrings(int64_t v)
 	{
 		if (v < 256) v = 256;
@@ -141,6 +168,8 @@ public:
 		rtreeBranchSize_ = Validate::intValue(v, 4, 255);
 	}
 
+	void setRTreePacking(RTreePacking packing) { rtreePacking_ = packing; }
+
 	void setThreadCount(int64_t v)
 	{
 		if (v < 0) v = 0;
@@ -160,19 +189,27 @@ private:
 	int keyIndexMinFeatures_ = 300;
 	int maxKeyIndexes_ = 8;
 	int maxTiles_ = (1 << 16) - 1;
+	uint64_t maxMemory_ = 0;		// 0 = no limit
 	int maxStrings_ = 32'000;
 	int minStringUsage_ = 300;
 	int minTileDensity_ = 75'000;
 	int rtreeBranchSize_ = 16;
+	RTreePacking rtreePacking_ = RTreePacking::HILBERT;
 	int threadCount_ = 0;
+	TileLayout tileLayout_ = TileLayout::ZOOM_HILBERT;
+	FeatureLayout featureLayout_ = FeatureLayout::COMPACT;
 	uint32_t featurePilesPageSize_ = 64 * 1024;
 	//std::vector<std::string_view> indexedKeyStrings_;
 	//std::vector<uint8_t> indexedKeyCategories_;
 	std::vector<AreaClassifier::Entry> areaRules_;
 	std::vector<IndexedKey> indexedKeys_;
+	bool adaptiveBranchSize_ = false;
+	bool adaptiveThreads_ = false;
 	bool includeWayNodeIds_ = false;
 	bool keepIndexes_ = false;
 	bool keepWork_ = false;
+	bool largestTilesFirst_ = true;
+	bool overlapPhases_ = false;
 
 	static const char DEFAULT_INDEXED_KEYS[];
 };
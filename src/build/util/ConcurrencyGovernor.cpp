@@ -0,0 +1,178 @@
+// Copyright (c) 2025 Clarisma / GeoDesk contributors
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#include "ConcurrencyGovernor.h"
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <clarisma/cli/Console.h>
+#include <clarisma/cli/ConsoleWriter.h>
+
+using namespace clarisma;
+
+ConcurrencyGovernor::~ConcurrencyGovernor()
+{
+	end();
+}
+
+void ConcurrencyGovernor::begin(int maxWorkers)
+{
+	std::unique_lock lock(mutex_);
+	enabled_ = true;
+	running_ = true;
+	maxWorkers_ = maxWorkers;
+	limit_ = maxWorkers;
+	active_ = 0;
+	direction_ = -1;
+		// Start at full concurrency; the first move is a probe downward
+	work_ = 0;
+	prevWork_ = 0;
+	prevThroughput_ = 0;
+	readCpuTimes(prevCpuTotal_, prevCpuIoWait_);
+	history_.clear();
+	start_ = Clock::now();
+	history_.push_back({ 0, limit_, 0, -1 });
+
+	controller_ = std::thread([this]()
+	{
+		std::unique_lock lock(mutex_);
+		Clock::time_point prev = Clock::now();
+		while (running_)
+		{
+			stopRequested_.wait_for(lock, std::chrono::milliseconds(INTERVAL_MS));
+			if (!running_) break;
+			Clock::time_point now = Clock::now();
+			adjust(std::chrono::duration<double>(now - prev).count());
+			prev = now;
+		}
+	});
+}
+
+void ConcurrencyGovernor::end()
+{
+	{
+		std::lock_guard lock(mutex_);
+		if (!running_) return;
+		running_ = false;
+		enabled_ = false;
+	}
+	stopRequested_.notify_one();
+	slotAvailable_.notify_all();
+	controller_.join();
+}
+
+void ConcurrencyGovernor::acquire()
+{
+	std::unique_lock lock(mutex_);
+	if (!enabled_) return;
+	slotAvailable_.wait(lock, [this]() { return !enabled_ || active_ < limit_; });
+	active_++;
+}
+
+void ConcurrencyGovernor::release(uint64_t work)
+{
+	{
+		std::lock_guard lock(mutex_);
+		if (!enabled_ || active_ == 0) return;
+			// slot was acquired before the governor was enabled
+		work_ += work;
+		active_--;
+	}
+	slotAvailable_.notify_one();
+}
+
+// Must be called with the mutex held
+void ConcurrencyGovernor::adjust(double seconds)
+{
+	double throughput = (work_ - prevWork_) / seconds;
+	prevWork_ = work_;
+
+	double ioWait = -1;
+	uint64_t cpuTotal;
+	uint64_t cpuIoWait;
+	if (readCpuTimes(cpuTotal, cpuIoWait) && cpuTotal > prevCpuTotal_)
+	{
+		ioWait = static_cast<double>(cpuIoWait - prevCpuIoWait_) /
+			(cpuTotal - prevCpuTotal_);
+		prevCpuTotal_ = cpuTotal;
+		prevCpuIoWait_ = cpuIoWait;
+	}
+
+	if (throughput > prevThroughput_ * (1 + SIGNIFICANT_CHANGE))
+	{
+		// The last move paid off: keep going
+	}
+	else if (throughput < prevThroughput_ * (1 - SIGNIFICANT_CHANGE))
+	{
+		direction_ = -direction_;
+	}
+	else if (ioWait > HIGH_IO_WAIT)
+	{
+		// No gain from the current number of threads, and the CPUs
+		// are mostly waiting for the disk: shed a thread
+		direction_ = -1;
+	}
+	else
+	{
+		direction_ = 0;
+	}
+	prevThroughput_ = throughput;
+
+	int limit = std::clamp(limit_ + direction_, 1, maxWorkers_);
+	if (direction_ == 0 && limit_ < maxWorkers_ && history_.size() % 8 == 0)
+	{
+		// Periodically probe upward, in case conditions have changed
+		limit = limit_ + 1;
+		direction_ = 1;
+	}
+	if (limit > limit_) slotAvailable_.notify_all();
+	limit_ = limit;
+
+	float elapsed = std::chrono::duration<float>(Clock::now() - start_).count();
+	history_.push_back({ elapsed, limit_,
+		static_cast<float>(throughput), static_cast<float>(ioWait) });
+}
+
+void ConcurrencyGovernor::report(const char* phase) const
+{
+	if (Console::verbosity() < Console::Verbosity::VERBOSE) return;
+	std::lock_guard lock(mutex_);
+	if (history_.empty()) return;
+
+	// Only list the points at which the limit changed
+	std::string s;
+	int prevLimit = 0;
+	char buf[64];
+	for (const Sample& sample : history_)
+	{
+		if (sample.limit == prevLimit) continue;
+		snprintf(buf, sizeof(buf), "%s%.0fs:%d", s.empty() ? "" : " ",
+			sample.seconds, sample.limit);
+		s += buf;
+		prevLimit = sample.limit;
+	}
+	ConsoleWriter().timestamp() << phase << ": Active workers over time: " << s;
+}
+
+/// Reads the cumulative CPU time (all states) and the time spent
+/// waiting for I/O, in clock ticks. Only supported on Linux.
+///
+bool ConcurrencyGovernor::readCpuTimes(uint64_t& total, uint64_t& ioWait)
+{
+#ifdef __linux__
+	FILE* f = fopen("/proc/stat", "r");
+	if (!f) return false;
+	unsigned long long user, nice, system, idle, iowait, irq, softirq, steal;
+	int fields = fscanf(f, "cpu %llu %llu %llu %llu %llu %llu %llu %llu",
+		&user, &nice, &system, &idle, &iowait, &irq, &softirq, &steal);
+	fclose(f);
+	if (fields != 8) return false;
+	total = user + nice + system + idle + iowait + irq + softirq + steal;
+	ioWait = iowait;
+	return true;
+#else
+	total = 0;
+	ioWait = 0;
+	return false;
+#endif
+}
@@ -0,0 +1,71 @@
+// Copyright (c) 2025 Clarisma / GeoDesk contributors
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// Limits how many workers of a TaskEngine may process tasks at the
+/// same time, and adjusts that limit while the phase runs.
+///
+/// Once per interval, the governor compares the throughput (units of
+/// work completed per second) with that of the previous interval and
+/// keeps moving the limit in the same direction while throughput
+/// improves, reversing course when it drops. If throughput stays flat
+/// while the CPUs are mostly waiting for I/O, it lowers the limit,
+/// since the extra threads only add contention.
+///
+/// Workers call acquire() before and release() after each task.
+/// If the governor hasn't been started, these do nothing.
+///
+class ConcurrencyGovernor
+{
+public:
+	~ConcurrencyGovernor();
+
+	void begin(int maxWorkers);
+	void end();
+	void acquire();
+	void release(uint64_t work);
+	void report(const char* phase) const;
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	struct Sample
+	{
+		float seconds;
+		int limit;
+		float throughput;		// work per second
+		float ioWait;			// share of CPU time waiting for I/O, or -1
+	};
+
+	void adjust(double seconds);
+	static bool readCpuTimes(uint64_t& total, uint64_t& ioWait);
+
+	static constexpr int INTERVAL_MS = 1000;
+	static constexpr double SIGNIFICANT_CHANGE = 0.05;
+	static constexpr double HIGH_IO_WAIT = 0.2;
+
+	bool enabled_ = false;
+	bool running_ = false;
+	int maxWorkers_ = 0;
+	int limit_ = 0;
+	int active_ = 0;
+	int direction_ = -1;
+	uint64_t work_ = 0;
+	uint64_t prevWork_ = 0;
+	double prevThroughput_ = 0;
+	uint64_t prevCpuTotal_ = 0;
+	uint64_t prevCpuIoWait_ = 0;
+	Clock::time_point start_;
+	std::vector<Sample> history_;
+	mutable std::mutex mutex_;
+	std::condition_variable slotAvailable_;
+	std::condition_variable stopRequested_;
+	std::thread controller_;
+};
@@ -0,0 +1,241 @@
+// Copyright (c) 2025 Clarisma / GeoDesk contributors
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <clarisma/alloc/Block.h>
+
+using namespace clarisma;
+
+/// A flat open-addressing hash map from 64-bit IDs to small,
+/// trivially copyable values, meant to be reused for one tile
+/// after another.
+///
+/// - Capacity is a power of two; collisions are resolved by linear
+///   probing (with backward-shift deletion, so there are no tombstones)
+/// - Each slot is stamped with the generation in which it was written;
+///   slots from earlier generations count as empty. This makes clear()
+///   O(1) regardless of capacity.
+/// - The slot storage is retained across tiles and only reallocated
+///   if a tile needs more slots than any tile before it (growing
+///   within storage left over from a larger tile rehashes in place).
+///   Small tiles only use a prefix of the storage, so their slots
+///   stay compact.
+///
+template<typename T>
+class FlatIdMap
+{
+public:
+	/// Prepares the map for a new tile that is expected to hold
+	/// (at most) the given number of entries, discarding all
+	/// current entries.
+	///
+	void init(size_t expectedCount)
+	{
+		size_t capacity = std::bit_ceil(std::max(
+			expectedCount + expectedCount / 3, MIN_CAPACITY));
+		if (capacity > slots_.size())
+		{
+			slots_ = Block<Slot>(capacity);
+			memset(slots_.data(), 0, sizeof(Slot) * capacity);
+			generation_ = 0;
+		}
+		setCapacity(capacity);
+		clear();
+	}
+
+	/// Discards all entries.
+	///
+	void clear()
+	{
+		count_ = 0;
+		if (++generation_ == 0) [[unlikely]]
+		{
+			// Generation counter wrapped around: wipe all stamps,
+			// since 0 is reserved for empty slots
+			memset(slots_.data(), 0, sizeof(Slot) * slots_.size());
+			generation_ = 1;
+		}
+	}
+
+	size_t size() const { return count_; }
+
+	/// Returns a pointer to the value for the given key,
+	/// or `nullptr` if the key is not present.
+	///
+	T* find(uint64_t key)
+	{
+		Slot& slot = slots_[slotOf(key)];
+		return isOccupied(slot) ? &slot.value : nullptr;
+	}
+
+	/// Returns a reference to the value for the given key,
+	/// inserting a default-constructed value if the key is
+	/// not present.
+	///
+	T& operator[](uint64_t key)
+	{
+		size_t i = slotOf(key);
+		if (!isOccupied(slots_[i]))
+		{
+			if (count_ >= maxCount_) [[unlikely]]
+			{
+				grow();
+				i = slotOf(key);
+			}
+			Slot& slot = slots_[i];
+			slot.key = key;
+			slot.generation = generation_;
+			slot.value = T();
+			count_++;
+		}
+		return slots_[i].value;
+	}
+
+	/// Inserts the given value unless the key is already present.
+	///
+	/// @return `true` if the value was inserted
+	///
+	bool insert(uint64_t key, const T& value)
+	{
+		size_t before = count_;
+		T& v = (*this)[key];
+		if (count_ == before) return false;
+		v = value;
+		return true;
+	}
+
+	/// Removes the entry for the given key and stores its value
+	/// in `value`.
+	///
+	/// @return `false` if the key was not present
+	///
+	bool extract(uint64_t key, T& value)
+	{
+		size_t i = slotOf(key);
+		if (!isOccupied(slots_[i])) return false;
+		value = slots_[i].value;
+		remove(i);
+		return true;
+	}
+
+private:
+	struct Slot
+	{
+		uint64_t key;
+		uint32_t generation;
+		T value;
+	};
+
+	static constexpr size_t MIN_CAPACITY = 256;
+
+	bool isOccupied(const Slot& slot) const
+	{
+		return slot.generation == generation_;
+	}
+
+	void setCapacity(size_t capacity)
+	{
+		capacity_ = capacity;
+		shift_ = 64 - std::countr_zero(capacity);
+		maxCount_ = capacity - capacity / 4;		// max. load factor 0.75
+	}
+
+	size_t home(uint64_t key) const
+	{
+		// Fibonacci hashing: take the high bits of the product,
+		// which spreads consecutive IDs evenly
+		return (key * 0x9E3779B97F4A7C15ULL) >> shift_;
+	}
+
+	/// Returns the index of the slot that holds the given key,
+	/// or of the empty slot where it would be placed.
+	///
+	size_t slotOf(uint64_t key) const
+	{
+		size_t mask = capacity_ - 1;
+		size_t i = home(key);
+		for (;;)
+		{
+			const Slot& slot = slots_[i];
+			if (!isOccupied(slot) || slot.key == key) return i;
+			i = (i + 1) & mask;
+		}
+	}
+
+	void remove(size_t i)
+	{
+		size_t mask = capacity_ - 1;
+		size_t j = i;
+		for (;;)
+		{
+			j = (j + 1) & mask;
+			Slot& next = slots_[j];
+			if (!isOccupied(next)) break;
+			size_t k = home(next.key);
+			// Move the entry at j into the gap at i, unless its
+			// home slot lies cyclically within (i, j]
+			if (((j - k) & mask) >= ((j - i) & mask))
+			{
+				slots_[i] = next;
+				i = j;
+			}
+		}
+		slots_[i].generation = 0;
+		count_--;
+	}
+
+	void grow()
+	{
+		size_t newCapacity = capacity_ * 2;
+		if (newCapacity <= slots_.size())
+		{
+			// The storage retained from an earlier tile is large enough,
+			// so we set the entries aside and re-insert them into the
+			// same storage (slots beyond the old capacity are stale,
+			// and become empty along with the others once we clear)
+			Block<Slot> entries(count_);
+			size_t n = 0;
+			for (size_t i = 0; i < capacity_; i++)
+			{
+				if (isOccupied(slots_[i])) entries[n++] = slots_[i];
+			}
+			setCapacity(newCapacity);
+			clear();
+			for (size_t i = 0; i < n; i++) reinsert(entries[i]);
+			return;
+		}
+
+		Block<Slot> oldSlots = std::move(slots_);
+		size_t oldCapacity = capacity_;
+		uint32_t oldGeneration = generation_;
+		slots_ = Block<Slot>(newCapacity);
+		memset(slots_.data(), 0, sizeof(Slot) * newCapacity);
+		setCapacity(newCapacity);
+		generation_ = 1;
+		count_ = 0;
+		for (size_t i = 0; i < oldCapacity; i++)
+		{
+			if (oldSlots[i].generation == oldGeneration) reinsert(oldSlots[i]);
+		}
+	}
+
+	void reinsert(const Slot& entry)
+	{
+		Slot& slot = slots_[slotOf(entry.key)];
+		slot = entry;
+		slot.generation = generation_;
+		count_++;
+	}
+
+	Block<Slot> slots_;
+	size_t capacity_ = 0;
+	size_t count_ = 0;
+	size_t maxCount_ = 0;
+	uint32_t generation_ = 0;
+	int shift_ = 64;
+};
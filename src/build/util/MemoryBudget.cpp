@@ -0,0 +1,152 @@
+// Copyright (c) 2025 Clarisma / GeoDesk contributors
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#include "MemoryBudget.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__APPLE__)
+#include <mach/mach.h>
+#elif defined(__linux__)
+#include <unistd.h>
+#endif
+
+MemoryBudget::~MemoryBudget()
+{
+	stop();
+}
+
+void MemoryBudget::start(uint64_t limit)
+{
+	limit_ = limit;
+	highWater_ = limit / 100 * HIGH_WATER_PERCENT;
+	running_ = true;
+	sample();
+	sampler_ = std::thread([this]()
+	{
+		std::unique_lock lock(mutex_);
+		while (running_)
+		{
+			stopRequested_.wait_for(lock,
+				std::chrono::milliseconds(SAMPLE_INTERVAL_MS));
+			lock.unlock();
+			sample();
+			lock.lock();
+		}
+	});
+}
+
+void MemoryBudget::stop()
+{
+	{
+		std::lock_guard lock(mutex_);
+		running_ = false;
+	}
+	stopRequested_.notify_one();
+	if (sampler_.joinable()) sampler_.join();
+}
+
+void MemoryBudget::sample()
+{
+	uint64_t rss = currentRss();
+	currentRss_ = rss;
+	uint64_t peak = peakRss_;
+	while (rss > peak && !peakRss_.compare_exchange_weak(peak, rss)) {}
+	if (rss < highWater_) memoryReleased_.notify_all();
+}
+
+int MemoryBudget::beginPhase(int maxWorkers, uint64_t perWorkerMemory)
+{
+	uint64_t rss = currentRss();
+	peakRss_ = rss;
+	int workers = maxWorkers;
+	if (limit_ && perWorkerMemory)
+	{
+		uint64_t available = highWater_ > rss ? highWater_ - rss : 0;
+		workers = static_cast<int>(std::clamp<uint64_t>(
+			available / perWorkerMemory, 1, maxWorkers));
+	}
+	std::lock_guard lock(mutex_);
+	workerCount_ = workers;
+	throttledCount_ = 0;
+	return workers;
+}
+
+uint64_t MemoryBudget::endPhase()
+{
+	sample();
+	return peakRss_;
+}
+
+void MemoryBudget::throttle()
+{
+	if (!limit_ || currentRss_ < highWater_) return;
+	std::unique_lock lock(mutex_);
+	if (throttledCount_ + 1 >= workerCount_) return;
+		// Let at least one worker proceed
+	throttledCount_++;
+	memoryReleased_.wait_for(lock, std::chrono::milliseconds(MAX_THROTTLE_MS),
+		[this]() { return currentRss_ < highWater_; });
+	throttledCount_--;
+}
+
+// Only anonymous memory counts toward the budget: the GOL and the
+// piles are memory-mapped, and their file-backed pages (which the OS
+// can drop at any time) would otherwise make RSS appear to approach
+// the budget even while the workers use very little heap
+uint64_t MemoryBudget::currentRss()
+{
+#if defined(_WIN32)
+	PROCESS_MEMORY_COUNTERS_EX counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(),
+		reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&counters), sizeof(counters)))
+	{
+		return 0;
+	}
+	return counters.PrivateUsage;
+#elif defined(__APPLE__)
+	task_vm_info_data_t info;
+	mach_msg_type_number_t count = TASK_VM_INFO_COUNT;
+	if (task_info(mach_task_self(), TASK_VM_INFO,
+		reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS)
+	{
+		return 0;
+	}
+	return info.internal;		// resident anonymous memory
+#elif defined(__linux__)
+	FILE* f = fopen("/proc/self/status", "r");
+	if (f)
+	{
+		char line[128];
+		unsigned long long kb;
+		while (fgets(line, sizeof(line), f))
+		{
+			if (sscanf(line, "RssAnon: %llu kB", &kb) == 1)
+			{
+				fclose(f);
+				return kb * 1024;
+			}
+		}
+		fclose(f);
+	}
+
+	// Kernels before 4.5 don't report RssAnon; resident minus
+	// shared pages is the closest approximation
+	f = fopen("/proc/self/statm", "r");
+	if (!f) return 0;
+	unsigned long long pages = 0;
+	unsigned long long residentPages = 0;
+	unsigned long long sharedPages = 0;
+	int fields = fscanf(f, "%llu %llu %llu", &pages, &residentPages, &sharedPages);
+	fclose(f);
+	if (fields != 3) return 0;
+	return (residentPages - std::min(sharedPages, residentPages)) *
+		static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+#else
+	return 0;
+#endif
+}
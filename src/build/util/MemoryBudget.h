@@ -0,0 +1,77 @@
+// Copyright (c) 2025 Clarisma / GeoDesk contributors
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+/// Keeps the memory use of a build within a single budget.
+///
+/// - At the start of each phase, derives the number of workers from
+///   the memory that remains available (budget minus current RSS)
+///   and an estimate of how much memory each worker needs.
+/// - A background thread samples the RSS of the process, tracking
+///   the peak for each phase.
+/// - Workers call throttle() before taking on a task; if RSS is close
+///   to the budget, they pause briefly to let the output thread drain
+///   buffers. At least one worker always keeps going, so a phase can
+///   never stall completely.
+///
+/// Without a budget, only the peak memory of each phase is tracked.
+///
+class MemoryBudget
+{
+public:
+	~MemoryBudget();
+
+	void start(uint64_t limit);
+	void stop();
+
+	uint64_t limit() const { return limit_; }
+
+	/// Begins a new phase, returning the number of workers
+	/// (at most `maxWorkers`) whose estimated memory use
+	/// fits into the budget.
+	///
+	int beginPhase(int maxWorkers, uint64_t perWorkerMemory);
+
+	/// Ends the current phase, returning its peak RSS
+	///
+	uint64_t endPhase();
+
+	void throttle();
+
+	/// Returns the anonymous memory in use by the process (excluding
+	/// memory-mapped files), or 0 if it cannot be determined on
+	/// this platform.
+	///
+	static uint64_t currentRss();
+
+private:
+	void sample();
+
+	/// Throttling begins once RSS reaches this share of the budget
+	///
+	static constexpr int HIGH_WATER_PERCENT = 90;
+	static constexpr int SAMPLE_INTERVAL_MS = 100;
+
+	/// A throttled worker resumes after this time even if RSS has
+	/// not dropped (freed memory isn't always returned to the OS)
+	///
+	static constexpr int MAX_THROTTLE_MS = 2000;
+
+	uint64_t limit_ = 0;
+	uint64_t highWater_ = 0;
+	std::atomic<uint64_t> currentRss_ = 0;
+	std::atomic<uint64_t> peakRss_ = 0;
+	int workerCount_ = 0;
+	int throttledCount_ = 0;
+	bool running_ = false;
+	std::mutex mutex_;
+	std::condition_variable memoryReleased_;
+	std::condition_variable stopRequested_;
+	std::thread sampler_;
+};
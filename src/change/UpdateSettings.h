@@ -14,10 +14,13 @@ public:
     void setThreadCount(int count) { threadCount_ = count; }
     size_t bufferSize() const { return bufferSize_; }
     void setBufferSize(size_t size) { bufferSize_ = size; }
+    bool verifyPatches() const { return verifyPatches_; }
+    void setVerifyPatches(bool b) { verifyPatches_ = b; }
     void complete();
 
 private:
     std::vector<AreaClassifier::Entry> areaRules_;
     size_t bufferSize_ = 0;
     int threadCount_ = 0;
+    bool verifyPatches_ = false;
 };
@@ -4,6 +4,7 @@
 #include "Updater.h"
 
 #include <ranges>
+#include <clarisma/cli/CliApplication.h>
 #include <clarisma/io/FilePath.h>
 #include <clarisma/zip/Zip.h>
 #include <geodesk/feature/FeatureStore.h>
@@ -21,7 +22,8 @@ static const char READING_TASK_PREFIX[] = "Reading ";
 UpdaterWorker::UpdaterWorker(Updater* updater) :
     updater_(updater),
     analyzer_(updater->model()),
-    writer_(updater->model(), updater->tileCatalog())
+    writer_(updater->model(), updater->tileCatalog()),
+    compiler_(updater->model().store())
 {
 }
 
@@ -67,16 +69,27 @@ void UpdaterWorker::prepareUpdate(Tip tip)
 
 void UpdaterWorker::applyUpdate(int entryNumber)
 {
-    TileCompiler compiler(analyzer_.model().store());
+    TileCompiler& compiler = compiler_;
     const TesArchiveEntry& entry = updater_->tesEntry(entryNumber);
     Tip tip = entry.tip;
     LOGS << "Updating Tile " << tip;
+    compiler.verifyPatches(updater_->verifyPatches());
     compiler.modifyTile(tip, updater_->tileCatalog().tileOfTip(tip));
 
     ByteBlock tesBlock = Zip::uncompressSealedChunk(updater_->tesData(entryNumber), entry.size);
     compiler.addChanges(tesBlock);
     // compiler.addChanges(updater_->tesEntry(entryNumber), updater_->tesData(entryNumber));
-    ByteBlock block = compiler.compile();
+    ByteBlock block;
+    try
+    {
+        block = compiler.compile();
+    }
+    catch (const std::runtime_error& ex)
+    {
+        // Only thrown if patches are verified
+        CliApplication::abort(ex.what());
+    }
+    if (compiler.wasPatched()) LOGS << "Patched Tile " << tip;
     uint32_t size = static_cast<uint32_t>(block.size());
     updater_->postOutput({tip, std::move(block.take()), size});
 }
@@ -92,7 +105,8 @@ Updater::Updater(FeatureStore* store, UpdateSettings& settings) :
     workPerUnit_(0),
     phase_(Phase::SEARCH),
     phaseCompleted_(0),
-    targetRevision_(0)
+    targetRevision_(0),
+    verifyPatches_(settings.verifyPatches())
 {
     memcpy(displayBuffer_[0], READING_TASK_PREFIX, sizeof(READING_TASK_PREFIX) - 1);
     memcpy(displayBuffer_[1], READING_TASK_PREFIX, sizeof(READING_TASK_PREFIX) - 1);
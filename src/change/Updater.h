@@ -6,6 +6,7 @@
 #include <build/util/TileCatalog.h>
 #include <clarisma/thread/TaskEngine.h>
 #include <geodesk/feature/Tip.h>
+#include "tile/compiler/TileCompiler.h"
 #include "tile/tes/TesArchiveWriter.h"
 
 #include "change/model/ChangeModel.h"
@@ -60,6 +61,7 @@ private:
 	Updater* updater_;
 	TileChangeAnalyzer analyzer_;
 	ChangeWriter writer_;
+	TileCompiler compiler_;		// reused for every tile
 };
 
 
@@ -75,6 +77,8 @@ public:
 
 	explicit Updater(FeatureStore* store, UpdateSettings& settings);
 
+	bool verifyPatches() const { return verifyPatches_; }
+
     void update(std::string_view url, std::span<const char*> files);
 
 	// TODO: Consider encapsulating as UpdateProgressTracker?
@@ -168,6 +172,7 @@ private:
 	char displayBuffer_[2][32];
 	bool useAltDisplay_ = false;
 	int changeFileCount_ = 0;
+	bool verifyPatches_;
 
 	std::filesystem::path dumpPath_;
 };
@@ -0,0 +1,333 @@
+// Copyright (c) 2025 Clarisma / GeoDesk contributors
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#include "GobChecker.h"
+
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <clarisma/cli/Console.h>
+#include <clarisma/cli/ConsoleWriter.h>
+#include <clarisma/data/HashSet.h>
+#include <clarisma/text/Format.h>
+#include <clarisma/util/Crc32C.h>
+#include <clarisma/util/FileSize.h>
+#include <clarisma/util/varint.h>
+#include <clarisma/zip/Zip.h>
+#include <geodesk/feature/FeatureStore.h>
+#include <geodesk/query/TileIndexWalker.h>
+#include "gol/load/TileLoader.h"
+#include "tile/tes/TesReader.h"
+
+int GobChecker::check(const char* fileName)
+{
+    auto startTime = std::chrono::steady_clock::now();
+    file_.open(fileName, File::OpenMode::READ);
+    uint64_t fileSize = file_.size();
+    if (fileSize < sizeof(TesArchiveHeader))
+    {
+        error("Not a Geo-Object Bundle (file too small)");
+        return errorCount_;
+    }
+    file_.readAll(&header_, sizeof(header_));
+    try
+    {
+        TileLoader::verifyHeader(header_);
+    }
+    catch (const std::exception& ex)
+    {
+        error(ex.what());
+        return errorCount_;
+    }
+
+    catalogSize_ = static_cast<uint32_t>(sizeof(TesArchiveHeader) +
+        sizeof(TesArchiveEntry) * header_.tileCount +
+        header_.dictionarySize + sizeof(uint32_t));
+    if (catalogSize_ + static_cast<uint64_t>(header_.metadataChunkSize) > fileSize)
+    {
+        error("Catalog exceeds the size of the file");
+        return errorCount_;
+    }
+    catalog_.reset(new uint8_t[catalogSize_]);
+    memcpy(catalog_.get(), &header_, sizeof(header_));
+    file_.readAll(catalog_.get() + sizeof(TesArchiveHeader),
+        catalogSize_ - sizeof(TesArchiveHeader));
+    checkCatalog();
+    if (errorCount_) return errorCount_;
+        // If the catalog is damaged, we can't locate the tiles
+
+    uint64_t expectedSize = catalogSize_ + static_cast<uint64_t>(header_.metadataChunkSize);
+    const TesArchiveEntry* pEnd = entries() + header_.tileCount;
+    for (const TesArchiveEntry* p = entries(); p < pEnd; p++)
+    {
+        expectedSize += p->size;
+    }
+    if (expectedSize != fileSize)
+    {
+        char buf[128];
+        Format::unsafe(buf, "File size is %llu bytes instead of %llu",
+            static_cast<unsigned long long>(fileSize),
+            static_cast<unsigned long long>(expectedSize));
+        error(buf);
+        return errorCount_;
+    }
+
+    checkMetadata(file_.readBlock(header_.metadataChunkSize));
+
+    Console::get()->start("Checking...");
+    workPerTile_ = header_.tileCount ? (100.0 / header_.tileCount) : 0;
+    start();
+    for (const TesArchiveEntry* p = entries(); p < pEnd; p++)
+    {
+        ByteBlock data = file_.readBlock(p->size);
+        compressedBytes_ += p->size;
+        Tile tile;
+        if (tiles_)
+        {
+            tile = p->tip <= tipCount_ ? tiles_[p->tip] : Tile();
+            if (tile.isNull())
+            {
+                // Once the workers have started, all errors are
+                // reported by the output thread
+                postOutput(GobCheckerResult{ p->tip, "Not a tile of this tileset" });
+                continue;
+            }
+        }
+        postWork({ p->tip, tile, std::move(data) });
+    }
+    end();
+
+    if (Console::verbosity() >= Console::Verbosity::VERBOSE)
+    {
+        double seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - startTime).count();
+        char buf[160];
+        Format::unsafe(buf, "Checked %u tiles (%.1f MB compressed, "
+            "%.1f MB uncompressed) in %.2f s: %.1f MB/s",
+            tilesChecked_, compressedBytes_ / (1024.0 * 1024),
+            uncompressedBytes_ / (1024.0 * 1024), seconds,
+            fileSize / (1024.0 * 1024) / seconds);
+        ConsoleWriter().timestamp() << buf;
+    }
+    return errorCount_;
+}
+
+void GobChecker::checkCatalog()
+{
+    size_t checksumOfs = catalogSize_ - sizeof(uint32_t);
+    uint32_t checksum;
+    memcpy(&checksum, catalog_.get() + checksumOfs, sizeof(checksum));
+    if (Crc32C::compute(catalog_.get(), checksumOfs) != checksum)
+    {
+        error("Invalid catalog checksum");
+        return;
+    }
+
+    HashSet<uint32_t> tips;
+    const TesArchiveEntry* pEnd = entries() + header_.tileCount;
+    for (const TesArchiveEntry* p = entries(); p < pEnd; p++)
+    {
+        if (p->tip == 0)
+        {
+            error("Catalog contains TIP 0");
+        }
+        else if (tips.find(p->tip) != tips.end())
+        {
+            error(p->tip, "Appears more than once in the catalog");
+        }
+        else
+        {
+            tips.insert(p->tip);
+        }
+        if (p->size < 8)
+        {
+            // A sealed chunk has at least its size and checksum
+            error(p->tip, "Invalid size in catalog");
+        }
+    }
+}
+
+void GobChecker::checkMetadata(ByteBlock&& compressedMetadata)
+{
+    ByteBlock metadata;
+    try
+    {
+        metadata = TileLoader::uncompressMetadata(header_, std::move(compressedMetadata));
+    }
+    catch (const std::exception& ex)
+    {
+        char buf[256];
+        Format::unsafe(buf, "Invalid metadata: %s", ex.what());
+        error(buf);
+        return;
+    }
+
+    bool isDelta = (header_.flags & TesArchiveHeader::Flags::DELTA) != 0;
+    const uint8_t* p = metadata.data();
+    const uint8_t* end = p + metadata.size();
+    const FeatureStore::Settings* settings = nullptr;
+    std::unique_ptr<uint32_t[]> tileIndex;
+    int sectionsPresent = 0;
+    while (p < end)
+    {
+        int sectionNumber = *p++;
+        uint32_t sectionSize = readVarint32(p);
+        if (sectionNumber > 31 || sectionSize > static_cast<size_t>(end - p))
+        {
+            error("Invalid metadata section");
+            return;
+        }
+        sectionsPresent |= 1 << sectionNumber;
+        switch (static_cast<TesMetadataType>(sectionNumber))
+        {
+        case TesMetadataType::SETTINGS:
+            if (sectionSize != sizeof(FeatureStore::Settings))
+            {
+                error("Invalid size of settings");
+                return;
+            }
+            settings = reinterpret_cast<const FeatureStore::Settings*>(p);
+            break;
+        case TesMetadataType::TILE_INDEX:
+            if (sectionSize % 4 != 0 || sectionSize < 8)
+            {
+                error("Invalid size of tile index");
+                return;
+            }
+            tipCount_ = sectionSize / 4 - 1;
+            tileIndex.reset(new uint32_t[sectionSize / 4]);
+            memcpy(tileIndex.get(), p, sectionSize);
+            break;
+        case TesMetadataType::DELETED_TILES:
+            if (sectionSize % 4 != 0)
+            {
+                error("Invalid size of deleted tiles");
+            }
+            break;
+        default:
+            break;
+        }
+        p += sectionSize;
+    }
+
+    if (isDelta)
+    {
+        if (Console::verbosity() >= Console::Verbosity::VERBOSE)
+        {
+            ConsoleWriter().timestamp() << "Delta Bundle: tiles are checked "
+                "for integrity, but not decoded";
+        }
+        return;
+    }
+    if (sectionsPresent != TES_METADATA_SECTIONS)
+    {
+        error("Invalid metadata (missing sections)");
+        return;
+    }
+
+    // Determine the tile of each TIP, which TesReader needs
+    // in order to decode coordinates
+    DataPtr pTileIndex(reinterpret_cast<const uint8_t*>(tileIndex.get()));
+    tiles_.reset(new Tile[tipCount_ + 1]);
+    TileIndexWalker tiw(pTileIndex, ZoomLevels(settings->zoomLevels),
+        Box::ofWorld(), nullptr);
+    do
+    {
+        Tip tip = tiw.currentTip();
+        if (tip > tipCount_)
+        {
+            error("Invalid tile index");
+            tiles_.reset();
+            return;
+        }
+        tiles_[tip] = tiw.currentTile();
+    }
+    while (tiw.next());
+}
+
+void GobChecker::error(const char* message)
+{
+    ConsoleWriter out;
+    out.blank() << message;
+    errorCount_++;
+}
+
+void GobChecker::error(Tip tip, const char* message)
+{
+    ConsoleWriter out;
+    out.blank() << tip << ": " << message;
+    errorCount_++;
+}
+
+void GobChecker::processTask(GobCheckerResult& result)
+{
+    if (!result.error.empty()) error(result.tip, result.error.c_str());
+    tilesChecked_++;
+    workCompleted_ += workPerTile_;
+    Console::get()->setProgress(static_cast<int>(workCompleted_));
+}
+
+void GobCheckerWorker::processTask(GobCheckerTask& task)
+{
+    try
+    {
+        checkTile(task);
+        checker_->postOutput(GobCheckerResult{ task.tip(), std::string() });
+    }
+    catch (const std::exception& ex)
+    {
+        tile_.clear();
+        checker_->postOutput(GobCheckerResult{ task.tip(), ex.what() });
+    }
+}
+
+void GobCheckerWorker::checkTile(const GobCheckerTask& task)
+{
+    // Uncompressing verifies the size and checksum of the chunk
+    ByteBlock block;
+    if (checker_->header_.codec == TesArchiveHeader::ZSTD)
+    {
+        if (!zstd_)
+        {
+            zstd_ = std::make_unique<ZstdDecompressor>();
+            const uint8_t* dictionary = checker_->catalog_.get() +
+                sizeof(TesArchiveHeader) +
+                sizeof(TesArchiveEntry) * checker_->header_.tileCount;
+            if (checker_->header_.dictionarySize)
+            {
+                zstd_->setDictionary(dictionary, checker_->header_.dictionarySize);
+            }
+        }
+        block = zstd_->uncompressSealedChunk(task.data(), task.size());
+    }
+    else
+    {
+        block = Zip::uncompressSealedChunk(task.data(), task.size());
+    }
+    uncompressedBytes_ += block.size();
+    if (checker_->header_.flags & TesArchiveHeader::Flags::COMPILED_TILES)
+    {
+        if (!TileLoader::isCompiledTileValid(block))
+        {
+            throw std::runtime_error("Invalid compiled tile");
+        }
+        return;
+    }
+    if (!checker_->tiles_) return;
+
+    // Decoding checks the structure of the TES and the
+    // references to strings, tables and features
+    tile_.wayNodeIds(
+        (checker_->header_.flags & TesArchiveHeader::Flags::WAYNODE_IDS) != 0);
+    tile_.init(task.tile(), block.size() * 2);
+    TesReader reader(tile_);
+    reader.read(block.data(), block.size(),
+        (checker_->header_.flags & TesArchiveHeader::Flags::COLUMNAR_TES) != 0);
+    reader.verifyFullyRead();
+    tile_.clear();
+}
+
+void GobCheckerWorker::harvestResults()
+{
+    checker_->uncompressedBytes_ += uncompressedBytes_;
+}
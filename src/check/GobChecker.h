@@ -0,0 +1,124 @@
+// Copyright (c) 2025 Clarisma / GeoDesk contributors
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <clarisma/alloc/Block.h>
+#include <clarisma/io/File.h>
+#include <clarisma/thread/TaskEngine.h>
+#include <clarisma/zip/Zstd.h>
+#include <geodesk/feature/Tip.h>
+#include <geodesk/geom/Tile.h>
+#include "tile/model/TileModel.h"
+#include "tile/tes/TesArchive.h"
+
+using namespace clarisma;
+using namespace geodesk;
+
+class GobChecker;
+
+class GobCheckerTask
+{
+public:
+    GobCheckerTask() {} // TODO: only to satisfy compiler
+    GobCheckerTask(Tip tip, Tile tile, ByteBlock data) :
+        tip_(tip),
+        tile_(tile),
+        data_(std::move(data))
+    {
+    }
+
+    Tip tip() const { return tip_; }
+    Tile tile() const { return tile_; }
+    const uint8_t* data() const { return data_.data(); }
+    size_t size() const { return data_.size(); }
+
+private:
+    Tip tip_;
+    Tile tile_;
+    ByteBlock data_;
+};
+
+/// The outcome of checking a single tile; `error` is empty
+/// if the tile is valid
+///
+struct GobCheckerResult
+{
+    Tip tip;
+    std::string error;
+};
+
+
+class GobCheckerWorker
+{
+public:
+    explicit GobCheckerWorker(GobChecker* checker) : checker_(checker) {}
+    void processTask(GobCheckerTask& task);
+    void afterTasks() {}
+    void harvestResults();
+
+private:
+    void checkTile(const GobCheckerTask& task);
+
+    GobChecker* checker_;
+    TileModel tile_;            // reused for every tile
+    std::unique_ptr<ZstdDecompressor> zstd_;    // created on first use
+    uint64_t uncompressedBytes_ = 0;
+};
+
+
+/// Verifies a Geo-Object Bundle without loading it: checks the
+/// header, catalog and metadata, then uncompresses (which verifies
+/// the checksum of each tile) and decodes every tile in parallel,
+/// using the same TesReader as `gol load`. Corrupt tiles are
+/// reported by TIP. Compiled tiles are verified via their
+/// own checksum.
+///
+/// The tile of each TIP is taken from the tile index in the
+/// metadata; since a delta Bundle has none, its tiles are only
+/// checked for integrity, not decoded.
+///
+class GobChecker : public TaskEngine<GobChecker, GobCheckerWorker, GobCheckerTask, GobCheckerResult>
+{
+public:
+    explicit GobChecker(int threadCount) : TaskEngine(threadCount) {}
+
+    /// Returns the number of errors found
+    ///
+    int check(const char* fileName);
+    void processTask(GobCheckerResult& result);
+
+private:
+    // Errors are reported via error() by the main thread before the
+    // workers start, and by the output thread (processTask) while
+    // they run
+    void checkCatalog();
+    void checkMetadata(ByteBlock&& compressedMetadata);
+    void error(const char* message);
+    void error(Tip tip, const char* message);
+
+    const TesArchiveEntry* entries() const
+    {
+        return reinterpret_cast<const TesArchiveEntry*>(
+            catalog_.get() + sizeof(TesArchiveHeader));
+    }
+
+    File file_;
+    std::unique_ptr<uint8_t[]> catalog_;
+    uint32_t catalogSize_ = 0;
+    TesArchiveHeader header_;
+    std::unique_ptr<Tile[]> tiles_;     // empty for a delta
+    uint32_t tipCount_ = 0;
+    std::atomic<int> errorCount_ = 0;
+    uint32_t tilesChecked_ = 0;
+    double workPerTile_ = 0;
+    double workCompleted_ = 0;
+    uint64_t compressedBytes_ = 0;
+    uint64_t uncompressedBytes_ = 0;
+
+    friend class GobCheckerWorker;
+};
@@ -0,0 +1,123 @@
+// Copyright (c) 2025 Clarisma / GeoDesk contributors
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#ifdef CLARISMA_WITH_ZSTD
+
+#include <clarisma/zip/Zstd.h>
+#include <cassert>
+#include <cstring>
+#include <memory>
+#include <zstd.h>
+#include <zdict.h>
+#include <clarisma/util/Crc32C.h>
+#include <clarisma/zip/ZipException.h>
+
+namespace clarisma {
+
+static void checkZstd(size_t res)
+{
+    if (ZSTD_isError(res))
+    {
+        throw ZipException(ZSTD_getErrorName(res));
+    }
+}
+
+ZstdCompressor::ZstdCompressor(int level) :
+    ctx_(ZSTD_createCCtx())
+{
+    if (!ctx_) throw std::bad_alloc();
+    checkZstd(ZSTD_CCtx_setParameter(ctx_, ZSTD_c_compressionLevel, level));
+    // The chunk carries its own size and checksum
+    checkZstd(ZSTD_CCtx_setParameter(ctx_, ZSTD_c_contentSizeFlag, 0));
+    checkZstd(ZSTD_CCtx_setParameter(ctx_, ZSTD_c_checksumFlag, 0));
+    checkZstd(ZSTD_CCtx_setParameter(ctx_, ZSTD_c_dictIDFlag, 0));
+}
+
+ZstdCompressor::~ZstdCompressor()
+{
+    ZSTD_freeCCtx(ctx_);
+}
+
+void ZstdCompressor::setDictionary(const uint8_t* data, size_t size)
+{
+    checkZstd(ZSTD_CCtx_loadDictionary(ctx_, data, size));
+}
+
+ByteBlock ZstdCompressor::compressSealedChunk(const uint8_t* data, size_t size)
+{
+    assert(size <= 0xffff'ffff);
+    size_t maxCompressedSize = ZSTD_compressBound(size);
+    std::unique_ptr<uint8_t[]> out =
+        std::make_unique<uint8_t[]>(maxCompressedSize + 8);
+    uint8_t* p = out.get();
+    *reinterpret_cast<uint32_t*>(p) = static_cast<uint32_t>(size);
+    *reinterpret_cast<uint32_t*>(p + 4) = Crc32C::compute(data, size);
+
+    size_t compressedSize = ZSTD_compress2(ctx_, p + 8, maxCompressedSize, data, size);
+    checkZstd(compressedSize);
+    return ByteBlock(std::move(out), compressedSize + 8);
+}
+
+ZstdDecompressor::ZstdDecompressor() :
+    ctx_(ZSTD_createDCtx())
+{
+    if (!ctx_) throw std::bad_alloc();
+}
+
+ZstdDecompressor::~ZstdDecompressor()
+{
+    ZSTD_freeDCtx(ctx_);
+}
+
+void ZstdDecompressor::setDictionary(const uint8_t* data, size_t size)
+{
+    checkZstd(ZSTD_DCtx_loadDictionary(ctx_, data, size));
+}
+
+ByteBlock ZstdDecompressor::uncompressSealedChunk(const uint8_t* data, size_t size)
+{
+    if (size < 8) throw ZipException("Truncated chunk");
+    uint32_t sizeUncompressed = *reinterpret_cast<const uint32_t*>(data);
+    uint32_t checksum = *reinterpret_cast<const uint32_t*>(data + 4);
+    std::unique_ptr<uint8_t[]> out(new uint8_t[sizeUncompressed]);
+    size_t actualSize = ZSTD_decompressDCtx(ctx_, out.get(), sizeUncompressed,
+        data + 8, size - 8);
+    checkZstd(actualSize);
+    if (actualSize != sizeUncompressed)
+    {
+        throw ZipException("Uncompressed size does not match expected size");
+    }
+    if (Crc32C::compute(out.get(), sizeUncompressed) != checksum)
+    {
+        throw ZipException("Checksum mismatch");
+    }
+    return ByteBlock(std::move(out), sizeUncompressed);
+}
+
+namespace Zstd
+{
+ByteBlock trainDictionary(const std::vector<ByteBlock>& samples, size_t maxSize)
+{
+    size_t totalSize = 0;
+    for (const ByteBlock& sample : samples) totalSize += sample.size();
+    std::unique_ptr<uint8_t[]> sampleData(new uint8_t[totalSize]);
+    std::unique_ptr<size_t[]> sampleSizes(new size_t[samples.size()]);
+    uint8_t* p = sampleData.get();
+    for (size_t i = 0; i < samples.size(); i++)
+    {
+        memcpy(p, samples[i].data(), samples[i].size());
+        p += samples[i].size();
+        sampleSizes[i] = samples[i].size();
+    }
+
+    std::unique_ptr<uint8_t[]> dict(new uint8_t[maxSize]);
+    size_t dictSize = ZDICT_trainFromBuffer(dict.get(), maxSize,
+        sampleData.get(), sampleSizes.get(), static_cast<unsigned>(samples.size()));
+    if (ZDICT_isError(dictSize)) return ByteBlock();
+    return ByteBlock(std::move(dict), dictSize);
+}
+}
+
+} // namespace clarisma
+
+#endif
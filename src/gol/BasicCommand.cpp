@@ -93,6 +93,16 @@ int BasicCommand::run(char* argv[])
 }
 
 
+/// Parses the value of a `--tile-order` option: `size` (largest
+/// tiles first) or `index` (tile-index order).
+///
+bool BasicCommand::isLargestFirst(std::string_view tileOrder)
+{
+	if (tileOrder == "size") return true;
+	if (tileOrder == "index") return false;
+	throw ValueException("Must be \"size\" or \"index\"");
+}
+
 void BasicCommand::generalOptions(CliHelp& help)
 {
 	help.beginSection("General Options:");
@@ -79,6 +79,7 @@ protected:
 	}
 
 	void generalOptions(clarisma::CliHelp& help);
+	static bool isLargestFirst(std::string_view tileOrder);
 
 	int threadCount_;
 	bool yesToAllPrompts_;
@@ -0,0 +1,112 @@
+// Copyright (c) 2025 Clarisma / GeoDesk contributors
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#include "BenchCommand.h"
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <clarisma/cli/Console.h>
+#include <clarisma/io/FilePath.h>
+#include <clarisma/validate/Validate.h>
+#include <geodesk/feature/FeatureStore.h>
+#include "bench/Benchmarks.h"
+
+using namespace clarisma;
+using namespace geodesk;
+
+bool BenchCommand::setParam(int number, std::string_view value)
+{
+	switch (number)
+	{
+	case 0:
+		return true;   // command itself
+	case 1:
+		subject_ = value;
+		return true;
+	case 2:
+		if (subject_ == "tes-encoder" || subject_ == "tile-patch")
+		{
+			golPath_ = FilePath::withDefaultExtension(value, ".gol");
+			return true;
+		}
+		runs_ = Validate::intValue(value.data(), 1, 100);
+		return true;
+	case 3:
+		if (subject_ != "tes-encoder" && subject_ != "tile-patch") return false;
+		runs_ = Validate::intValue(value.data(), 1, 100);
+		return true;
+	case 4:
+		if (subject_ != "tile-patch") return false;
+		seed_ = static_cast<uint64_t>(Validate::longValue(value.data()));
+		hasSeed_ = true;
+		return true;
+	default:
+		return false;
+	}
+}
+
+int BenchCommand::run(char* argv[])
+{
+	int res = BasicCommand::run(argv);
+	if (res != 0) return res;
+	if (!hasSeed_)
+	{
+		seed_ = static_cast<uint64_t>(
+			std::chrono::steady_clock::now().time_since_epoch().count());
+	}
+
+	if (subject_ == "engines")
+	{
+		int threads = threadCount() ? threadCount() :
+			static_cast<int>(std::thread::hardware_concurrency());
+		Benchmarks::engines(threads, runs_);
+	}
+	else if (subject_ == "hilbert-sort")
+	{
+		Benchmarks::hilbertSort(runs_);
+	}
+	else if (subject_ == "rtree")
+	{
+		Benchmarks::rtree(runs_);
+	}
+	else if (subject_ == "feature-index")
+	{
+		Benchmarks::featureIndex(runs_);
+	}
+	else if (subject_ == "flat-id-map")
+	{
+		Benchmarks::flatIdMap(runs_);
+	}
+	else if (subject_ == "area-rules")
+	{
+		Benchmarks::areaRules(runs_);
+	}
+	else if (subject_ == "tes-encoder" || subject_ == "tile-patch")
+	{
+		if (golPath_.empty())
+		{
+			Console::end().failed() << "Expected a library";
+			return 1;
+		}
+		FeatureStore store;
+		store.open(golPath_.c_str(), FeatureStore::OpenMode::READ);
+		if (subject_ == "tes-encoder")
+		{
+			Benchmarks::tesEncoder(store, runs_);
+		}
+		else if (!Benchmarks::tilePatch(store, runs_, seed_))
+		{
+			char buf[128];
+			snprintf(buf, sizeof(buf), "Patched tiles differ from rebuilt tiles "
+				"(seed %llu)", static_cast<unsigned long long>(seed_));
+			Console::end().failed() << buf;
+			return 1;
+		}
+	}
+	else
+	{
+		Console::end().failed() << "Expected engines, hilbert-sort, rtree, feature-index, flat-id-map, area-rules, tes-encoder or tile-patch";
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,30 @@
+// Copyright (c) 2025 Clarisma / GeoDesk contributors
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#pragma once
+#include "BasicCommand.h"
+
+/// Runs one of the microbenchmarks in gol/bench:
+///
+///   gol bench <subject> [<runs>]
+///   gol bench tes-encoder <gol> [<runs>]
+///   gol bench tile-patch <gol> [<runs> [<seed>]]
+///
+/// tile-patch picks a seed from the clock unless one is given,
+/// and reports it if a patched tile differs
+///
+class BenchCommand : public BasicCommand
+{
+public:
+	int run(char* argv[]) override;
+
+protected:
+	bool setParam(int number, std::string_view value) override;
+
+private:
+	std::string_view subject_;
+	std::string golPath_;		// tes-encoder and tile-patch only
+	int runs_ = 3;
+	uint64_t seed_ = 0;			// tile-patch only
+	bool hasSeed_ = false;
+};
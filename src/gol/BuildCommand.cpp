@@ -3,6 +3,7 @@
 
 #include "BuildCommand.h"
 
+#include <cstdint>
 #include <iterator>
 #include <clarisma/cli/CliApplication.h>
 #include <clarisma/cli/CliHelp.h>
@@ -11,7 +12,10 @@
 
 BuildCommand::Option BuildCommand::BUILD_OPTIONS[] =
 {
+	{ "adaptive-branch-size", OPTION_METHOD(&BuildCommand::setAdaptiveBranchSize) },
+	{ "adaptive-threads",	OPTION_METHOD(&BuildCommand::setAdaptiveThreads) },
 	{ "areas",				OPTION_METHOD(&BuildCommand::setAreaRules) },
+	{ "feature-layout",		OPTION_METHOD(&BuildCommand::setFeatureLayout) },
  	{ "i",		OPTION_METHOD(&BuildCommand::setIdIndexing) },
  	{ "id-indexing",		OPTION_METHOD(&BuildCommand::setIdIndexing) },
 	{ "indexed-keys",		OPTION_METHOD(&BuildCommand::setIndexedKeys) },
@@ -19,14 +23,19 @@ BuildCommand::Option BuildCommand::BUILD_OPTIONS[] =
 	{ "l",					OPTION_METHOD(&BuildCommand::setLevels) },
 	{ "levels",				OPTION_METHOD(&BuildCommand::setLevels) },
 	{ "max-key-indexes",	OPTION_METHOD(&BuildCommand::setMaxKeyIndexes) },
+	{ "max-memory",			OPTION_METHOD(&BuildCommand::setMaxMemory) },
 	{ "max-strings",		OPTION_METHOD(&BuildCommand::setMaxStrings) },
 	{ "m",					OPTION_METHOD(&BuildCommand::setMaxTiles) },
 	{ "max-tiles",			OPTION_METHOD(&BuildCommand::setMaxTiles) },
 	{ "min-string-usage",	OPTION_METHOD(&BuildCommand::setMinStringUsage) },
 	{ "n",						   OPTION_METHOD(&BuildCommand::setMinTileDensity) },
 	{ "min-tile-density",	OPTION_METHOD(&BuildCommand::setMinTileDensity) },
+	{ "overlap-phases",		OPTION_METHOD(&BuildCommand::setOverlapPhases) },
 	{ "r",					OPTION_METHOD(&BuildCommand::setRTreeBranchSize) },
 	{ "rtree-branch-size",	OPTION_METHOD(&BuildCommand::setRTreeBranchSize) },
+	{ "rtree-packing",		OPTION_METHOD(&BuildCommand::setRTreePacking) },
+	{ "tile-layout",		OPTION_METHOD(&BuildCommand::setTileLayout) },
+	{ "tile-order",			OPTION_METHOD(&BuildCommand::setTileOrder) },
 	{ "u",					OPTION_METHOD(&BuildCommand::setUpdatable) },
 	{ "updatable",			OPTION_METHOD(&BuildCommand::setUpdatable) },
 	{ "w",					OPTION_METHOD(&BuildCommand::setWaynodeIds) },
@@ -60,6 +69,105 @@ int BuildCommand::setOption(std::string_view name, std::string_view value)
 	return BasicCommand::setOption(name, value);
 }
 
+/// Accepts a number of bytes, optionally followed by K, M, G or T
+///
+int BuildCommand::setMaxMemory(std::string_view s)
+{
+	if (s.empty()) throw ValueException("Must specify a size");
+	int shift = 0;
+	switch (s.back())
+	{
+	case 'K': case 'k': shift = 10; break;
+	case 'M': case 'm': shift = 20; break;
+	case 'G': case 'g': shift = 30; break;
+	case 'T': case 't': shift = 40; break;
+	}
+	if (shift) s.remove_suffix(1);
+	if (s.empty()) throw ValueException("Must be a size (e.g. 32G or 512M)");
+	uint64_t value = 0;
+	for (char ch : s)
+	{
+		uint64_t digit = static_cast<uint64_t>(ch - '0');
+		if (ch < '0' || ch > '9' ||
+			value > ((UINT64_MAX >> shift) - digit) / 10)
+		{
+			throw ValueException("Must be a size (e.g. 32G or 512M)");
+		}
+		value = value * 10 + digit;
+	}
+	settings().setMaxMemory(value << shift);
+	return 1;
+}
+
+int BuildCommand::setRTreePacking(std::string_view s)
+{
+	RTreePacking packing;
+	if (s == "hilbert")
+	{
+		packing = RTreePacking::HILBERT;
+	}
+	else if (s == "str")
+	{
+		packing = RTreePacking::STR;
+	}
+	else if (s == "omt")
+	{
+		packing = RTreePacking::OMT;
+	}
+	else if (s == "auto")
+	{
+		packing = RTreePacking::AUTO;
+	}
+	else
+	{
+		throw ValueException("Must be \"hilbert\", \"str\", \"omt\" or \"auto\"");
+	}
+	settings().setRTreePacking(packing);
+	return 1;
+}
+
+int BuildCommand::setFeatureLayout(std::string_view s)
+{
+	FeatureLayout layout;
+	if (s == "compact")
+	{
+		layout = FeatureLayout::COMPACT;
+	}
+	else if (s == "local")
+	{
+		layout = FeatureLayout::LOCAL;
+	}
+	else
+	{
+		throw ValueException("Must be \"compact\" or \"local\"");
+	}
+	settings().setFeatureLayout(layout);
+	return 1;
+}
+
+int BuildCommand::setTileLayout(std::string_view s)
+{
+	BuildSettings::TileLayout layout;
+	if (s == "zoom")
+	{
+		layout = BuildSettings::TileLayout::ZOOM_HILBERT;
+	}
+	else if (s == "hilbert")
+	{
+		layout = BuildSettings::TileLayout::HILBERT;
+	}
+	else if (s == "none")
+	{
+		layout = BuildSettings::TileLayout::COMPLETION;
+	}
+	else
+	{
+		throw ValueException("Must be \"zoom\", \"hilbert\" or \"none\"");
+	}
+	settings().setTileLayout(layout);
+	return 1;
+}
+
 int BuildCommand::run(char* argv[])
 {
 	int res = BasicCommand::run(argv);
@@ -143,6 +251,30 @@ void BuildCommand::help()
 		"(1 - 1000000, default: 300)");
 	help.option("-r, --rtree-branch-size <n>",
 		"Maximum items per R-tree branch (4-256, default: 16)");
+	help.option("--rtree-packing <algo>", "How features are packed into R-tree nodes:");
+	help.optionValue("hilbert", "Along a Hilbert curve (default)");
+	help.optionValue("str", "Sort-Tile-Recursive");
+	help.optionValue("omt", "Overlap-Minimizing Top-down");
+	help.optionValue("auto", "Cheapest of the above, chosen for each index");
+	help.option("--adaptive-branch-size",
+		"Choose half, single or double the branch size for each index");
+	help.endSection();
+
+	help.beginSection("Performance Options:");
+	help.option("--max-memory <size>", "Memory budget (e.g. 32G); limits threads per phase");
+	help.option("--adaptive-threads", "Vary the number of active threads based on throughput");
+	help.option("--tile-order <order>", "Order in which tiles are processed "
+		"(compiling follows --tile-layout unless it is none):");
+	help.optionValue("size", "Largest tiles first (default)");
+	help.optionValue("index", "Tile-index order");
+	help.option("--overlap-phases", "Compile tiles while others are still being validated");
+	help.option("--tile-layout <layout>", "Placement of tiles in the GOL:");
+	help.optionValue("zoom", "By zoom level (highest first), then along a Hilbert curve (default)");
+	help.optionValue("hilbert", "Along a Hilbert curve (same as zoom with --overlap-phases)");
+	help.optionValue("none", "In the order they are compiled");
+	help.option("--feature-layout <layout>", "Placement of feature bodies and strings in a tile:");
+	help.optionValue("compact", "After all spatial indexes (default)");
+	help.optionValue("local", "Next to the features in each R-tree leaf");
 	help.endSection();
 
 	generalOptions(help);
@@ -55,6 +55,8 @@ private:
 		return 1;
 	}
 
+	int setMaxMemory(std::string_view s);
+
 	int setMaxStrings(std::string_view s)
 	{
 		settings().setMaxStrings(Validate::longValue(s.data()));
@@ -73,18 +75,46 @@ private:
 		return 1;
 	}
 
+	int setAdaptiveBranchSize(std::string_view s)
+	{
+		settings().setAdaptiveBranchSize(true);
+		return 0;
+	}
+
+	int setAdaptiveThreads(std::string_view s)
+	{
+		settings().setAdaptiveThreads(true);
+		return 0;
+	}
+
 	int setMinStringUsage(std::string_view s)
 	{
 		settings().setMinStringUsage(Validate::longValue(s.data()));
 		return 1;
 	}
 
+	int setOverlapPhases(std::string_view s)
+	{
+		settings().setOverlapPhases(true);
+		return 0;
+	}
+
 	int setRTreeBranchSize(std::string_view s)
 	{
 		settings().setRTreeBranchSize(Validate::intValue(s.data()));
 		return 1;
 	}
 
+	int setRTreePacking(std::string_view s);
+	int setFeatureLayout(std::string_view s);
+	int setTileLayout(std::string_view s);
+
+	int setTileOrder(std::string_view s)
+	{
+		settings().setLargestTilesFirst(isLargestFirst(s));
+		return 1;
+	}
+
 	int setWaynodeIds(std::string_view s)
 	{
 		settings().setIncludeWayNodeIds(true);
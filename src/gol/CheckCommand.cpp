@@ -4,13 +4,38 @@
 #include "CheckCommand.h"
 
 #include <clarisma/io/FilePath.h>
+#include <clarisma/text/Format.h>
 
+#include "check/GobChecker.h"
 #include "check/GolChecker.h"
 
+CheckCommand::Option CheckCommand::OPTIONS[] =
+{
+	{ "tile-order",		OPTION_METHOD(&CheckCommand::setTileOrder) }
+};
+
+CheckCommand::CheckCommand()
+{
+	addOptions(OPTIONS, sizeof(OPTIONS) / sizeof(Option));
+}
+
+bool CheckCommand::setParam(int number, std::string_view value)
+{
+	if (number == 1 && std::string_view(FilePath::extension(value)) == ".gob")
+	{
+		gobPath_ = value;
+		golPath_ = value;		// (only so GolCommand won't show help)
+		openMode_ = DO_NOT_OPEN;
+		return true;
+	}
+	return GolCommand::setParam(number, value);
+}
+
 int CheckCommand::run(char* argv[])
 {
 	int res = GolCommand::run(argv);
 	if (res != 0) return res;
+	if (!gobPath_.empty()) return checkBundle();
 
 	std::string shortName(FilePath::name(store().fileName()));
 	ConsoleWriter out;
@@ -19,9 +44,31 @@ int CheckCommand::run(char* argv[])
 	out.flush();
 
 	GolChecker checker(store(), threadCount());
+	checker.setLargestFirst(largestFirst_);
 	// Console::get()->start("Checking tiles...");
 
 	checker.run();
 	Console::end().success() << "No errors found\n";
 	return 0;
 }
+
+// Verifies every tile of a Bundle, without writing a library
+int CheckCommand::checkBundle()
+{
+	ConsoleWriter out;
+	out << "Checking " << Console::FAINT_LIGHT_BLUE
+		<< FilePath::name(gobPath_) << Console::DEFAULT << ":";
+	out.flush();
+
+	GobChecker checker(threadCount());
+	int errorCount = checker.check(gobPath_.c_str());
+	if (errorCount)
+	{
+		char buf[64];
+		Format::unsafe(buf, "%d error%s found\n", errorCount, errorCount == 1 ? "" : "s");
+		Console::end().failed().writeString(buf);
+		return 1;
+	}
+	Console::end().success() << "No errors found\n";
+	return 0;
+}
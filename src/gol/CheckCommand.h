@@ -7,8 +7,30 @@
 #include <unordered_set>
 #include "tile/util/TileTaskEngine.h"
 
+/// Checks a library or, if given a .gob file, a Bundle:
+///
+///   gol check <gol> | <gob>
+///
 class CheckCommand : public GolCommand
 {
 public:
+	CheckCommand();
+
 	int run(char* argv[]) override;
+
+protected:
+	static Option OPTIONS[];
+
+	bool setParam(int number, std::string_view value) override;
+	int setTileOrder(std::string_view s)
+	{
+		largestFirst_ = isLargestFirst(s);
+		return 1;
+	}
+
+private:
+	int checkBundle();
+
+	std::string gobPath_;
+	bool largestFirst_ = false;
 };
@@ -4,6 +4,7 @@
 #include "GolTool.h"
 #include <unordered_map>
 #include <clarisma/cli/CliHelp.h>
+#include "BenchCommand.h"
 #include "BuildCommand.h"
 #include "CheckCommand.h"
 #include "CopyCommand.h"
@@ -32,6 +33,7 @@ int GolTool::run(char* argv[])
 		{ "copy", &GolTool::copy },
 #endif
 #ifdef GOL_DIAGNOSTICS
+		{ "bench", &GolTool::bench },
 		{ "dump-tiles", &GolTool::dumpTiles },
 		{ "test", &GolTool::test },
 #endif
@@ -91,6 +93,11 @@ int GolTool::copy(char* argv[])
 #endif
 
 #ifdef GOL_DIAGNOSTICS
+int GolTool::bench(char* argv[])
+{
+	return BenchCommand().run(argv);
+}
+
 int GolTool::dumpTiles(char* argv[])
 {
 	return DumpTilesCommand().run(argv);
@@ -14,6 +14,7 @@ private:
 	static int check(char* argv[]);
 	static int copy(char* argv[]);
 #ifdef GOL_DIAGNOSTICS
+	static int bench(char* argv[]);
 	static int dumpTiles(char* argv[]);
 	static int test(char* argv[]);
 #endif
@@ -6,6 +6,7 @@
 #include <clarisma/text/Table.h>
 #include <clarisma/util/FileSize.h>
 #include <geodesk/query/Query.h>
+#include "tile/compiler/IndexSettings.h"
 
 #include "geodesk/feature/TilePtr.h"
 
@@ -48,7 +49,10 @@ int InfoCommand::run(char* argv[])
         << store_.zoomLevels() << Console::DEFAULT << "\n";
 
     const FeatureStore::Header* header = store_.header();
-    out << "            Hilbert-" << header->settings.rtreeBranchSize << "  "
+    static const char* PACKING_NAMES[] = { "Hilbert", "STR", "OMT", "Mixed" };
+    out << "            "
+        << PACKING_NAMES[static_cast<int>(IndexSettings::rtreePackingOf(header->settings))]
+        << "-" << header->settings.rtreeBranchSize << "  "
         << static_cast<uint32_t>(header->settings.maxKeyIndexes) << " indexes (min. "
         << header->settings.keyIndexMinFeatures << " features)\n";
 
@@ -16,6 +16,7 @@ LoadCommand::Option LoadCommand::OPTIONS[] =
 {
 	{ "C",				OPTION_METHOD(&LoadCommand::setConnections) },
 	{ "connections",	OPTION_METHOD(&LoadCommand::setConnections) },
+	{ "tile-order",		OPTION_METHOD(&LoadCommand::setTileOrder) },
 	{ "w",				OPTION_METHOD(&LoadCommand::setWaynodeIds) },
 	{ "waynode-ids",	OPTION_METHOD(&LoadCommand::setWaynodeIds) }
 };
@@ -83,6 +84,7 @@ int LoadCommand::run(char* argv[])
 	}
 	
 	TileLoader loader(&store_, threadCount());
+	loader.setLargestFirst(largestFirst_);
 	if (isRemoteGob_)
 	{
 		loader.download(golPath_.c_str(), gobFileName_.c_str(), waynodeIds_,
@@ -105,6 +107,8 @@ void LoadCommand::help()
 
 	help.option("-C, --connections", "Max connections when downloading (default: 4)\n");
 	help.option("-w, --waynode-ids", "Include IDs of all nodes\n");
+	help.option("--tile-order <order>", "Order of loading local tiles: "
+		"size (largest first) or index (default)\n");
 	areaOptions(help);
 	generalOptions(help);
 }
@@ -22,6 +22,11 @@ protected:
 		return 0;
 	}
 	int setConnections(std::string_view s);
+	int setTileOrder(std::string_view s)
+	{
+		largestFirst_ = isLargestFirst(s);
+		return 1;
+	}
 	void help() override;
 
 	static constexpr int MIN_CONNECTIONS = 1;
@@ -30,5 +35,6 @@ protected:
 	std::string gobFileName_;
 	bool waynodeIds_ = false;
 	bool isRemoteGob_ = false;
+	bool largestFirst_ = false;
 	int connections_ = 4;
 };
\ No newline at end of file
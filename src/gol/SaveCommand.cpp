@@ -4,12 +4,20 @@
 #include "SaveCommand.h"
 #include <clarisma/cli/CliHelp.h>
 #include <clarisma/io/FilePath.h>
+#include <clarisma/text/Format.h>
+#include <clarisma/validate/Validate.h>
 #include <geodesk/query/TileIndexWalker.h>
 #include "gol/load/TileSaver.h"
 
 
 SaveCommand::Option SaveCommand::OPTIONS[] =
 {
+	{ "columnar",		OPTION_METHOD(&SaveCommand::setColumnar) },
+	{ "compiled",		OPTION_METHOD(&SaveCommand::setCompiled) },
+	{ "compression",	OPTION_METHOD(&SaveCommand::setCompression) },
+	{ "since",			OPTION_METHOD(&SaveCommand::setSince) },
+	{ "tile-order",		OPTION_METHOD(&SaveCommand::setTileOrder) },
+	{ "verify-encoding",	OPTION_METHOD(&SaveCommand::setVerifyEncoding) },
 	{ "w",				OPTION_METHOD(&SaveCommand::setWaynodeIds) },
 	{ "waynode-ids",	OPTION_METHOD(&SaveCommand::setWaynodeIds) }
 };
@@ -29,6 +37,46 @@ bool SaveCommand::setParam(int number, std::string_view value)
 	return GolCommand::setParam(number, value);
 }
 
+int SaveCommand::setCompression(std::string_view s)
+{
+	if (s == "deflate")
+	{
+		codec_ = TesArchiveHeader::DEFLATE;
+	}
+	else if (s == "zstd")
+	{
+		codec_ = TesArchiveHeader::ZSTD;
+	}
+	else
+	{
+		throw ValueException("Must be \"deflate\" or \"zstd\"");
+	}
+	return 1;
+}
+
+int SaveCommand::setSince(std::string_view s)
+{
+	sincePath_ = FilePath::withDefaultExtension(s, ".gob");
+	return 1;
+}
+
+int SaveCommand::setTileOrder(std::string_view s)
+{
+	if (s == "hilbert")
+	{
+		hilbertOrder_ = true;
+	}
+	else if (s == "index")
+	{
+		hilbertOrder_ = false;
+	}
+	else
+	{
+		throw ValueException("Must be \"hilbert\" or \"index\"");
+	}
+	return 1;
+}
+
 /*
 int GetCommand::setOption(std::string_view name, std::string_view value)
 {
@@ -46,6 +94,19 @@ int SaveCommand::run(char* argv[])
 	{
 		throw std::runtime_error("Library does not contain waynode IDs");
 	}
+	if (compiled_ && columnar_)
+	{
+		throw std::runtime_error("Compiled tiles are not stored as TES, "
+			"so --columnar does not apply");
+	}
+	if (!sincePath_.empty() &&
+		(filter_ || bounds_.area() < Box::ofWorld().area()))
+	{
+		// A delta steps the whole library from one revision to the
+		// next, so it must cover all tiles
+		throw std::runtime_error("A delta cannot be saved for an area; "
+			"omit -a and -b");
+	}
 
 	if (gobPath_.empty())
 	{
@@ -57,6 +118,7 @@ int SaveCommand::run(char* argv[])
 #endif
 
 	std::vector<std::pair<Tile, Tip>> tiles;
+	std::vector<Tip> missingTips;
 	TileIndexWalker tiw(store().tileIndex(), store().zoomLevels(), Box::ofWorld(), filter_.get());
 	// TODO: Take box from filter/bbox param
 	do
@@ -69,21 +131,49 @@ int SaveCommand::run(char* argv[])
 		{
 			tiles.emplace_back(tiw.currentTile(), tiw.currentTip());
 		}
+		else
+		{
+			missingTips.push_back(tiw.currentTip());
+		}
 	}
 	while (tiw.next());
 
-	ConsoleWriter() << "Saving "
+	ConsoleWriter out;
+	out << (sincePath_.empty() ? "Saving " : "Comparing ")
 		<< Console::FAINT_LIGHT_BLUE << FormattedLong(tiles.size())
 		<< Console::DEFAULT << (tiles.size()==1 ? " tile from " : " tiles from ")
-		<< Console::FAINT_LIGHT_BLUE << golPath_
-		<< Console::DEFAULT << " to "
+		<< Console::FAINT_LIGHT_BLUE << golPath_;
+	if (!sincePath_.empty())
+	{
+		out << Console::DEFAULT << " with "
+			<< Console::FAINT_LIGHT_BLUE << sincePath_;
+	}
+	out << Console::DEFAULT << " to "
 		<< Console::FAINT_LIGHT_BLUE << gobPath_
 		<< Console::DEFAULT << ":\n";
+	out.flush();
 
 	TileSaver saver(&store(), threadCount());
 	std::string tmpFilePath = gobPath_ + ".tmp";
-	saver.save(tmpFilePath.c_str(), tiles, waynodeIds_);
+	TileSaverSettings settings;
+	settings.wayNodeIds = waynodeIds_;
+	settings.codec = codec_;
+	settings.columnarTes = columnar_;
+	settings.compiledTiles = compiled_;
+	settings.hilbertOrder = hilbertOrder_;
+	settings.since = sincePath_;
+	settings.missingTips = std::move(missingTips);
+	settings.verifyEncoding = verifyEncoding_;
+	saver.save(tmpFilePath.c_str(), tiles, settings);
 	File::rename(tmpFilePath.c_str(), gobPath_.c_str());
+	if (!sincePath_.empty())
+	{
+		char buf[128];
+		Format::unsafe(buf, "Saved %u changed tiles, %u deleted.\n",
+			saver.changedTileCount(), saver.deletedTileCount());
+		Console::end().success().writeString(buf);
+		return 0;
+	}
 	Console::end().success() << "Done.\n";
 	return 0;
 }
@@ -95,6 +185,20 @@ void SaveCommand::help()
     help.command("gol save <gol-file> [<gob-file>] [<options>]",
         "Save a GOL's tiles as a Geo-Object Bundle.");
     // help.option("-M, --omit-metadata", "Omit metadata from GOB\n");
+	help.option("--columnar", "Group tile data by kind, which compresses better\n");
+	help.option("--compiled", "Save tiles ready to use (much faster to load by the same version of gol)\n");
+	help.option("--compression <codec>", "How tiles are compressed:");
+	help.optionValue("deflate", "Readable by all versions of gol (default)");
+	help.optionValue("zstd", "Smaller and faster to load, but not readable by older versions");
+	help.endSection();
+	help.option("--since <base-gob>", "Only save tiles that changed since the given Bundle "
+		"(cannot be combined with -a or -b)\n");
+	help.option("--tile-order <order>", "Order of tiles in the Bundle:");
+	help.optionValue("hilbert", "Nearby tiles are close together, so areas download faster (default)");
+	help.optionValue("index", "Same as in the tile index");
+	help.endSection();
+	help.option("--verify-encoding", "Encode every tile a second way, "
+		"and fail if the two differ (slow)\n");
 	help.option("-w, --waynode-ids", "Include IDs of all nodes\n");
     areaOptions(help);
     generalOptions(help);
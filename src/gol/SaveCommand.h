@@ -4,6 +4,7 @@
 #pragma once
 #include "GolCommand.h"
 #include <vector>
+#include "tile/tes/TesArchive.h"
 
 class SaveCommand : public GolCommand
 {
@@ -22,8 +23,32 @@ private:
 		waynodeIds_ = true;
 		return 0;
 	}
+	int setCompression(std::string_view s);
+	int setColumnar(std::string_view s)
+	{
+		columnar_ = true;
+		return 0;
+	}
+	int setCompiled(std::string_view s)
+	{
+		compiled_ = true;
+		return 0;
+	}
+	int setSince(std::string_view s);
+	int setTileOrder(std::string_view s);
+	int setVerifyEncoding(std::string_view s)
+	{
+		verifyEncoding_ = true;
+		return 0;
+	}
 	void help() override;
 
 	std::string gobPath_;
 	bool waynodeIds_ = false;
+	TesArchiveHeader::Codec codec_ = TesArchiveHeader::DEFLATE;
+	bool columnar_ = false;
+	bool compiled_ = false;
+	bool hilbertOrder_ = true;
+	bool verifyEncoding_ = false;
+	std::string sincePath_;
 };
\ No newline at end of file
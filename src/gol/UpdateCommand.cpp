@@ -14,7 +14,8 @@
 UpdateCommand::Option UpdateCommand::UPDATE_OPTIONS[] =
 {
     { "buffer",				OPTION_METHOD(&UpdateCommand::setBufferSize) },
-    { "B",	    			OPTION_METHOD(&UpdateCommand::setBufferSize) }
+    { "B",	    			OPTION_METHOD(&UpdateCommand::setBufferSize) },
+    { "verify-patches",		OPTION_METHOD(&UpdateCommand::setVerifyPatches) }
 };
 
 UpdateCommand::UpdateCommand()
@@ -95,6 +96,7 @@ int UpdateCommand::run(char* argv[])
         // TODO: maxMemory() not impleemnted for MacOS, returns 0
     }
     settings.setBufferSize(bufferSize_);
+    settings.setVerifyPatches(verifyPatches_);
     LOGS << "Buffer size = " << FileSize(bufferSize_);
     LOGS << "Max memory = " << SystemInfo::maxMemory();
     settings.complete();
@@ -115,6 +117,10 @@ void UpdateCommand::help()
     CliHelp help;
     help.command("gol update <gol-file> [<url> | <file>+] [<options>]",
         "Apply changes from a replication server or local files.");
+    help.beginSection("Update Options:");
+    help.option("--verify-patches", "Rebuild every patched tile as well, "
+        "and fail if the two differ (slow)");
+    help.endSection();
     areaOptions(help);
     generalOptions(help);
 }
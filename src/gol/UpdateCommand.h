@@ -18,9 +18,15 @@ private:
 
     bool setParam(int number, std::string_view value) override;
     int setBufferSize(std::string_view s);
+    int setVerifyPatches(std::string_view s)
+    {
+        verifyPatches_ = true;
+        return 0;
+    }
     void help() override;
 
     std::string_view url_;
     std::vector<const char*> files_;
     size_t bufferSize_ = 0;
+    bool verifyPatches_ = false;
 };
\ No newline at end of file
@@ -0,0 +1,193 @@
+// Copyright (c) 2025 Clarisma / GeoDesk contributors
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#include "Benchmarks.h"
+#include <algorithm>
+#include <cstdio>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <clarisma/cli/ConsoleWriter.h>
+#include "tag/AreaClassifier.h"
+
+using namespace clarisma;
+
+namespace {
+
+/// Stands in for the StringCatalog: every key and value of the rules
+/// gets a global code, except for a few that are left as local strings
+/// so the local-string paths of the classifier are exercised as well
+///
+class StringCodes
+{
+public:
+	explicit StringCodes(const std::vector<AreaClassifier::Entry>& entries)
+	{
+		codes_["no"] = GlobalStrings::NO;
+		codes_["yes"] = nextCode();
+		codes_["name"] = nextCode();
+		codes_["source"] = nextCode();
+		int valueCount = 0;
+		for (const AreaClassifier::Entry& entry : entries)
+		{
+			if (codes_.contains(entry.string)) continue;
+			if (entry.isKey)
+			{
+				if (entry.string == "area:highway") continue;   // local key
+			}
+			else
+			{
+				if ((++valueCount % 5) == 0) continue;   // local value
+			}
+			codes_[entry.string] = nextCode();
+		}
+	}
+
+	int operator()(std::string_view s) const
+	{
+		auto it = codes_.find(s);
+		return it == codes_.end() ? -1 : it->second;
+	}
+
+private:
+	int nextCode()
+	{
+		if (++lastCode_ == GlobalStrings::NO) ++lastCode_;
+		return lastCode_;
+	}
+
+	std::unordered_map<std::string_view,int> codes_;
+	int lastCode_ = 0;
+};
+
+void addTag(TagTableModel& tags, const StringCodes& codes,
+	std::string_view key, std::string_view value)
+{
+	int k = codes(key);
+	int v = codes(value);
+	if (k >= 0 && k <= TagValues::MAX_COMMON_KEY)
+	{
+		if (v >= 0)
+		{
+			tags.addGlobalTag(k, v);
+		}
+		else
+		{
+			tags.addGlobalTag(k, value);
+		}
+	}
+	else
+	{
+		if (v >= 0)
+		{
+			tags.addLocalTag(key, v);
+		}
+		else
+		{
+			tags.addLocalTag(key, value);
+		}
+	}
+}
+
+} // namespace
+
+
+void Benchmarks::areaRules(int runs)
+{
+	const int TABLE_COUNT = 200'000;
+
+	std::vector<AreaClassifier::Entry> entries =
+		AreaClassifier::Parser(AreaClassifier::DEFAULT).parseRules();
+	StringCodes codes(entries);
+	std::vector<std::string_view> keys;
+	std::vector<std::string_view> values = { "no", "yes", "other", "12", "3.5" };
+	for (const AreaClassifier::Entry& entry : entries)
+	{
+		(entry.isKey ? keys : values).push_back(entry.string);
+	}
+	keys.push_back("name");
+	keys.push_back("source");
+	keys.push_back("not_a_rule_key");
+	AreaClassifier classifier(entries,
+		[&codes](std::string_view s) { return codes(s); });
+
+	// Every key of the rules with every value that occurs in the rules
+	// (and a few that don't), followed by every pair of keys
+	// with random values, to cover the definite-key logic
+	uint64_t mismatches = 0;
+	uint64_t combinations = 0;
+	TagTableModel tags;
+	for (std::string_view key : keys)
+	{
+		for (std::string_view value : values)
+		{
+			tags.clear();
+			addTag(tags, codes, key, value);
+			mismatches += classifier.isArea(tags) != classifier.isAreaReference(tags);
+			combinations++;
+		}
+	}
+	Random random;
+	for (std::string_view key1 : keys)
+	{
+		for (std::string_view key2 : keys)
+		{
+			tags.clear();
+			addTag(tags, codes, key1, values[random.next() % values.size()]);
+			addTag(tags, codes, key2, values[random.next() % values.size()]);
+			mismatches += classifier.isArea(tags) != classifier.isAreaReference(tags);
+			combinations++;
+		}
+	}
+
+	// Random tag tables of 1 to 6 tags, mostly keys of the rules
+	std::vector<TagTableModel> tables(TABLE_COUNT);
+	for (TagTableModel& table : tables)
+	{
+		int tagCount = 1 + static_cast<int>(random.next() % 6);
+		for (int i = 0; i < tagCount; i++)
+		{
+			addTag(table, codes, keys[random.next() % keys.size()],
+				values[random.next() % values.size()]);
+		}
+	}
+
+	double compiledTime = 0;
+	double referenceTime = 0;
+	uint64_t compiledAreas = 0;
+	uint64_t referenceAreas = 0;
+	for (int run = 0; run < runs; run++)
+	{
+		compiledAreas = 0;
+		Clock::time_point start = Clock::now();
+		for (const TagTableModel& table : tables) compiledAreas += classifier.isArea(table);
+		double t = elapsedMillis(start);
+		compiledTime = (run == 0) ? t : std::min(compiledTime, t);
+
+		referenceAreas = 0;
+		start = Clock::now();
+		for (const TagTableModel& table : tables) referenceAreas += classifier.isAreaReference(table);
+		t = elapsedMillis(start);
+		referenceTime = (run == 0) ? t : std::min(referenceTime, t);
+	}
+	for (const TagTableModel& table : tables)
+	{
+		mismatches += classifier.isArea(table) != classifier.isAreaReference(table);
+	}
+	combinations += tables.size();
+
+	char buf[256];
+	snprintf(buf, sizeof(buf), "Checked %llu tag tables against the reference "
+		"matcher: %llu mismatches%s",
+		static_cast<unsigned long long>(combinations),
+		static_cast<unsigned long long>(mismatches),
+		mismatches == 0 ? "" : "  MISMATCH");
+	ConsoleWriter() << buf;
+	snprintf(buf, sizeof(buf), "%10s %12s %12s %8s",
+		"Tables", "reference ms", "compiled ms", "Speedup");
+	ConsoleWriter() << buf;
+	snprintf(buf, sizeof(buf), "%10zu %12.3f %12.3f %7.1fx%s",
+		tables.size(), referenceTime, compiledTime, referenceTime / compiledTime,
+		compiledAreas == referenceAreas ? "" : "  MISMATCH");
+	ConsoleWriter() << buf;
+}
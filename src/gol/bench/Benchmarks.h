@@ -0,0 +1,111 @@
+// Copyright (c) 2025 Clarisma / GeoDesk contributors
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+namespace geodesk {
+class FeatureStore;
+}
+
+namespace Benchmarks
+{
+/// Compares TaskEngine and WorkStealingTaskEngine on synthetic loads:
+///
+/// - "analyze": many short tasks of uniform cost, like the blocks
+///   decoded by the Analyzer
+/// - "compile": fewer tasks with a heavily skewed cost distribution,
+///   posted largest-first, like the piles handled by the Compiler;
+///   the work-stealing engine splits large tasks into child tasks
+///
+void engines(int threadCount, int runs);
+
+/// Compares the radix sort used by RTreeBuilder with a
+/// comparison sort, for tiles from a few hundred features up to the
+/// size of the largest tiles of a planet build
+///
+void hilbertSort(int runs);
+
+/// Measures the nodes visited and entries scanned by small-bbox
+/// queries against spatial indexes built with each packing
+/// algorithm and a range of branch sizes
+///
+void rtree(int runs);
+
+/// Compares the Validator's open-addressing VFeatureIndex with the
+/// chained table it replaced, using synthetic piles of up to a few
+/// million nodes (indexing by ID, resolving way nodes, and indexing
+/// by location)
+///
+void featureIndex(int runs);
+
+/// Compares the Compiler's FlatIdMap with the HashMap it replaced,
+/// for sequences of tiles (with a skewed size distribution) that
+/// reuse the same map: inserting node coordinates, resolving way
+/// nodes, and promoting a few nodes to feature nodes
+///
+void flatIdMap(int runs);
+
+/// Checks the compiled area-rule tables against the original
+/// matcher for the default rules (every key with every listed
+/// value, every pair of keys, and random tag tables), and times
+/// both on the random tables
+///
+void areaRules(int runs);
+
+/// Encodes every tile of a library as TES (version 2 and columnar)
+/// with BlobTesWriter and with TileReader + TesWriter, checks that
+/// both produce the same bytes, and times them
+///
+void tesEncoder(geodesk::FeatureStore& store, int runs);
+
+/// Differential test of tile patching: for every tile of a library,
+/// retags a few random features (with tags of other features or with
+/// new tag tables), then compiles the tile with verification, which
+/// also rebuilds it from scratch and compares the two. Run `i` uses
+/// `seed + i`. Returns `false` if any patched tile differs from its
+/// rebuilt counterpart.
+///
+bool tilePatch(geodesk::FeatureStore& store, int runs, uint64_t seed);
+
+// Helpers shared by the benchmarks
+
+using Clock = std::chrono::steady_clock;
+
+inline double elapsedMillis(Clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+/// A xorshift64 generator, so each benchmark sees the same
+/// synthetic data on every platform (given the same seed)
+///
+class Random
+{
+public:
+	explicit Random(uint64_t seed = 0x9E3779B97F4A7C15ULL) :
+		state_(seed | 1) {}		// xorshift must not start at 0
+
+	uint64_t next64()
+	{
+		state_ ^= state_ << 13;
+		state_ ^= state_ >> 7;
+		state_ ^= state_ << 17;
+		return state_;
+	}
+
+	uint32_t next()
+	{
+		return static_cast<uint32_t>(next64() >> 32);
+	}
+
+	int32_t between(int32_t min, int32_t max)
+	{
+		return min + static_cast<int32_t>(next() % (static_cast<uint32_t>(max - min) + 1));
+	}
+
+private:
+	uint64_t state_;
+};
+}
@@ -0,0 +1,184 @@
+// Copyright (c) 2025 Clarisma / GeoDesk contributors
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#include "Benchmarks.h"
+#include <algorithm>
+#include <cstdio>
+#include <type_traits>
+#include <vector>
+#include <clarisma/cli/ConsoleWriter.h>
+#include <clarisma/thread/TaskEngine.h>
+#include <clarisma/thread/WorkStealingTaskEngine.h>
+
+using namespace clarisma;
+
+namespace {
+
+struct BenchTask
+{
+	uint64_t seed = 0;
+	uint32_t cost = 0;		// iterations of busy work
+};
+
+struct BenchOutput
+{
+	uint64_t result = 0;
+};
+
+uint64_t burn(uint64_t seed, uint32_t iterations)
+{
+	uint64_t x = seed | 1;
+	for (uint32_t i = 0; i < iterations; i++)
+	{
+		x ^= x << 13;
+		x ^= x >> 7;
+		x ^= x << 17;
+	}
+	return x;
+}
+
+template<typename Engine>
+class BenchWorker
+{
+public:
+	explicit BenchWorker(Engine* engine) : engine_(engine) {}
+
+	void processTask(BenchTask& task) { engine_->processBenchTask(task); }		// CRTP override
+	void afterTasks() {}		// CRTP override
+	void harvestResults() {}	// CRTP override
+
+private:
+	Engine* engine_;
+};
+
+class ClassicEngine : public TaskEngine<ClassicEngine,
+	BenchWorker<ClassicEngine>, BenchTask, BenchOutput>
+{
+public:
+	explicit ClassicEngine(int threadCount) : TaskEngine(threadCount) {}
+
+	void processBenchTask(BenchTask& task)
+	{
+		postOutput(BenchOutput{ burn(task.seed, task.cost) });
+	}
+
+	void processTask(BenchOutput& output) { checksum_ ^= output.result; }	// CRTP override
+
+private:
+	uint64_t checksum_ = 0;
+};
+
+class StealingEngine : public WorkStealingTaskEngine<StealingEngine,
+	BenchWorker<StealingEngine>, BenchTask, BenchOutput>
+{
+public:
+	explicit StealingEngine(int threadCount) : WorkStealingTaskEngine(threadCount) {}
+
+	/// Tasks larger than this are split into child tasks
+	///
+	static constexpr uint32_t SPLIT_COST = 200'000;
+
+	void processBenchTask(BenchTask& task)
+	{
+		while (task.cost > SPLIT_COST)
+		{
+			task.cost -= SPLIT_COST;
+			spawn(BenchTask{ task.seed + task.cost, SPLIT_COST });
+		}
+		postOutput(BenchOutput{ burn(task.seed, task.cost) });
+	}
+
+	void processTask(BenchOutput& output) { checksum_ ^= output.result; }	// CRTP override
+
+	void reportStats(const WorkStealingStats& stats) { stats_ = stats; }	// CRTP override
+
+	WorkStealingStats lastStats() const { return stats_; }
+
+private:
+	uint64_t checksum_ = 0;
+	WorkStealingStats stats_;
+};
+
+std::vector<BenchTask> analyzerLoad()
+{
+	std::vector<BenchTask> tasks(200'000);
+	for (size_t i = 0; i < tasks.size(); i++)
+	{
+		tasks[i] = { i, 2'000 };
+	}
+	return tasks;
+}
+
+std::vector<BenchTask> compilerLoad()
+{
+	// Zipf-like: a few huge tiles, a long tail of small ones,
+	// largest first (as the Compiler posts them)
+	std::vector<BenchTask> tasks(4'000);
+	for (size_t i = 0; i < tasks.size(); i++)
+	{
+		tasks[i] = { i, std::max<uint32_t>(
+			static_cast<uint32_t>(50'000'000 / (i + 1)), 20'000) };
+	}
+	return tasks;
+}
+
+template<typename Engine>
+double runLoad(int threadCount, const std::vector<BenchTask>& tasks, WorkStealingStats* stats)
+{
+	Benchmarks::Clock::time_point start = Benchmarks::Clock::now();
+	Engine engine(threadCount);
+	engine.start();
+	for (BenchTask task : tasks)
+	{
+		engine.postWork(std::move(task));
+	}
+	engine.end();
+	if constexpr (std::is_same_v<Engine, StealingEngine>)
+	{
+		*stats = engine.lastStats();
+	}
+	return Benchmarks::elapsedMillis(start);
+}
+
+} // namespace
+
+
+void Benchmarks::engines(int threads, int runs)
+{
+	struct Load
+	{
+		const char* name;
+		std::vector<BenchTask> tasks;
+	};
+	Load loads[] = { { "analyze", analyzerLoad() }, { "compile", compilerLoad() } };
+
+	char buf[256];
+	snprintf(buf, sizeof(buf), "%-8s %10s %10s %10s %10s %10s",
+		"Load", "Shared ms", "Steal ms", "Steals", "Spawned", "Waits");
+	ConsoleWriter() << buf;
+	for (const Load& load : loads)
+	{
+		// Best of n runs for each engine
+		double shared = 0;
+		double stealing = 0;
+		WorkStealingStats stats;
+		for (int i = 0; i < runs; i++)
+		{
+			double t = runLoad<ClassicEngine>(threads, load.tasks, nullptr);
+			shared = (i == 0) ? t : std::min(shared, t);
+			WorkStealingStats runStats;
+			t = runLoad<StealingEngine>(threads, load.tasks, &runStats);
+			if (i == 0 || t < stealing)
+			{
+				stealing = t;
+				stats = runStats;
+			}
+		}
+		snprintf(buf, sizeof(buf), "%-8s %10.1f %10.1f %10llu %10llu %10llu",
+			load.name, shared, stealing,
+			static_cast<unsigned long long>(stats.steals),
+			static_cast<unsigned long long>(stats.spawned),
+			static_cast<unsigned long long>(stats.workerWaits + stats.producerWaits));
+		ConsoleWriter() << buf;
+	}
+}
@@ -0,0 +1,202 @@
+// Copyright (c) 2025 Clarisma / GeoDesk contributors
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#include "Benchmarks.h"
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+#include <clarisma/cli/ConsoleWriter.h>
+#include "build/sort/Validator.h"
+	// for VFeatureIndex and its dependencies
+
+using namespace clarisma;
+
+namespace {
+
+/// A local node as the Validator stored it before VFeature::next
+/// was removed (the chained index linked features through it)
+///
+struct ChainedNode
+{
+	VLocalNode node;
+	ChainedNode* next;
+};
+
+/// The chained index used by the Validator before it switched
+/// to open addressing (sized at one slot per 4 bytes of pile data)
+///
+class ChainedFeatureIndex
+{
+public:
+	void init(size_t pileSize)
+	{
+		table_.assign(pileSize / 4, nullptr);
+	}
+
+	void clear()
+	{
+		std::fill(table_.begin(), table_.end(), nullptr);
+	}
+
+	void addFeature(ChainedNode* f)
+	{
+		size_t slot = static_cast<uint64_t>(f->node.typedId()) % table_.size();
+		f->next = table_[slot];
+		table_[slot] = f;
+	}
+
+	VLocalNode* getNode(uint64_t id) const
+	{
+		TypedFeatureId typedId = TypedFeatureId::ofNode(id);
+		ChainedNode* f = table_[static_cast<uint64_t>(typedId) % table_.size()];
+		while (f)
+		{
+			if (typedId == f->node.typedId()) return &f->node;
+			f = f->next;
+		}
+		return nullptr;
+	}
+
+	VLocalNode* checkSharedLocation(ChainedNode* node)
+	{
+		size_t slot = std::hash<Coordinate>()(node->node.xy) % table_.size();
+		ChainedNode* first = table_[slot];
+		for (ChainedNode* f = first; f; f = f->next)
+		{
+			if (node->node.xy == f->node.xy) return &f->node;
+		}
+		node->next = first;
+		table_[slot] = node;
+		return nullptr;
+	}
+
+private:
+	std::vector<ChainedNode*> table_;
+};
+
+using Benchmarks::Clock;
+using Benchmarks::elapsedMillis;
+
+struct Timings
+{
+	double index = 0;
+	double lookup = 0;
+	double locations = 0;
+	uint64_t found = 0;		// must be the same for both tables
+
+	void min(const Timings& other, bool first)
+	{
+		index = first ? other.index : std::min(index, other.index);
+		lookup = first ? other.lookup : std::min(lookup, other.lookup);
+		locations = first ? other.locations : std::min(locations, other.locations);
+		found = other.found;
+	}
+};
+
+/// Runs the Validator's access pattern: index the nodes of a pile by
+/// ID, resolve way nodes (in way order, with some IDs that belong to
+/// other piles), then index the nodes by location
+///
+template<typename Index, typename Node>
+Timings measure(Index& index, std::vector<Node>& nodes,
+	const std::vector<uint64_t>& wayNodeIds, size_t pileSize)
+{
+	Timings t;
+	Clock::time_point start = Clock::now();
+	index.init(pileSize);
+	for (Node& node : nodes) index.addFeature(&node);
+	t.index = elapsedMillis(start);
+
+	start = Clock::now();
+	for (uint64_t id : wayNodeIds) t.found += index.getNode(id) != nullptr;
+	t.lookup = elapsedMillis(start);
+
+	start = Clock::now();
+	index.clear();
+	for (Node& node : nodes) t.found += index.checkSharedLocation(&node) != nullptr;
+	t.locations = elapsedMillis(start);
+	return t;
+}
+
+} // namespace
+
+
+void Benchmarks::featureIndex(int runs)
+{
+	// From a sparse pile to the largest piles of a planet build
+	const size_t SIZES[] = { 10'000, 100'000, 1'000'000, 4'000'000 };
+
+	char buf[256];
+	snprintf(buf, sizeof(buf), "%10s %12s %12s %8s",
+		"Nodes", "chained ms", "open ms", "Speedup");
+	ConsoleWriter() << buf;
+
+	Random random;
+
+	for (size_t count : SIZES)
+	{
+		// Node IDs of a pile are ascending with small gaps; about
+		// one node in 50 shares its location with another
+		std::vector<uint64_t> ids(count);
+		std::vector<Coordinate> locations(count);
+		uint64_t id = 1'000'000'000 + random.next64() % 1'000'000;
+		for (size_t i = 0; i < count; i++)
+		{
+			id += 1 + random.next64() % 4;
+			ids[i] = id;
+			locations[i] = (i > 0 && random.next64() % 50 == 0) ? locations[i - 1] :
+				Coordinate(static_cast<int32_t>(random.next64()), static_cast<int32_t>(random.next64()));
+		}
+
+		// Ways mostly refer to runs of nearby nodes; 5% of the
+		// references are to nodes in other piles
+		std::vector<uint64_t> wayNodeIds;
+		wayNodeIds.reserve(count * 2);
+		while (wayNodeIds.size() < count * 2)
+		{
+			size_t start = random.next64() % count;
+			size_t length = 2 + random.next64() % 20;
+			for (size_t i = start; i < std::min(start + length, count); i++)
+			{
+				wayNodeIds.push_back(random.next64() % 20 == 0 ? id + 1 + random.next64() % 1000 : ids[i]);
+			}
+		}
+
+		// Proto-GOL spends about 8 bytes on a node (ID delta, coordinates)
+		size_t pileSize = count * 8;
+		Timings chained;
+		Timings open;
+		for (int run = 0; run < runs; run++)
+		{
+			std::vector<ChainedNode> chainedNodes;
+			std::vector<VLocalNode> openNodes;
+			chainedNodes.reserve(count);
+			openNodes.reserve(count);
+			for (size_t i = 0; i < count; i++)
+			{
+				chainedNodes.push_back({ VLocalNode(ids[i], 0, locations[i]), nullptr });
+				openNodes.emplace_back(ids[i], 0, locations[i]);
+			}
+			ChainedFeatureIndex chainedIndex;
+			VFeatureIndex openIndex;
+			chained.min(measure(chainedIndex, chainedNodes, wayNodeIds, pileSize), run == 0);
+			open.min(measure(openIndex, openNodes, wayNodeIds, pileSize), run == 0);
+		}
+
+		double chainedTotal = chained.index + chained.lookup + chained.locations;
+		double openTotal = open.index + open.lookup + open.locations;
+		snprintf(buf, sizeof(buf), "%10zu %12.2f %12.2f %7.1fx%s",
+			count, chainedTotal, openTotal, chainedTotal / openTotal,
+			chained.found == open.found ? "" : "  MISMATCH");
+		ConsoleWriter() << buf;
+		snprintf(buf, sizeof(buf), "%10s %12.2f %12.2f   (index by ID)",
+			"", chained.index, open.index);
+		ConsoleWriter() << buf;
+		snprintf(buf, sizeof(buf), "%10s %12.2f %12.2f   (resolve way nodes)",
+			"", chained.lookup, open.lookup);
+		ConsoleWriter() << buf;
+		snprintf(buf, sizeof(buf), "%10s %12.2f %12.2f   (index by location)",
+			"", chained.locations, open.locations);
+		ConsoleWriter() << buf;
+	}
+}
@@ -0,0 +1,201 @@
+// Copyright (c) 2025 Clarisma / GeoDesk contributors
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#include "Benchmarks.h"
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+#include <clarisma/cli/ConsoleWriter.h>
+#include <clarisma/data/HashMap.h>
+#include <geodesk/geom/Coordinate.h>
+#include "build/util/FlatIdMap.h"
+
+using namespace clarisma;
+using namespace geodesk;
+
+namespace {
+
+using Benchmarks::Clock;
+using Benchmarks::elapsedMillis;
+
+/// The anonymous nodes of one tile, and the node IDs its ways refer to
+///
+struct SyntheticTile
+{
+	std::vector<uint64_t> ids;
+	std::vector<Coordinate> coords;
+	std::vector<uint64_t> wayNodeIds;
+	std::vector<uint64_t> promotedIds;
+};
+
+struct Timings
+{
+	double insert = 0;
+	double lookup = 0;
+	double extract = 0;
+	uint64_t found = 0;		// must be the same for both maps
+
+	double total() const { return insert + lookup + extract; }
+
+	void min(const Timings& other, bool first)
+	{
+		insert = first ? other.insert : std::min(insert, other.insert);
+		lookup = first ? other.lookup : std::min(lookup, other.lookup);
+		extract = first ? other.extract : std::min(extract, other.extract);
+		found = other.found;
+	}
+};
+
+// The old HashMap-based coords_, which CompilerWorker cleared
+// after each tile
+Timings measure(HashMap<uint64_t, Coordinate>& map, const std::vector<SyntheticTile>& tiles)
+{
+	Timings t;
+	for (const SyntheticTile& tile : tiles)
+	{
+		Clock::time_point start = Clock::now();
+		for (size_t i = 0; i < tile.ids.size(); i++) map[tile.ids[i]] = tile.coords[i];
+		t.insert += elapsedMillis(start);
+
+		start = Clock::now();
+		for (uint64_t id : tile.wayNodeIds)
+		{
+			auto it = map.find(id);
+			if (it != map.end()) t.found += it->second.x & 1;
+		}
+		t.lookup += elapsedMillis(start);
+
+		start = Clock::now();
+		for (uint64_t id : tile.promotedIds)
+		{
+			auto entry = map.extract(id);
+			t.found += !entry.empty();
+		}
+		map.clear();
+		t.extract += elapsedMillis(start);
+	}
+	return t;
+}
+
+Timings measure(FlatIdMap<Coordinate>& map, const std::vector<SyntheticTile>& tiles)
+{
+	Timings t;
+	for (const SyntheticTile& tile : tiles)
+	{
+		Clock::time_point start = Clock::now();
+		map.init(tile.ids.size() * 10 / 12);
+			// A node accounts for about 10 bytes of pile data, and
+			// the Compiler sizes coords_ at 12 bytes per node
+		for (size_t i = 0; i < tile.ids.size(); i++) map[tile.ids[i]] = tile.coords[i];
+		t.insert += elapsedMillis(start);
+
+		start = Clock::now();
+		for (uint64_t id : tile.wayNodeIds)
+		{
+			const Coordinate* xy = map.find(id);
+			if (xy) t.found += xy->x & 1;
+		}
+		t.lookup += elapsedMillis(start);
+
+		start = Clock::now();
+		for (uint64_t id : tile.promotedIds)
+		{
+			Coordinate xy;
+			t.found += map.extract(id, xy);
+		}
+		t.extract += elapsedMillis(start);
+	}
+	return t;
+}
+
+} // namespace
+
+
+void Benchmarks::flatIdMap(int runs)
+{
+	// Sequences of tiles as a CompilerWorker sees them: mostly small
+	// tiles with the occasional large one, up to the largest tiles
+	// of a planet build
+	const size_t MAX_SIZES[] = { 10'000, 100'000, 1'000'000, 4'000'000 };
+	const int TILE_COUNT = 64;
+
+	char buf[256];
+	snprintf(buf, sizeof(buf), "%10s %10s %12s %12s %8s",
+		"Max nodes", "Total", "HashMap ms", "FlatIdMap ms", "Speedup");
+	ConsoleWriter() << buf;
+
+	Random random;
+
+	for (size_t maxSize : MAX_SIZES)
+	{
+		std::vector<SyntheticTile> tiles(TILE_COUNT);
+		size_t totalCount = 0;
+		for (SyntheticTile& tile : tiles)
+		{
+			// Tile sizes are heavily skewed: most tiles are small
+			size_t count = std::max<size_t>(maxSize >> (random.next64() % 8), 100);
+			totalCount += count;
+			tile.ids.resize(count);
+			tile.coords.resize(count);
+			uint64_t id = 1'000'000'000 + random.next64() % 1'000'000;
+			for (size_t i = 0; i < count; i++)
+			{
+				id += 1 + random.next64() % 4;
+				tile.ids[i] = id;
+				tile.coords[i] = Coordinate(static_cast<int32_t>(random.next64()),
+					static_cast<int32_t>(random.next64()));
+			}
+
+			// Ways mostly refer to runs of nearby nodes; 5% of the
+			// references are to feature nodes or foreign nodes (which
+			// aren't in coords_)
+			tile.wayNodeIds.reserve(count * 2);
+			while (tile.wayNodeIds.size() < count * 2)
+			{
+				size_t start = random.next64() % count;
+				size_t length = 2 + random.next64() % 20;
+				for (size_t i = start; i < std::min(start + length, count); i++)
+				{
+					tile.wayNodeIds.push_back(random.next64() % 20 == 0 ?
+						id + 1 + random.next64() % 1000 : tile.ids[i]);
+				}
+			}
+
+			// A few anonymous nodes are relation members, which
+			// promotes them to feature nodes
+			for (size_t i = 0; i < count / 200; i++)
+			{
+				tile.promotedIds.push_back(tile.ids[random.next64() % count]);
+			}
+			std::sort(tile.promotedIds.begin(), tile.promotedIds.end());
+			tile.promotedIds.erase(std::unique(tile.promotedIds.begin(),
+				tile.promotedIds.end()), tile.promotedIds.end());
+		}
+
+		Timings hashMap;
+		Timings flat;
+		for (int run = 0; run < runs; run++)
+		{
+			// Like a worker, each map is reused for the whole sequence
+			HashMap<uint64_t, Coordinate> hashMapCoords;
+			FlatIdMap<Coordinate> flatCoords;
+			hashMap.min(measure(hashMapCoords, tiles), run == 0);
+			flat.min(measure(flatCoords, tiles), run == 0);
+		}
+
+		snprintf(buf, sizeof(buf), "%10zu %10zu %12.2f %12.2f %7.1fx%s",
+			maxSize, totalCount, hashMap.total(), flat.total(),
+			hashMap.total() / flat.total(),
+			hashMap.found == flat.found ? "" : "  MISMATCH");
+		ConsoleWriter() << buf;
+		snprintf(buf, sizeof(buf), "%21s %12.2f %12.2f   (insert coordinates)",
+			"", hashMap.insert, flat.insert);
+		ConsoleWriter() << buf;
+		snprintf(buf, sizeof(buf), "%21s %12.2f %12.2f   (resolve way nodes)",
+			"", hashMap.lookup, flat.lookup);
+		ConsoleWriter() << buf;
+		snprintf(buf, sizeof(buf), "%21s %12.2f %12.2f   (promote and clear)",
+			"", hashMap.extract, flat.extract);
+		ConsoleWriter() << buf;
+	}
+}
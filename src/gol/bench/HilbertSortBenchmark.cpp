@@ -0,0 +1,89 @@
+// Copyright (c) 2025 Clarisma / GeoDesk contributors
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#include "Benchmarks.h"
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <vector>
+#include <clarisma/cli/ConsoleWriter.h>
+#include "tile/compiler/RTreeBuilder.h"
+
+using namespace clarisma;
+
+namespace {
+
+/// The items sorted by RTreeBuilder before it switched
+/// to a radix sort
+///
+struct ComparisonItem
+{
+	uint32_t distance;
+	void* feature;
+
+	bool operator<(const ComparisonItem& other) const
+	{
+		return distance < other.distance;
+	}
+};
+
+} // namespace
+
+
+void Benchmarks::hilbertSort(int runs)
+{
+	// From a sparse tile up to the largest tiles of a planet build
+	// (which hold a few million features at the default settings)
+	const size_t SIZES[] = { 256, 4'096, 65'536, 524'288, 2'097'152 };
+
+	char buf[256];
+	snprintf(buf, sizeof(buf), "%10s %12s %12s %8s",
+		"Features", "std::sort ms", "radix ms", "Speedup");
+	ConsoleWriter() << buf;
+
+	Random random;
+	for (size_t count : SIZES)
+	{
+		std::vector<uint32_t> distances(count);
+		for (uint32_t& distance : distances) distance = random.next();
+
+		std::vector<ComparisonItem> items(count);
+		std::unique_ptr<uint64_t[]> keys(new uint64_t[count]);
+		std::unique_ptr<uint64_t[]> scratch(new uint64_t[count]);
+		double comparisonTime = 0;
+		double radixTime = 0;
+		bool identical = true;
+		for (int run = 0; run < runs; run++)
+		{
+			for (size_t i = 0; i < count; i++)
+			{
+				items[i] = { distances[i], &items[i] };
+			}
+			Clock::time_point start = Clock::now();
+			std::sort(items.begin(), items.end());
+			double t = elapsedMillis(start);
+			comparisonTime = (run == 0) ? t : std::min(comparisonTime, t);
+
+			for (size_t i = 0; i < count; i++)
+			{
+				keys[i] = (static_cast<uint64_t>(distances[i]) << 32) | i;
+			}
+			start = Clock::now();
+			const uint64_t* sorted = RTreeBuilder::sortByDistance(
+				keys.get(), scratch.get(), count);
+			t = elapsedMillis(start);
+			radixTime = (run == 0) ? t : std::min(radixTime, t);
+
+			for (size_t i = 0; i < count; i++)
+			{
+				identical &= static_cast<uint32_t>(sorted[i] >> 32) == items[i].distance;
+				identical &= i == 0 || sorted[i - 1] < sorted[i];
+					// equal distances must keep their original order
+			}
+		}
+		snprintf(buf, sizeof(buf), "%10zu %12.3f %12.3f %7.1fx%s",
+			count, comparisonTime, radixTime, comparisonTime / radixTime,
+			identical ? "" : "  MISMATCH");
+		ConsoleWriter() << buf;
+	}
+}
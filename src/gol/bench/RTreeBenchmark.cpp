@@ -0,0 +1,215 @@
+// Copyright (c) 2025 Clarisma / GeoDesk contributors
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#include "Benchmarks.h"
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+#include <clarisma/cli/ConsoleWriter.h>
+#include <geodesk/geom/index/hilbert.h>
+#include "tile/compiler/RTreeBuilder.h"
+#include "tile/compiler/RTreePacker.h"
+
+using namespace clarisma;
+
+namespace {
+
+/// A plain in-memory R-tree, which records the number of nodes
+/// visited and entries scanned by each query
+///
+class BenchTree
+{
+public:
+	using Node = uint32_t;
+
+	explicit BenchTree(const std::vector<Box>& items) : items_(items) {}
+
+	Node leaf(const uint32_t* items, int count)
+	{
+		Box bounds;
+		for (int i = 0; i < count; i++) bounds.expandToIncludeSimple(items_[items[i]]);
+		return addNode(bounds, true, items, count);
+	}
+
+	Node trunk(const Node* children, int count)
+	{
+		Box bounds;
+		for (int i = 0; i < count; i++) bounds.expandToIncludeSimple(nodes_[children[i]].bounds);
+		return addNode(bounds, false, children, count);
+	}
+
+	Box bounds(Node node) const { return nodes_[node].bounds; }
+
+	void setRoot(Node root) { root_ = root; }
+
+	/// Returns the number of items that intersect the given box
+	///
+	uint64_t query(const Box& box)
+	{
+		return query(root_, box);
+	}
+
+	size_t nodeCount() const { return nodes_.size(); }
+	uint64_t nodesVisited() const { return nodesVisited_; }
+	uint64_t entriesScanned() const { return entriesScanned_; }
+
+private:
+	struct TreeNode
+	{
+		Box bounds;
+		uint32_t firstChild;
+		uint32_t childCount;
+		bool isLeaf;
+	};
+
+	static bool intersects(const Box& a, const Box& b)
+	{
+		return a.minX() <= b.maxX() && a.maxX() >= b.minX() &&
+			a.minY() <= b.maxY() && a.maxY() >= b.minY();
+	}
+
+	Node addNode(const Box& bounds, bool isLeaf, const uint32_t* children, int count)
+	{
+		nodes_.push_back({ bounds, static_cast<uint32_t>(children_.size()),
+			static_cast<uint32_t>(count), isLeaf });
+		children_.insert(children_.end(), children, children + count);
+		return static_cast<Node>(nodes_.size() - 1);
+	}
+
+	uint64_t query(Node n, const Box& box)
+	{
+		const TreeNode& node = nodes_[n];
+		nodesVisited_++;
+		entriesScanned_ += node.childCount;
+		uint64_t found = 0;
+		for (uint32_t i = 0; i < node.childCount; i++)
+		{
+			uint32_t child = children_[node.firstChild + i];
+			if (node.isLeaf)
+			{
+				found += intersects(items_[child], box) ? 1 : 0;
+			}
+			else if (intersects(nodes_[child].bounds, box))
+			{
+				found += query(child, box);
+			}
+		}
+		return found;
+	}
+
+	const std::vector<Box>& items_;
+	std::vector<TreeNode> nodes_;
+	std::vector<uint32_t> children_;
+	Node root_ = 0;
+	uint64_t nodesVisited_ = 0;
+	uint64_t entriesScanned_ = 0;
+};
+
+} // namespace
+
+
+void Benchmarks::rtree(int runs)
+{
+	// A tile with clustered features (settlements) on a sparse
+	// background: 90% points, the rest small ways and areas
+	const int32_t TILE_SIZE = 1 << 24;
+	const Box tileBounds(0, 0, TILE_SIZE - 1, TILE_SIZE - 1);
+	const int FEATURE_COUNT = 200'000;
+	const int CLUSTER_COUNT = 200;
+	const int QUERY_COUNT = 2'000 * runs;
+
+	Random random;
+	std::vector<Coordinate> clusters;
+	for (int i = 0; i < CLUSTER_COUNT; i++)
+	{
+		clusters.emplace_back(random.between(0, TILE_SIZE - 1),
+			random.between(0, TILE_SIZE - 1));
+	}
+	std::vector<Box> items;
+	std::vector<Coordinate> centers;
+	for (int i = 0; i < FEATURE_COUNT; i++)
+	{
+		int32_t x;
+		int32_t y;
+		if (i % 5 == 0)
+		{
+			x = random.between(0, TILE_SIZE - 1);
+			y = random.between(0, TILE_SIZE - 1);
+		}
+		else
+		{
+			Coordinate c = clusters[random.next() % CLUSTER_COUNT];
+			int32_t spread = TILE_SIZE / 256;
+			x = std::clamp(c.x + random.between(-spread, spread), 0, TILE_SIZE - 1);
+			y = std::clamp(c.y + random.between(-spread, spread), 0, TILE_SIZE - 1);
+		}
+		int32_t w = (i % 10 == 0) ? random.between(0, TILE_SIZE / 512) : 0;
+		int32_t h = (i % 10 == 0) ? random.between(0, TILE_SIZE / 512) : 0;
+		Box box(x, y, std::min(x + w, TILE_SIZE - 1), std::min(y + h, TILE_SIZE - 1));
+		items.push_back(box);
+		centers.push_back(box.center());
+	}
+
+	std::vector<uint64_t> keys(items.size());
+	std::vector<uint64_t> scratch(items.size());
+	for (uint32_t i = 0; i < items.size(); i++)
+	{
+		keys[i] = (static_cast<uint64_t>(
+			hilbert::calculateHilbertDistance(centers[i], tileBounds)) << 32) | i;
+	}
+	const uint64_t* sorted = RTreeBuilder::sortByDistance(
+		keys.data(), scratch.data(), keys.size());
+	std::vector<uint32_t> hilbertOrder(items.size());
+	for (size_t i = 0; i < items.size(); i++)
+	{
+		hilbertOrder[i] = static_cast<uint32_t>(sorted[i]);
+	}
+
+	// Small bboxes, from a building to a neighborhood
+	std::vector<Box> queries;
+	for (int i = 0; i < QUERY_COUNT; i++)
+	{
+		int32_t size = random.between(TILE_SIZE / 4096, TILE_SIZE / 128);
+		int32_t x = random.between(0, TILE_SIZE - 1 - size);
+		int32_t y = random.between(0, TILE_SIZE - 1 - size);
+		queries.emplace_back(x, y, x + size, y + size);
+	}
+
+	struct Packing
+	{
+		const char* name;
+		RTreePacking packing;
+	};
+	const Packing PACKINGS[] =
+	{
+		{ "Hilbert", RTreePacking::HILBERT },
+		{ "STR", RTreePacking::STR },
+		{ "OMT", RTreePacking::OMT }
+	};
+	const int BRANCH_SIZES[] = { 8, 16, 32 };
+
+	char buf[256];
+	snprintf(buf, sizeof(buf), "%-8s %6s %8s %14s %14s",
+		"Packing", "Branch", "Nodes", "Visits/query", "Scans/query");
+	ConsoleWriter() << buf;
+	uint64_t expectedFound = 0;
+	for (const Packing& packing : PACKINGS)
+	{
+		for (int branchSize : BRANCH_SIZES)
+		{
+			BenchTree tree(items);
+			std::vector<uint32_t> order = hilbertOrder;
+			RTreePacker<BenchTree> packer(tree, centers.data(), branchSize);
+			tree.setRoot(packer.pack(packing.packing, order.data(), order.size()));
+			uint64_t found = 0;
+			for (const Box& query : queries) found += tree.query(query);
+			if (expectedFound == 0) expectedFound = found;
+			snprintf(buf, sizeof(buf), "%-8s %6d %8zu %14.1f %14.1f%s",
+				packing.name, branchSize, tree.nodeCount(),
+				static_cast<double>(tree.nodesVisited()) / queries.size(),
+				static_cast<double>(tree.entriesScanned()) / queries.size(),
+				found == expectedFound ? "" : "  MISMATCH");
+			ConsoleWriter() << buf;
+		}
+	}
+}
@@ -0,0 +1,117 @@
+// Copyright (c) 2025 Clarisma / GeoDesk contributors
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#include "Benchmarks.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <clarisma/cli/ConsoleWriter.h>
+#include <clarisma/util/Buffer.h>
+#include <geodesk/feature/FeatureStore.h>
+#include <geodesk/query/TileIndexWalker.h>
+#include "tile/model/TileModel.h"
+#include "tile/model/TileReader.h"
+#include "tile/tes/BlobTesWriter.h"
+#include "tile/tes/TesWriter.h"
+
+using namespace clarisma;
+using namespace geodesk;
+
+namespace {
+
+ByteBlock encodeWithModel(TileModel& tile, Tile tileBounds, TilePtr pTile,
+	bool wayNodeIds, bool columnar)
+{
+	tile.wayNodeIds(wayNodeIds);
+	TileReader reader(tile);
+	reader.readTile(tileBounds, pTile);
+	DynamicBuffer buf(1024 * 1024);
+	TesWriter writer(tile, &buf, columnar);
+	writer.write();
+	tile.clear();
+	return buf.takeBytes();
+}
+
+bool isSame(const ByteBlock& a, const ByteBlock& b)
+{
+	return a.size() == b.size() && memcmp(a.data(), b.data(), a.size()) == 0;
+}
+
+} // namespace
+
+
+void Benchmarks::tesEncoder(FeatureStore& store, int runs)
+{
+	std::vector<std::pair<Tile,TilePtr>> tiles;
+	TileIndexWalker tiw(store.tileIndex(), store.zoomLevels(), Box::ofWorld(), nullptr);
+	do
+	{
+		if (tiw.currentEntry().isLoadedAndCurrent())
+		{
+			tiles.emplace_back(tiw.currentTile(),
+				TilePtr(store.fetchTile(tiw.currentTip())));
+		}
+	}
+	while (tiw.next());
+
+	bool wayNodeIds = store.hasWaynodeIds();
+	TileModel model;
+	BlobTesWriter direct;
+	direct.wayNodeIds(wayNodeIds);
+
+	char buf[256];
+	snprintf(buf, sizeof(buf), "%-9s %8s %12s %10s %10s %8s",
+		"Format", "Tiles", "TES bytes", "model ms", "direct ms", "Speedup");
+	ConsoleWriter() << buf;
+
+	for (int columnar = 0; columnar < 2; columnar++)
+	{
+		direct.columnar(columnar);
+
+		// Both encoders must produce the same bytes for every tile
+		uint64_t mismatches = 0;
+		uint64_t totalBytes = 0;
+		for (const auto& [tile, pTile] : tiles)
+		{
+			ByteBlock expected = encodeWithModel(model, tile, pTile, wayNodeIds, columnar);
+			ByteBlock actual = direct.write(tile, pTile);
+			mismatches += !isSame(expected, actual);
+			totalBytes += expected.size();
+		}
+
+		double modelTime = 0;
+		double directTime = 0;
+		for (int run = 0; run < runs; run++)
+		{
+			Clock::time_point start = Clock::now();
+			for (const auto& [tile, pTile] : tiles)
+			{
+				encodeWithModel(model, tile, pTile, wayNodeIds, columnar);
+			}
+			double t = elapsedMillis(start);
+			modelTime = (run == 0) ? t : std::min(modelTime, t);
+
+			start = Clock::now();
+			for (const auto& [tile, pTile] : tiles)
+			{
+				direct.write(tile, pTile);
+			}
+			t = elapsedMillis(start);
+			directTime = (run == 0) ? t : std::min(directTime, t);
+		}
+
+		snprintf(buf, sizeof(buf), "%-9s %8zu %12llu %10.1f %10.1f %7.1fx%s",
+			columnar ? "columnar" : "v2", tiles.size(),
+			static_cast<unsigned long long>(totalBytes),
+			modelTime, directTime, modelTime / directTime,
+			mismatches == 0 ? "" : "  MISMATCH");
+		ConsoleWriter() << buf;
+		if (mismatches)
+		{
+			snprintf(buf, sizeof(buf), "%llu tiles encoded differently",
+				static_cast<unsigned long long>(mismatches));
+			ConsoleWriter() << buf;
+		}
+	}
+}
@@ -0,0 +1,123 @@
+// Copyright (c) 2025 Clarisma / GeoDesk contributors
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#include "Benchmarks.h"
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+#include <vector>
+#include <clarisma/cli/ConsoleWriter.h>
+#include <geodesk/feature/FeatureStore.h>
+#include <geodesk/query/TileIndexWalker.h>
+#include "tile/compiler/TagTableWriter.h"
+#include "tile/compiler/TileCompiler.h"
+#include "tile/model/MutableFeaturePtr.h"
+#include "tile/model/TileModel.h"
+
+using namespace clarisma;
+using namespace geodesk;
+
+namespace {
+
+struct Counts
+{
+	uint64_t patched = 0;
+	uint64_t rebuilt = 0;
+	uint64_t mismatches = 0;
+	double millis = 0;
+};
+
+/// Creates a tag table with a single global key and a narrow
+/// number value, the way TesReader creates tag tables
+///
+TTagTable* createTags(TileModel& tile, uint32_t keyCode, uint32_t value)
+{
+	TTagTable* tags = tile.beginTagTable(4, 0);
+	TagTableWriter writer(tags->handle(), tags->data());
+	writer.endLocalTags();
+	writer.writeGlobalTag(0, keyCode, value);
+	writer.endGlobalTags();
+	return tile.completeTagTable(tags, static_cast<uint32_t>(writer.hash()), false);
+}
+
+} // namespace
+
+
+bool Benchmarks::tilePatch(FeatureStore& store, int runs, uint64_t seed)
+{
+	std::vector<std::pair<Tip,Tile>> tiles;
+	TileIndexWalker tiw(store.tileIndex(), store.zoomLevels(), Box::ofWorld(), nullptr);
+	do
+	{
+		if (tiw.currentEntry().isLoadedAndCurrent())
+		{
+			tiles.emplace_back(tiw.currentTip(), tiw.currentTile());
+		}
+	}
+	while (tiw.next());
+
+	char buf[256];
+	snprintf(buf, sizeof(buf), "Seed: %llu", static_cast<unsigned long long>(seed));
+	ConsoleWriter() << buf;
+	snprintf(buf, sizeof(buf), "%4s %8s %8s %8s %10s %10s",
+		"Run", "Tiles", "Patched", "Rebuilt", "Mismatch", "ms");
+	ConsoleWriter() << buf;
+
+	TileCompiler compiler(&store);
+	compiler.verifyPatches(true);
+	std::vector<TFeature*> features;
+	uint64_t totalMismatches = 0;
+	for (int run = 0; run < runs; run++)
+	{
+		Random random(seed + run);
+
+		Counts counts;
+		Clock::time_point start = Clock::now();
+		for (const auto& [tip, tile] : tiles)
+		{
+			compiler.modifyTile(tip, tile);
+			TileModel& model = compiler.tile();
+			features.clear();
+			FeatureTable::Iterator iter = model.iterFeatures();
+			while (iter.hasNext()) features.push_back(iter.next());
+			if (features.empty()) continue;
+
+			// Retag a few random features, giving each either the tags
+			// of another feature or a new tag table (which the patch
+			// must append to the tile); some of these changes move a
+			// feature to a different index, which forces a rebuild
+			size_t changes = 1 + random.next64() % std::min<size_t>(features.size(), 32);
+			for (size_t i = 0; i < changes; i++)
+			{
+				TFeature* feature = features[random.next64() % features.size()];
+				TTagTable* tags = (random.next64() & 1) ?
+					features[random.next64() % features.size()]->tags(model) :
+					createTags(model, 1 + random.next64() % 64, random.next64() % 1000);
+				MutableFeaturePtr pFeature = feature->makeMutable(model);
+				pFeature.setTags(feature->handle(), tags);
+			}
+
+			try
+			{
+				compiler.compile();
+				(compiler.wasPatched() ? counts.patched : counts.rebuilt)++;
+			}
+			catch (const std::runtime_error& ex)
+			{
+				counts.mismatches++;
+				if (counts.mismatches <= 10) ConsoleWriter() << ex.what();
+			}
+		}
+		counts.millis = elapsedMillis(start);
+		totalMismatches += counts.mismatches;
+
+		snprintf(buf, sizeof(buf), "%4d %8zu %8llu %8llu %10llu %10.1f",
+			run + 1, tiles.size(),
+			static_cast<unsigned long long>(counts.patched),
+			static_cast<unsigned long long>(counts.rebuilt),
+			static_cast<unsigned long long>(counts.mismatches),
+			counts.millis);
+		ConsoleWriter() << buf;
+	}
+	return totalMismatches == 0;
+}
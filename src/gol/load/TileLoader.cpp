@@ -3,11 +3,16 @@
 
 #include "TileLoader.h"
 #include "TileDownloadClient.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
 #include <clarisma/cli/Console.h>
 #include <clarisma/cli/ConsoleWriter.h>
 #include <clarisma/util/FileSize.h>
+#include <clarisma/text/Format.h>
 #include <clarisma/util/FileVersion.h>
 #include <clarisma/zip/Zip.h>
+#include <geodesk/feature/TileIndexEntry.h>
 #include <geodesk/query/TileIndexWalker.h>
 #include "tile/compiler/IndexSettings.h"
 #include "tile/model/Layout.h"
@@ -22,7 +27,8 @@
 
 TileLoader::TileLoader(FeatureStore* store, int numberOfThreads) :
 	TaskEngine(numberOfThreads),
-	transaction_(*store)
+	transaction_(*store),
+	tail_(numberOfThreads)
 {
 }
 
@@ -49,28 +55,49 @@ void TileLoader::load(const char *golFileName,
 	{
 		initStore(header, file_.readBlock(header.metadataChunkSize));
 	}
+	else if (isDelta())
+	{
+		readDeletedTiles(header, file_.readBlock(header.metadataChunkSize));
+	}
 	if (!beginTiles()) return;
 
-	start();
+	// Gather the entries of the tiles we need to load, along with
+	// their offsets in the GOB
+	std::vector<std::pair<uint64_t,const TesArchiveEntry*>> entries;
 	uint64_t ofs = catalogSize_ + gobHeader().metadataChunkSize;
-
 	auto p = reinterpret_cast<const TesArchiveEntry*>(
 		catalog_.get() + sizeof(TesArchiveHeader));
 	auto pEnd = p + header.tileCount;
-
 	while (p < pEnd)
 	{
-		Tile tile = tiles_[p->tip];
-		if (!tile.isNull())
-		{
-			// TODO: I/O ops can throw, need to catch and handle!
-			file_.seek(ofs);
-			postWork({ p->tip, tile, file_.readBlock(p->size) });
-		}
+		if (!tiles_[p->tip].isNull()) entries.emplace_back(ofs, p);
 		ofs += p->size;
 		++p;
 	}
+	if (largestFirst_)
+	{
+		// Trades sequential reads for better load balance at the end;
+		// the compressed size is a good proxy for the work per tile
+		std::stable_sort(entries.begin(), entries.end(),
+			[](const auto& a, const auto& b)
+			{
+				return a.second->size > b.second->size;
+			});
+	}
+
+	start();
+	tail_.begin();
+	for (const auto& [entryOfs, entry] : entries)
+	{
+		// Each worker reads its tiles itself, so at most one read
+		// per worker is in flight
+		postWork({ entry->tip, tiles_[entry->tip], entryOfs, entry->size });
+	}
 	end();
+	tail_.end();
+	tail_.report("Load");
+	reportWorkers();
+	if (isDelta()) updateRevision();
 	transaction_.commit();
 	transaction_.end();
 
@@ -80,13 +107,38 @@ void TileLoader::load(const char *golFileName,
 bool TileLoader::openStore()
 {
 	FeatureStore& store = transaction_.store();
-	store.open(golFileName_,
-		FeatureStore::OpenMode::WRITE |
-		FeatureStore::OpenMode::CREATE |
-		FeatureStore::OpenMode::TRY_EXCLUSIVE);
-	// TODO: modes
-
 	const TesArchiveHeader header = gobHeader();
+	if (hasCompiledTiles())
+	{
+		// Way bodies are taken as they are, so we can neither
+		// drop their waynode IDs nor add any
+		wayNodeIds_ = (header.flags & TesArchiveHeader::Flags::WAYNODE_IDS) != 0;
+	}
+	if (isDelta())
+	{
+		// A delta only makes sense on top of its base
+		if (isRemoteGob_)
+		{
+			throw std::runtime_error("Deltas can only be loaded from a local file");
+		}
+		// Applying only part of a delta would leave the other tiles
+		// at the base revision, while the library claims the new one
+		if (filter_ || bounds_.area() < Box::ofWorld().area())
+		{
+			throw std::runtime_error("Deltas cannot be applied to an area; omit -a and -b");
+		}
+		store.open(golFileName_,
+			FeatureStore::OpenMode::WRITE |
+			FeatureStore::OpenMode::TRY_EXCLUSIVE);
+	}
+	else
+	{
+		store.open(golFileName_,
+			FeatureStore::OpenMode::WRITE |
+			FeatureStore::OpenMode::CREATE |
+			FeatureStore::OpenMode::TRY_EXCLUSIVE);
+	}
+	// TODO: modes
 
 	// We always start the tx, even if no tiles will
 	// ultimately be loaded, because this simplifies the workflow
@@ -107,6 +159,13 @@ bool TileLoader::openStore()
 	{
 		throw std::runtime_error("Incompatible tileset");
 	}
+	if (isDelta() && store.revision() != header.baseRevision)
+	{
+		char buf[128];
+		Format::unsafe(buf, "Delta applies to revision %u, but library is at revision %u",
+			header.baseRevision, static_cast<uint32_t>(store.revision()));
+		throw std::runtime_error(buf);
+	}
 	if (wayNodeIds_)  [[unlikely]]
 	{
 		if (!store.hasWaynodeIds())
@@ -147,6 +206,7 @@ void TileLoader::download(
 
 	Console::get()->start("Contacting host...");
 	start();
+	tail_.begin();
 	std::string_view svUrl = url;
 	TileDownloadClient mainClient(*this, svUrl);
 	mainClient.download();
@@ -154,6 +214,9 @@ void TileLoader::download(
 	mainClient.downloadRanges();
 	awaitDownloadThreads();
 	end();
+	tail_.end();
+	tail_.report("Load");
+	reportWorkers();
 	transaction_.commit();
 	transaction_.end();
 
@@ -168,8 +231,19 @@ void TileLoader::download(
 bool TileLoader::beginTiles()
 {
 	int tileCount = determineTiles();
+	if (isDelta()) deletedTileCount_ = removeDeletedTiles();
 	if (tileCount == 0)
 	{
+		if (isDelta())
+		{
+			updateRevision();
+			transaction_.commit();
+			transaction_.end();
+			char buf[64];
+			Format::unsafe(buf, "%d tiles removed.\n", deletedTileCount_);
+			Console::end().success().writeString(buf);
+			return false;
+		}
 		Console::end().success() << "All tiles already loaded.\n";
 		return false;
 	}
@@ -180,15 +254,18 @@ bool TileLoader::beginTiles()
 		transactionStarted_ = true;
 	}
 
+	copyCompiledTiles_ = hasCompiledTiles() && canCopyCompiledTiles();
 	workPerTile_ = 100.0 / tileCount;
 	workCompleted_ = 0;
 
 	ConsoleWriter out;
-	out.blank() << (isRemoteGob_ ? "Downloading " : "Loading ")
+	out.blank() << (isRemoteGob_ ? "Downloading " : (isDelta() ? "Applying " : "Loading "))
 		<< Console::FAINT_LIGHT_BLUE << FormattedLong(tileCount)
 		<< Console::DEFAULT << (isRemoteGob_ ?
 			(tileCount == 1 ? " tile (" : " tiles (") :
-			(tileCount == 1 ? " tile into " : " tiles into "));
+			(isDelta() ?
+				(tileCount == 1 ? " changed tile to " : " changed tiles to ") :
+				(tileCount == 1 ? " tile into " : " tiles into ")));
 	if (isRemoteGob_)
 	{
 		Console::get()->setTask("Downloading...");
@@ -204,6 +281,30 @@ bool TileLoader::beginTiles()
 	return true;
 }
 
+bool TileLoader::canCopyCompiledTiles() const
+{
+	uint32_t version = gobHeader().compilerVersion;
+	if (version == TesArchiveHeader::currentCompilerVersion()) return true;
+	if (Console::verbosity() >= Console::Verbosity::VERBOSE)
+	{
+		char buf[128];
+		Format::unsafe(buf, "Tiles were compiled by gol %u.%u.%u, "
+			"so they need to be rebuilt",
+			version >> 16, (version >> 8) & 0xff, version & 0xff);
+		ConsoleWriter().timestamp() << buf;
+	}
+	return false;
+}
+
+bool TileLoader::isCompiledTileValid(const ByteBlock& block)
+{
+	// The blob has a checksum of its own, which covers its size
+	uint8_t* data = const_cast<uint8_t*>(block.data());
+	return block.size() >= 8 &&
+		(DataPtr(data).getUnsignedInt() & 0x3fff'ffff) + 4 == block.size() &&
+		FeatureStore::isTileValid(reinterpret_cast<std::byte*>(data));
+}
+
 void TileLoader::reportSuccess(int tileCount)
 {
 	char buf[64];
@@ -211,9 +312,18 @@ void TileLoader::reportSuccess(int tileCount)
 	Console::end().success().writeString(buf);
 }
 
+ByteBlock TileLoader::uncompressMetadata(const TesArchiveHeader& header,
+	ByteBlock&& compressedMetadata)
+{
+	return header.codec == TesArchiveHeader::ZSTD ?
+		ZstdDecompressor().uncompressSealedChunk(
+			compressedMetadata.data(), compressedMetadata.size()) :
+		Zip::uncompressSealedChunk(compressedMetadata);
+}
+
 void TileLoader::initStore(const TesArchiveHeader& header, ByteBlock&& compressedMetadata)
 {
-	ByteBlock metadata = Zip::uncompressSealedChunk(compressedMetadata);
+	ByteBlock metadata = uncompressMetadata(header, std::move(compressedMetadata));
 	const uint8_t* p = metadata.data();
 	const uint8_t* end = p + metadata.size();
 
@@ -264,7 +374,7 @@ void TileLoader::initStore(const TesArchiveHeader& header, ByteBlock&& compresse
 		p += sectionSize;
 	}
 
-	if(sectionsPresent != 0x3E)   // TODO: use proper mask
+	if(sectionsPresent != TES_METADATA_SECTIONS)
 	{
 		throw std::runtime_error("Invalid metadata (missing sections)");
 	}
@@ -273,12 +383,76 @@ void TileLoader::initStore(const TesArchiveHeader& header, ByteBlock&& compresse
 }
 
 
+void TileLoader::readDeletedTiles(const TesArchiveHeader& header,
+	ByteBlock&& compressedMetadata)
+{
+	ByteBlock metadata = uncompressMetadata(header, std::move(compressedMetadata));
+	const uint8_t* p = metadata.data();
+	const uint8_t* end = p + metadata.size();
+	while (p < end)
+	{
+		TesMetadataType section = static_cast<TesMetadataType>(*p++);
+		uint32_t sectionSize = readVarint32(p);
+		if (sectionSize > static_cast<size_t>(end - p))
+		{
+			throw std::runtime_error("Invalid metadata");
+		}
+		if (section == TesMetadataType::DELETED_TILES)
+		{
+			deletedTips_.resize(sectionSize / sizeof(uint32_t));
+			memcpy(deletedTips_.data(), p, deletedTips_.size() * sizeof(uint32_t));
+		}
+		p += sectionSize;
+	}
+}
+
+
+// Removes the deleted tiles that lie within the area being loaded:
+// their pages are returned to the store, and their entries are
+// cleared in the transaction's own copy of the tile index, which
+// commit() journals and writes along with the entries of the tiles
+// we put (Transaction has no call for removing a tile, hence the cast)
+int TileLoader::removeDeletedTiles()
+{
+	uint32_t tipCount = transaction_.header().tipCount;
+	uint32_t* tileIndex = const_cast<uint32_t*>(transaction_.tileIndex());
+	int count = 0;
+	for (uint32_t tip : deletedTips_)
+	{
+		if (tip == 0 || tip > tipCount)
+		{
+			throw std::runtime_error("Invalid metadata");
+		}
+		TileIndexEntry entry(tileIndex[tip]);
+		if (tiles_[tip].isNull() || !entry.isLoadedAndCurrent()) continue;
+		transaction_.free(entry.page());
+		tileIndex[tip] = 0;
+		count++;
+	}
+	return count;
+}
+
+
+void TileLoader::updateRevision()
+{
+	FeatureStore::Header& header = transaction_.header();
+	header.revision = gobHeader().revision;
+	header.revisionTimestamp = gobHeader().revisionTimestamp;
+	if (Console::verbosity() >= Console::Verbosity::VERBOSE)
+	{
+		ConsoleWriter().timestamp() << "Updated library from revision "
+			<< gobHeader().baseRevision << " to " << gobHeader().revision
+			<< " (" << deletedTileCount_ << " tiles removed)";
+	}
+}
+
+
 void TileLoader::prepareCatalog(const TesArchiveHeader& header)
 {
 	verifyHeader(header);
 	catalogSize_ = static_cast<uint32_t>(sizeof(TesArchiveHeader) +
 		sizeof(TesArchiveEntry) * header.tileCount +
-		sizeof(uint32_t));
+		header.dictionarySize + sizeof(uint32_t));
 	catalog_.reset(new std::byte[catalogSize_]);
 	memcpy(catalog_.get(), &header, sizeof(header));
 }
@@ -291,12 +465,34 @@ void TileLoader::verifyHeader(const TesArchiveHeader& header)
 	}
 
 	FileVersion version (header.formatVersionMajor, header.formatVersionMinor);
-	version.checkExact("GOB", FileVersion(2,0));
+	if (header.formatVersionMajor != 2 || header.formatVersionMinor > 1)
+	{
+		version.checkExact("GOB", FileVersion(2,1));
+	}
 
-	if (header.tileCount > 8000000)	// TODO: make constant
+	if (header.tileCount > 8000000 ||	// TODO: make constant
+		header.dictionarySize > 16 * 1024 * 1024)
+	{
+		throw std::runtime_error("Invalid GOB header");
+	}
+	if ((header.flags & ~TesArchiveHeader::Flags::WAYNODE_IDS) &&
+		header.formatVersionMinor < 1)
 	{
 		throw std::runtime_error("Invalid GOB header");
 	}
+	if (header.flags & ~(TesArchiveHeader::Flags::WAYNODE_IDS |
+		TesArchiveHeader::Flags::COLUMNAR_TES |
+		TesArchiveHeader::Flags::DELTA |
+		TesArchiveHeader::Flags::COMPILED_TILES))
+	{
+		throw std::runtime_error("GOB uses features not supported by this version of gol");
+	}
+	if (header.codec > TesArchiveHeader::ZSTD ||
+		(header.codec != TesArchiveHeader::DEFLATE && header.formatVersionMinor < 1) ||
+		(header.codec != TesArchiveHeader::ZSTD && header.dictionarySize != 0))
+	{
+		throw std::runtime_error("Unsupported GOB compression");
+	}
 }
 
 
@@ -335,7 +531,8 @@ int TileLoader::determineTiles()
 	do
 	{
 		Tip tip = tiw.currentTip();
-		if((tileIndex + tip * 4).getInt() == 0)
+		// A delta replaces tiles, so we take every tile in the area
+		if(isDelta() || (tileIndex + tip * 4).getInt() == 0)
 		{
 			tiles_[tip] = tiw.currentTile();
 			tileCount++;
@@ -369,6 +566,57 @@ int TileLoader::determineTiles()
 
 
 void TileLoaderWorker::processTask(TileLoaderTask& task)
+{
+	auto startTime = std::chrono::steady_clock::now();
+	try
+	{
+		ByteBlock block = uncompress(read(task));
+		if (loader_->copyCompiledTiles_)
+		{
+			loader_->postOutput(copyTile(task.tip(), std::move(block)));
+		}
+		else
+		{
+			loader_->postOutput(buildTile(task, block));
+		}
+	}
+	catch (std::exception& ex)
+	{
+		// An exception must not escape the worker thread, as it
+		// would terminate the process without a message
+		CliApplication::abort(ex.what());
+		return;
+	}
+	tileCount_++;
+	busySeconds_ += std::chrono::duration<double>(
+		std::chrono::steady_clock::now() - startTime).count();
+	loader_->tail_.taskCompleted();
+}
+
+
+// Checks a compiled tile and hands it over as-is; a corrupt tile
+// aborts the load (via processTask), naming the tile's TIP
+TileData TileLoaderWorker::copyTile(Tip tip, ByteBlock&& block)
+{
+	auto startTime = std::chrono::steady_clock::now();
+	if (!TileLoader::isCompiledTileValid(block))
+	{
+		char buf[64];
+		Format::unsafe(buf, "Invalid compiled tile (TIP %06X)",
+			static_cast<uint32_t>(tip));
+		throw std::runtime_error(buf);
+	}
+	decodeSeconds_ += std::chrono::duration<double>(
+		std::chrono::steady_clock::now() - startTime).count();
+	uint32_t size = static_cast<uint32_t>(block.size());
+		// Get size here, because take() sets it to 0
+	return { tip, block.take(), size };
+}
+
+
+// Reads the tile (TES, or a compiled tile from another version
+// of gol) into a TileModel and builds its blob
+TileData TileLoaderWorker::buildTile(const TileLoaderTask& task, const ByteBlock& block)
 {
 	FeatureStore& store = loader_->transaction_.store();
 	// TilePtr pTile = TilePtr(BlobPtr(store->fetchTile(task.tip())));
@@ -376,17 +624,29 @@ void TileLoaderWorker::processTask(TileLoaderTask& task)
 	// uint32_t size = pTile.getInt() & 0x3fff'ffff;
 	// uint8_t* pLoadedTile = new uint8_t[size];
 
-	TileModel tile;
+	TileModel& tile = tile_;
 	tile.wayNodeIds(loader_->wayNodeIds_);
 	// store->prefetchBlob(pTile);
 	// TileReader reader(tile);
 	// reader.readTile(task.tile(), pTile);
 
-	ByteBlock block = Zip::uncompressSealedChunk(task.data(), task.size());
-	tile.init(task.tile(), block.size() * 2);	// TODO: just tileSize?
-
-	TesReader tesReader(tile);
-	tesReader.read(block.data(), block.size());
+	auto decodeStartTime = std::chrono::steady_clock::now();
+	if (loader_->hasCompiledTiles())
+	{
+		// The model refers to the blob, which must therefore
+		// outlive it (it does, as it belongs to the caller)
+		TileReader reader(tile);
+		reader.readTile(task.tile(), TilePtr(DataPtr(block.data())));
+	}
+	else
+	{
+		tile.init(task.tile(), static_cast<size_t>(block.size() * tileSizeRatio_));
+		TesReader tesReader(tile);
+		tesReader.read(block.data(), block.size(),
+			loader_->gobHeader().flags & TesArchiveHeader::Flags::COLUMNAR_TES);
+	}
+	decodeSeconds_ += std::chrono::duration<double>(
+		std::chrono::steady_clock::now() - decodeStartTime).count();
 
 	/*
 	TesParcelPtr parcel = task.takeFirstParcel();
@@ -407,7 +667,7 @@ void TileLoaderWorker::processTask(TileLoaderTask& task)
 		loader_->transaction_.header().settings;
 	IndexSettings indexSettings(store.keysToCategories(),
 		settings.rtreeBranchSize, settings.maxKeyIndexes,
-		settings.keyIndexMinFeatures);
+		settings.keyIndexMinFeatures, IndexSettings::rtreePackingOf(settings));
 	THeader indexer(indexSettings);
 	indexer.addFeatures(tile);
 	indexer.setExportTable(tile.exportTable());
@@ -425,15 +685,158 @@ void TileLoaderWorker::processTask(TileLoaderTask& task)
 #endif
 
 	uint8_t* newTileData = tile.write(layout);
+	size_t tileSize = static_cast<size_t>(layout.size() + 4);
+	if (block.size() > 0)
+	{
+		// Neighboring tiles tend to have a similar mix of features,
+		// so the last tile is a good predictor for the next
+		tileSizeRatio_ = std::clamp(
+			static_cast<double>(tileSize) / block.size(), 1.0, 4.0);
+	}
+	tile.clear();
 
-	loader_->postOutput(TileData(task.tip(),
-		std::move(std::unique_ptr<uint8_t[]>(newTileData)),
-		static_cast<size_t>(layout.size() + 4)));
+	return TileData(task.tip(),
+		std::unique_ptr<uint8_t[]>(newTileData), tileSize);
+}
+
+
+// Reads the tile's chunk from the GOB into a buffer that is reused
+// for every tile. Positional reads don't share a file pointer, so all
+// workers can read at once, which fast SSDs and network file systems
+// need in order to reach their full throughput
+std::span<const uint8_t> TileLoaderWorker::read(const TileLoaderTask& task)
+{
+	uint32_t size = task.chunkSize();
+	if (size == 0) return { task.data(), task.size() };
+		// already downloaded
+
+	auto startTime = std::chrono::steady_clock::now();
+	if (size > readBufferSize_)
+	{
+		readBufferSize_ = std::max(size, readBufferSize_ * 2);
+		readBuffer_.reset(new uint8_t[readBufferSize_]);
+	}
+	uint64_t ofs = task.ofs();
+	uint8_t* p = readBuffer_.get();
+	uint32_t remaining = size;
+	while (remaining)
+	{
+		size_t bytesRead;
+		bool readOk = loader_->file_.tryReadAt(ofs,
+			reinterpret_cast<std::byte*>(p), remaining, bytesRead);
+		if (bytesRead == 0) [[unlikely]]
+		{
+			if (!readOk) throw IOException();
+			throw IOException("Unexpected end of GOB");
+		}
+		ofs += bytesRead;
+		p += bytesRead;
+		remaining -= static_cast<uint32_t>(bytesRead);
+	}
+	bytesRead_ += size;
+	readSeconds_ += std::chrono::duration<double>(
+		std::chrono::steady_clock::now() - startTime).count();
+	return { readBuffer_.get(), size };
+}
+
+
+ByteBlock TileLoaderWorker::uncompress(std::span<const uint8_t> chunk)
+{
+	auto startTime = std::chrono::steady_clock::now();
+	ByteBlock block;
+	if (loader_->gobHeader().codec == TesArchiveHeader::ZSTD)
+	{
+		if (!zstd_)
+		{
+			zstd_ = std::make_unique<ZstdDecompressor>();
+			std::span<const uint8_t> dictionary = loader_->dictionary();
+			if (!dictionary.empty())
+			{
+				zstd_->setDictionary(dictionary.data(), dictionary.size());
+			}
+		}
+		block = zstd_->uncompressSealedChunk(chunk.data(), chunk.size());
+	}
+	else
+	{
+		block = Zip::uncompressSealedChunk(chunk.data(), chunk.size());
+	}
+	bytesUncompressed_ += block.size();
+	uncompressSeconds_ += std::chrono::duration<double>(
+		std::chrono::steady_clock::now() - startTime).count();
+	return block;
+}
+
+
+void TileLoaderWorker::harvestResults()
+{
+	loader_->workerCount_++;
+	loader_->workerTileCount_ += tileCount_;
+	loader_->workerBytesRead_ += bytesRead_;
+	loader_->workerBytesUncompressed_ += bytesUncompressed_;
+	loader_->workerBusySeconds_ += busySeconds_;
+	loader_->workerReadSeconds_ += readSeconds_;
+	loader_->workerUncompressSeconds_ += uncompressSeconds_;
+	loader_->workerDecodeSeconds_ += decodeSeconds_;
+}
+
+
+void TileLoader::reportWorkers() const
+{
+	if (Console::verbosity() < Console::Verbosity::VERBOSE) return;
+	if (workerTileCount_ == 0) return;
+	const char* codec = gobHeader().codec == TesArchiveHeader::ZSTD ? "zstd" : "deflate";
+	char buf[200];
+	if (copyCompiledTiles_)
+	{
+		snprintf(buf, sizeof(buf),
+			"Copied %u compiled tiles using %d workers, %.3f ms per tile "
+			"(%.3f ms uncompressing %s, %.3f ms verifying)",
+			workerTileCount_, workerCount_,
+			workerBusySeconds_ * 1000 / workerTileCount_,
+			workerUncompressSeconds_ * 1000 / workerTileCount_, codec,
+			workerDecodeSeconds_ * 1000 / workerTileCount_);
+		ConsoleWriter().timestamp() << buf;
+	}
+	else
+	{
+		snprintf(buf, sizeof(buf),
+			"Built %u tiles using %d tile models, %.3f ms per tile "
+			"(%.3f ms uncompressing %s, %.3f ms decoding %s)",
+			workerTileCount_, workerCount_,
+			workerBusySeconds_ * 1000 / workerTileCount_,
+			workerUncompressSeconds_ * 1000 / workerTileCount_, codec,
+			workerDecodeSeconds_ * 1000 / workerTileCount_,
+			hasCompiledTiles() ? "compiled tiles" :
+				((gobHeader().flags & TesArchiveHeader::Flags::COLUMNAR_TES) ?
+					"columnar TES" : "v2 TES"));
+		ConsoleWriter().timestamp() << buf;
+	}
+
+	// Reading, inflating and compiling are spread across the workers
+	// (so their times are summed); writing is up to the output thread
+	reportStage("Read", workerBytesRead_, workerReadSeconds_);
+	reportStage("Inflate", workerBytesUncompressed_, workerUncompressSeconds_);
+	reportStage(copyCompiledTiles_ ? "Verify" : "Compile", totalBytesWritten_,
+		workerBusySeconds_ - workerReadSeconds_ - workerUncompressSeconds_);
+	reportStage("Write", totalBytesWritten_, writeSeconds_);
+}
+
+
+void TileLoader::reportStage(const char* stage, uint64_t bytes, double seconds)
+{
+	if (bytes == 0) return;		// nothing read if downloaded
+	char buf[128];
+	snprintf(buf, sizeof(buf), "%-8s %10.1f MB, %8.1f MB/s per thread",
+		stage, bytes / (1024.0 * 1024),
+		bytes / (1024.0 * 1024) / std::max(seconds, 1e-9));
+	ConsoleWriter().timestamp() << buf;
 }
 
 
 void TileLoader::processTask(TileData& task)
 {
+	auto startTime = std::chrono::steady_clock::now();
 	try
 	{
 		transaction_.putTile(task.tip(), {task.data(), task.size()});
@@ -442,6 +845,8 @@ void TileLoader::processTask(TileData& task)
 	{
 		CliApplication::abort(ex.what());
 	}
+	writeSeconds_ += std::chrono::duration<double>(
+		std::chrono::steady_clock::now() - startTime).count();
 	workCompleted_ += workPerTile_;
 	Console::get()->setProgress(static_cast<int>(workCompleted_));
 	totalBytesWritten_ += task.size();
@@ -468,6 +873,7 @@ void TileLoader::determineRanges(TileDownloadClient& mainClient, bool loadedMeta
     const TesArchiveEntry* pEnd = p + header_.tileCount;
     uint64_t rangeStartOfs = ofs;
     uint64_t rangeLen = 0;
+    uint64_t mainRangeLen = 0;
 
     while (p < pEnd)
     {
@@ -482,6 +888,7 @@ void TileLoader::determineRanges(TileDownloadClient& mainClient, bool loadedMeta
                 if (pRangeStart == pStart)
                 {
                     mainClient.setRange(pRangeStart, pRangeEnd);
+                    mainRangeLen = rangeLen;
                 }
                 else
                 {
@@ -508,6 +915,7 @@ void TileLoader::determineRanges(TileDownloadClient& mainClient, bool loadedMeta
     if (pRangeStart == pStart)
     {
         mainClient.setRange(pRangeStart, pRangeEnd);
+        mainRangeLen = rangeLen;
     }
     else
     {
@@ -515,6 +923,23 @@ void TileLoader::determineRanges(TileDownloadClient& mainClient, bool loadedMeta
             pRangeStart - pStart,
             pRangeEnd - pRangeStart);
     }
+
+    if (Console::verbosity() >= Console::Verbosity::VERBOSE)
+    {
+        // The fewer ranges, the fewer round trips; the bytes of
+        // skipped tiles within a range are the price for that
+        uint64_t fetchedBytes = mainRangeLen;
+        for (const Range& r : ranges_) fetchedBytes += r.size;
+        size_t rangeCount = ranges_.size() + (mainRangeLen ? 1 : 0);
+        char buf[200];
+        snprintf(buf, sizeof(buf), "Tiles span %llu range(s) with %llu bytes, "
+            "%llu of them for requested tiles (%.1f%%)",
+            static_cast<unsigned long long>(rangeCount),
+            static_cast<unsigned long long>(fetchedBytes),
+            static_cast<unsigned long long>(requestedTileBytesCompressed_),
+            requestedTileBytesCompressed_ * 100.0 / std::max(fetchedBytes, uint64_t{1}));
+        ConsoleWriter().timestamp() << buf;
+    }
 }
 
 
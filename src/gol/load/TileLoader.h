@@ -3,15 +3,18 @@
 
 #pragma once
 
+#include <span>
 #include <clarisma/alloc/Block.h>
 #include <clarisma/io/File.h>
 #include <clarisma/thread/TaskEngine.h>
+#include <clarisma/zip/Zstd.h>
 #include <geodesk/feature/FeatureStore_Transaction.h>
 #include <geodesk/feature/Tip.h>
 #include <geodesk/geom/Tile.h>
 #include "tile/model/TileModel.h"
 #include "tile/tes/TesArchive.h"
 #include "tile/tes/TesParcel.h"
+#include "tile/util/TailLatencyTracker.h"
 #include "tile/util/TileData.h"
 
 namespace geodesk {
@@ -32,15 +35,28 @@ public:
 		data_(std::move(data))
 	{
 	}
+	/// A tile that the worker reads from the GOB itself
+	///
+	TileLoaderTask(Tip tip, Tile tile, uint64_t ofs, uint32_t chunkSize) :
+		tip_(tip),
+		tile_(tile),
+		chunkSize_(chunkSize),
+		ofs_(ofs)
+	{
+	}
 
 	Tile tile() const { return tile_; }
 	Tip tip() const { return tip_; }
 	const uint8_t* data() const { return data_.data(); }
 	size_t size() const { return data_.size(); }
+	uint64_t ofs() const { return ofs_; }
+	uint32_t chunkSize() const { return chunkSize_; }
 
 private:
 	Tip tip_;
 	Tile tile_;
+	uint32_t chunkSize_ = 0;	// only if the data must be read
+	uint64_t ofs_ = 0;
 	ByteBlock data_;
 };
 
@@ -51,10 +67,31 @@ public:
 	explicit TileLoaderWorker(TileLoader* loader) : loader_(loader) {}
 	void processTask(TileLoaderTask& task);
 	void afterTasks() {}
-	void harvestResults() {}
+	void harvestResults();
 
 private:
+	std::span<const uint8_t> read(const TileLoaderTask& task);
+	ByteBlock uncompress(std::span<const uint8_t> chunk);
+	TileData buildTile(const TileLoaderTask& task, const ByteBlock& block);
+	TileData copyTile(Tip tip, ByteBlock&& block);
+
 	TileLoader* loader_;
+	TileModel tile_;			// reused for every tile
+	std::unique_ptr<ZstdDecompressor> zstd_;	// created on first use
+	std::unique_ptr<uint8_t[]> readBuffer_;		// reused for every tile
+	uint32_t readBufferSize_ = 0;
+
+	/// Size of the most recent tile relative to its TES encoding,
+	/// used to size the TileModel for the next tile
+	///
+	double tileSizeRatio_ = 2.0;
+	uint32_t tileCount_ = 0;
+	uint64_t bytesRead_ = 0;
+	uint64_t bytesUncompressed_ = 0;
+	double busySeconds_ = 0;
+	double readSeconds_ = 0;
+	double uncompressSeconds_ = 0;
+	double decodeSeconds_ = 0;
 };
 
 
@@ -70,6 +107,18 @@ public:
 		 int maxConnections);
 
 	void processTask(TileData& task);
+	void setLargestFirst(bool b) { largestFirst_ = b; }
+
+	/// Throws if the header is not that of a Bundle
+	/// in a format we understand
+	///
+	static void verifyHeader(const TesArchiveHeader& header);
+	static ByteBlock uncompressMetadata(const TesArchiveHeader& header,
+		ByteBlock&& compressedMetadata);
+	/// Checks the size and checksum of an uncompressed
+	/// compiled tile (see TesArchiveHeader::COMPILED_TILES)
+	///
+	static bool isCompiledTileValid(const ByteBlock& block);
 
 private:
 	struct Range
@@ -82,13 +131,37 @@ private:
 
 	int64_t totalBytesWritten() const { return totalBytesWritten_; }
 	void reportSuccess(int tileCount);
+	void reportWorkers() const;
+	static void reportStage(const char* stage, uint64_t bytes, double seconds);
 	void initStore(const TesArchiveHeader& header, ByteBlock&& compressedMetadata);
+	void readDeletedTiles(const TesArchiveHeader& header, ByteBlock&& compressedMetadata);
+	int removeDeletedTiles();
+	void updateRevision();
 
 	const TesArchiveHeader& gobHeader() const
 	{
 		return reinterpret_cast<const TesArchiveHeader&>(*catalog_);
 	};
-	static void verifyHeader(const TesArchiveHeader& header);
+
+	/// The zstd dictionary stored in the catalog (empty
+	/// unless the GOB uses TesArchiveHeader::ZSTD)
+	///
+	std::span<const uint8_t> dictionary() const
+	{
+		const TesArchiveHeader& header = gobHeader();
+		return { reinterpret_cast<const uint8_t*>(entry(header.tileCount)),
+			header.dictionarySize };
+	}
+
+	bool isDelta() const
+	{
+		return gobHeader().flags & TesArchiveHeader::Flags::DELTA;
+	}
+	bool hasCompiledTiles() const
+	{
+		return gobHeader().flags & TesArchiveHeader::Flags::COMPILED_TILES;
+	}
+	bool canCopyCompiledTiles() const;
 	void prepareCatalog(const TesArchiveHeader& header);
 	void verifyCatalog() const;
 	bool openStore();
@@ -122,10 +195,16 @@ private:
 	bool wayNodeIds_ = false;
 	bool transactionStarted_ = false;
 	bool isRemoteGob_ = false;
+	bool largestFirst_ = false;
+	/// If set, the GOB's compiled tiles are written as they are;
+	/// otherwise, they are rebuilt (see TesArchiveHeader::COMPILED_TILES)
+	bool copyCompiledTiles_ = false;
 	const char* golFileName_ = nullptr;
 	const char* gobFileName_ = nullptr;
 	Box bounds_;
 	const Filter* filter_ = nullptr;
+	std::vector<uint32_t> deletedTips_;		// only used for deltas
+	int deletedTileCount_ = 0;
 
 	const char* url_ = nullptr;
 
@@ -141,6 +220,18 @@ private:
 	// which incurs latency. This field specifies the threshold
 	uint32_t maxSkippedBytes_ = 1024 * 1024;   // 1 MB
 	int maxConnections_ = 4;
+	TailLatencyTracker tail_;
+
+	// Gathered from the workers when the tiles have been loaded
+	int workerCount_ = 0;
+	uint32_t workerTileCount_ = 0;
+	uint64_t workerBytesRead_ = 0;
+	uint64_t workerBytesUncompressed_ = 0;
+	double workerBusySeconds_ = 0;
+	double workerReadSeconds_ = 0;
+	double workerUncompressSeconds_ = 0;
+	double workerDecodeSeconds_ = 0;
+	double writeSeconds_ = 0;		// spent by the output thread
 
 	friend class TileDownloadClient;
 
@@ -2,13 +2,23 @@
 // SPDX-License-Identifier: AGPL-3.0-only
 
 #include "TileSaver.h"
+#include "TileLoader.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <clarisma/cli/CliApplication.h>
 #include <clarisma/cli/Console.h>
+#include <clarisma/cli/ConsoleWriter.h>
+#include <clarisma/text/Format.h>
+#include <clarisma/util/Buffer.h>
 #include <clarisma/util/Crc32C.h>
 #include <clarisma/zip/Zip.h>
+#include <geodesk/geom/index/hilbert.h>
 #include <geodesk/query/TileIndexWalker.h>
-#include "tile/model/TileModel.h"
 #include "tile/model/TileReader.h"
 #include "tile/tes/TesArchive.h"
+#include "tile/tes/TesWriter.h"
 
 // TODO: Never save stale tiles to a TES Archive!
 
@@ -24,16 +34,57 @@ TileSaver::TileSaver(FeatureStore* store, int threadCount) :
 
 void TileSaver::save(const char* fileName,
 	std::vector<std::pair<Tile,Tip>>& tiles,
-	bool wayNodeIds)
+	const TileSaverSettings& settings)
 {
 	entryCount_ = static_cast<int>(tiles.size());
 	workPerTile_ = 100.0 / entryCount_;
 	workCompleted_ = 0;
-	wayNodeIds_ = wayNodeIds;
+	wayNodeIds_ = settings.wayNodeIds;
+	codec_ = settings.codec;
+	columnarTes_ = settings.columnarTes;
+	compiledTiles_ = settings.compiledTiles;
+	verifyEncoding_ = settings.verifyEncoding;
+	uncompressedBytes_ = 0;
+	isDelta_ = !settings.since.empty();
+	if (isDelta_)
+	{
+		readBase(settings.since.c_str(), settings.missingTips);
+		// Checksums are only comparable if the TES is encoded the same way
+		wayNodeIds_ = (baseFlags_ & TesArchiveHeader::Flags::WAYNODE_IDS) != 0;
+		columnarTes_ = (baseFlags_ & TesArchiveHeader::Flags::COLUMNAR_TES) != 0;
+		compiledTiles_ = (baseFlags_ & TesArchiveHeader::Flags::COMPILED_TILES) != 0;
+		if (wayNodeIds_ && !store_->hasWaynodeIds())
+		{
+			throw std::runtime_error("Library does not contain waynode IDs");
+		}
+	}
+
+	if (compiledTiles_)
+	{
+		// Blobs contain waynode IDs if and only if the library does
+		wayNodeIds_ = store_->hasWaynodeIds();
+		columnarTes_ = false;
+	}
+
+	if (settings.hilbertOrder) sortByHilbertOrder(tiles);
+	initOrder(tiles);
 
 	Console::get()->start("Saving...");
+	if (codec_ == TesArchiveHeader::ZSTD)
+	{
+		dictionary_ = trainDictionary(tiles);
+	}
+	uint32_t flags =
+		(wayNodeIds_ ? TesArchiveHeader::Flags::WAYNODE_IDS : 0) |
+		(columnarTes_ ? TesArchiveHeader::Flags::COLUMNAR_TES : 0) |
+		(isDelta_ ? TesArchiveHeader::Flags::DELTA : 0) |
+		(compiledTiles_ ? TesArchiveHeader::Flags::COMPILED_TILES : 0);
 	writer_.open(fileName, store_->guid(), store_->revision(),
-		store_->revisionTimestamp(), entryCount_, wayNodeIds);
+		store_->revisionTimestamp(), entryCount_, flags,
+		codec_, { dictionary_.data(), dictionary_.size() });
+		// For a delta, entryCount_ is only an upper bound
+	if (isDelta_) writer_.setBaseRevision(baseRevision_);
+	writer_.setCompilerVersion(TesArchiveHeader::currentCompilerVersion());
 	start();
 
 	for(const auto& tile : tiles)
@@ -41,23 +92,256 @@ void TileSaver::save(const char* fileName,
 		postWork(TileSaverTask(tile.first, tile.second));
 	}
 	end();
+	assert(nextRank_ == reorderBuffer_.size());
+		// all tiles must have been written
 	writer_.close();
+	reportCompression();
+}
+
+void TileSaver::sortByHilbertOrder(std::vector<std::pair<Tile,Tip>>& tiles)
+{
+	std::vector<std::pair<uint64_t,uint32_t>> keys;
+	keys.reserve(tiles.size());
+	for (uint32_t i = 0; i < tiles.size(); i++)
+	{
+		const auto& [tile, tip] = tiles[i];
+		uint64_t key = hilbert::calculateHilbertDistance(
+			tile.bounds().center(), Box::ofWorld());
+		// TIP breaks ties between tiles with the same center
+		keys.emplace_back((key << 32) | tip, i);
+	}
+	std::ranges::sort(keys);
+
+	std::vector<std::pair<Tile,Tip>> sorted;
+	sorted.reserve(tiles.size());
+	for (const auto& [key, i] : keys) sorted.push_back(tiles[i]);
+	tiles = std::move(sorted);
+}
+
+void TileSaver::initOrder(const std::vector<std::pair<Tile,Tip>>& tiles)
+{
+	ranks_.assign(store_->tipCount() + 1, 0);
+	for (uint32_t i = 0; i < tiles.size(); i++)
+	{
+		ranks_[tiles[i].second] = i;
+	}
+	reorderBuffer_.clear();
+	reorderBuffer_.resize(tiles.size());
+	arrived_.assign(tiles.size(), false);
+	nextRank_ = 0;
+}
+
+// Encodes the tile straight from its blob (unless we save compiled
+// tiles, which are simply copied), which is several times
+// faster than reading it into a TileModel and writing that
+// (see `gol bench tes-encoder`)
+ByteBlock TileSaver::encodeTile(BlobTesWriter& encoder, Tile tileBounds, Tip tip) const
+{
+	DataPtr pTile = store_->fetchTile(tip);
+	if (compiledTiles_)
+	{
+		// The blob is saved as-is, including its checksum
+		uint32_t size = TilePtr(pTile).totalSize();
+		std::unique_ptr<uint8_t[]> data(new uint8_t[size]);
+		memcpy(data.get(), pTile.ptr(), size);
+		return ByteBlock(std::move(data), size);
+	}
+	encoder.wayNodeIds(wayNodeIds_);
+	encoder.columnar(columnarTes_);
+	return encoder.write(tileBounds, TilePtr(pTile));
+}
+
+ByteBlock TileSaver::trainDictionary(const std::vector<std::pair<Tile,Tip>>& tiles) const
+{
+	// Neighboring tiles are similar, so we spread the sample
+	// evenly across the whole set
+	size_t step = std::max(tiles.size() / MAX_SAMPLE_TILES, size_t{1});
+	std::vector<ByteBlock> samples;
+	size_t sampleBytes = 0;
+	BlobTesWriter encoder;
+	for (size_t i = 0; i < tiles.size() && sampleBytes < MAX_SAMPLE_BYTES; i += step)
+	{
+		samples.push_back(encodeTile(encoder, tiles[i].first, tiles[i].second));
+		sampleBytes += samples.back().size();
+	}
+	ByteBlock dictionary = Zstd::trainDictionary(samples, DICTIONARY_SIZE);
+	if (Console::verbosity() >= Console::Verbosity::VERBOSE)
+	{
+		ConsoleWriter().timestamp() << "Trained " << dictionary.size()
+			<< "-byte dictionary on " << samples.size() << " tiles ("
+			<< sampleBytes << " bytes)";
+	}
+	return dictionary;
+}
+
+void TileSaver::readBase(const char* fileName, const std::vector<Tip>& missingTips)
+{
+	File file;
+	file.open(fileName, File::OpenMode::READ);
+	TesArchiveHeader header;
+	file.readAll(&header, sizeof(header));
+	TileLoader::verifyHeader(header);
+	if (header.flags & TesArchiveHeader::Flags::DELTA)
+	{
+		throw std::runtime_error(std::string(fileName) +
+			" is a delta, not a complete Bundle");
+	}
+	if (header.guid != store_->guid())
+	{
+		throw std::runtime_error("Incompatible tileset");
+	}
+	if (header.revision > store_->revision())
+	{
+		throw std::runtime_error("Bundle is newer than the library");
+	}
+
+	size_t catalogSize = sizeof(TesArchiveHeader) +
+		sizeof(TesArchiveEntry) * header.tileCount +
+		header.dictionarySize + sizeof(uint32_t);
+	std::unique_ptr<uint8_t[]> catalog(new uint8_t[catalogSize]);
+	memcpy(catalog.get(), &header, sizeof(header));
+	file.readAll(catalog.get() + sizeof(header), catalogSize - sizeof(header));
+	size_t checksumOfs = catalogSize - sizeof(uint32_t);
+	if (Crc32C::compute(catalog.get(), checksumOfs) !=
+		*reinterpret_cast<uint32_t*>(catalog.get() + checksumOfs))
+	{
+		throw std::runtime_error("Invalid GOB catalog checksum");
+	}
+
+	// Each tile's chunk starts with the size and checksum of its
+	// uncompressed contents, which is all we need to spot changes
+	uint32_t tipCount = store_->tipCount();
+	baseStamps_.assign(tipCount + 1, 0);
+	auto p = reinterpret_cast<const TesArchiveEntry*>(
+		catalog.get() + sizeof(TesArchiveHeader));
+	auto pEnd = p + header.tileCount;
+	uint64_t ofs = catalogSize + header.metadataChunkSize;
+	for (; p < pEnd; ++p)
+	{
+		if (p->tip > tipCount || p->size < 8)
+		{
+			throw std::runtime_error("Invalid GOB catalog");
+		}
+		uint32_t stamp[2];
+		file.seek(ofs);
+		file.readAll(stamp, sizeof(stamp));
+		baseStamps_[p->tip] = (static_cast<uint64_t>(stamp[0]) << 32) | stamp[1];
+		ofs += p->size;
+	}
+
+	deletedTips_.clear();
+	for (Tip tip : missingTips)
+	{
+		if (baseStamps_[tip]) deletedTips_.push_back(tip);
+	}
+	baseRevision_ = header.revision;
+	baseFlags_ = header.flags;
+	unchangedTileCount_ = 0;
+
+	// Another version of gol may encode the same tile differently
+	// (e.g. order its tag tables or strings another way), in which
+	// case every tile looks changed; we still save a valid delta,
+	// but it holds all tiles
+	baseStampsComparable_ = header.compilerVersion ==
+		TesArchiveHeader::currentCompilerVersion();
+
+	if (Console::verbosity() >= Console::Verbosity::VERBOSE)
+	{
+		ConsoleWriter().timestamp() << "Read checksums of " << header.tileCount
+			<< " tiles in " << fileName << " (revision " << header.revision << ")";
+		if (!baseStampsComparable_)
+		{
+			uint32_t version = header.compilerVersion;
+			char buf[128];
+			Format::unsafe(buf, "Bundle was saved by gol %u.%u.%u, "
+				"so all tiles are treated as changed",
+				version >> 16, (version >> 8) & 0xff, version & 0xff);
+			ConsoleWriter().timestamp() << buf;
+		}
+	}
+}
+
+bool TileSaver::isUnchanged(Tip tip, const ByteBlock& data) const
+{
+	if (baseStamps_.empty() || !baseStampsComparable_) return false;
+	uint64_t stamp = (static_cast<uint64_t>(data.size()) << 32) |
+		Crc32C::compute(data.data(), data.size());
+	return baseStamps_[tip] == stamp;
 }
 
 void TileSaverWorker::processTask(TileSaverTask& task)
 {
-	FeatureStore* store = saver_->store_;
-	DataPtr pTile = store->fetchTile(task.tip());
-	TileModel tile;
-	tile.wayNodeIds(saver_->wayNodeIds_);
-	TileReader reader(tile);
-	// store->prefetchBlob(pTile);
-	reader.readTile(task.tile(), TilePtr(pTile));
+	ByteBlock data = saver_->encodeTile(encoder_, task.tile(), task.tip());
+	if (saver_->verifyEncoding_ && !saver_->compiledTiles_)
+	{
+		verifyEncoding(task, data);
+	}
+	if (saver_->isUnchanged(task.tip(), data))
+	{
+		// An empty tile only advances the progress
+		saver_->postOutput(TileData(task.tip(), nullptr, 0));
+		return;
+	}
+	uncompressedBytes_ += data.size();
+	saver_->postOutput(compress(task.tip(), std::move(data)));
+}
 
+// Aborts if TileReader + TesWriter don't encode the tile
+// to the same bytes as BlobTesWriter did
+void TileSaverWorker::verifyEncoding(const TileSaverTask& task, const ByteBlock& data)
+{
+	tile_.wayNodeIds(saver_->wayNodeIds_);
+	TileReader reader(tile_);
+	reader.readTile(task.tile(), TilePtr(saver_->store_->fetchTile(task.tip())));
 	DynamicBuffer buf(1024 * 1024);
-	TesWriter writer(tile, &buf);
+	TesWriter writer(tile_, &buf, saver_->columnarTes_);
 	writer.write();
-	saver_->postOutput(TileSaver::compressTile(task.tip(), buf.takeBytes()));
+	tile_.clear();
+	ByteBlock expected = buf.takeBytes();
+	if (expected.size() != data.size() ||
+		memcmp(expected.data(), data.data(), data.size()) != 0)
+	{
+		char msg[128];
+		Format::unsafe(msg, "Tile %06X is encoded differently by "
+			"BlobTesWriter and TesWriter", static_cast<uint32_t>(task.tip()));
+		CliApplication::abort(msg);
+	}
+}
+
+TileData TileSaverWorker::compress(Tip tip, ByteBlock&& data)
+{
+	if (saver_->codec_ != TesArchiveHeader::ZSTD)
+	{
+		return TileSaver::compressTile(tip, std::move(data));
+	}
+	if (!zstd_)
+	{
+		zstd_ = std::make_unique<ZstdCompressor>();
+		const ByteBlock& dictionary = saver_->dictionary_;
+		if (dictionary.size()) zstd_->setDictionary(dictionary.data(), dictionary.size());
+	}
+	ByteBlock compressed = zstd_->compressSealedChunk(data.data(), data.size());
+	uint32_t compressedSize = static_cast<uint32_t>(compressed.size());
+	return { tip, compressed.take(), compressedSize };
+}
+
+void TileSaverWorker::harvestResults()
+{
+	saver_->uncompressedBytes_ += uncompressedBytes_;
+}
+
+void TileSaver::reportCompression() const
+{
+	if (Console::verbosity() < Console::Verbosity::VERBOSE) return;
+	if (totalBytesWritten_ == 0) return;
+	char buf[160];
+	snprintf(buf, sizeof(buf),
+		"Compressed %llu bytes of tiles into %llu bytes (%.1f%%) using %s",
+		static_cast<unsigned long long>(uncompressedBytes_),
+		static_cast<unsigned long long>(totalBytesWritten_),
+		totalBytesWritten_ * 100.0 / std::max(uncompressedBytes_, uint64_t{1}),
+		codec_ == TesArchiveHeader::ZSTD ? "zstd with dictionary" : "deflate");
+	ConsoleWriter().timestamp() << buf;
 }
 
 
@@ -102,6 +386,16 @@ ByteBlock TileSaver::gatherMetadata() const
 }
 
 
+ByteBlock TileSaver::gatherDeletedTiles() const
+{
+	size_t size = deletedTips_.size() * sizeof(uint32_t);
+	std::unique_ptr<uint8_t[]> pMetadata(new uint8_t[size + 16]);
+	uint8_t* p = pMetadata.get();
+	writeMetadataSection(p, TesMetadataType::DELETED_TILES, deletedTips_.data(), size);
+	return ByteBlock(std::move(pMetadata), p - pMetadata.get());
+}
+
+
 ByteBlock TileSaver::createBlankTileIndex() const
 {
 	DataPtr tileIndex = store_->tileIndex();
@@ -129,16 +423,41 @@ TileData TileSaver::compressTile(Tip tip, ByteBlock&& data)
 
 void TileSaver::preProcessOutput()
 {
-	ByteBlock data = gatherMetadata();
+	ByteBlock data = isDelta_ ? gatherDeletedTiles() : gatherMetadata();
+	if (codec_ == TesArchiveHeader::ZSTD)
+	{
+		// The dictionary is trained on tiles, so it is of no
+		// use for the metadata
+		ZstdCompressor zstd;
+		ByteBlock compressed = zstd.compressSealedChunk(data.data(), data.size());
+		uint32_t compressedSize = static_cast<uint32_t>(compressed.size());
+		writer_.writeMetadata({ Tip(), compressed.take(), compressedSize });
+		return;
+	}
 	writer_.writeMetadata(compressTile(Tip(), std::move(data)));
 }
 
 void TileSaver::processTask(TileData& task)
 {
-	writer_.writeTile(std::move(task));
 	workCompleted_ += workPerTile_;
 	Console::get()->setProgress(static_cast<int>(workCompleted_));
-	totalBytesWritten_ += task.size();
+	uint32_t rank = ranks_[task.tip()];
+	reorderBuffer_[rank] = std::move(task);
+	arrived_[rank] = true;
+	while (nextRank_ < arrived_.size() && arrived_[nextRank_])
+	{
+		writeTile(std::move(reorderBuffer_[nextRank_]));
+		nextRank_++;
+	}
 }
 
-
+void TileSaver::writeTile(TileData&& tile)
+{
+	if (tile.size() == 0)
+	{
+		unchangedTileCount_++;		// same as in the base
+		return;
+	}
+	totalBytesWritten_ += tile.size();
+	writer_.writeTile(std::move(tile));
+}
\ No newline at end of file
@@ -3,13 +3,18 @@
 
 #pragma once
 
+#include <memory>
+#include <string>
+#include <vector>
 #include <clarisma/io/File.h>
 #include <clarisma/thread/TaskEngine.h>
+#include <clarisma/zip/Zstd.h>
 #include <geodesk/feature/Tip.h>
 #include <geodesk/geom/Tile.h>
+#include "tile/model/TileModel.h"
+#include "tile/tes/BlobTesWriter.h"
 #include "tile/tes/TesArchive.h"
 #include "tile/tes/TesArchiveWriter.h"
-#include "tile/tes/TesWriter.h"
 
 namespace geodesk {
 class FeatureStore;
@@ -17,6 +22,34 @@ class ZoomLevels;
 }
 class TileSaver;
 
+/// How TileSaver writes a GOB
+///
+struct TileSaverSettings
+{
+	bool wayNodeIds = false;
+	TesArchiveHeader::Codec codec = TesArchiveHeader::DEFLATE;
+	bool columnarTes = false;
+	/// Saves the tiles as they are stored in the library instead of
+	/// as TES (see TesArchiveHeader::COMPILED_TILES); `wayNodeIds`
+	/// and `columnarTes` are ignored
+	bool compiledTiles = false;
+	/// Places the tiles along a Hilbert curve, so a compact area can
+	/// be downloaded with few range requests; otherwise, they are
+	/// placed in the order given to TileSaver::save()
+	bool hilbertOrder = true;
+	/// If set, only the tiles whose contents differ from those in this
+	/// Bundle are saved (as a delta); the delta uses the same TES
+	/// flavor as the base, regardless of `wayNodeIds` and `columnarTes`
+	std::string since;
+	/// Tiles in the saved area that the library lacks (or that are
+	/// stale); a delta records them as deleted if the base has them
+	std::vector<Tip> missingTips;
+	/// Also encodes every tile by reading it into a TileModel and
+	/// writing that with TesWriter (as gol did before BlobTesWriter),
+	/// and fails if the two encodings differ (slow, meant for testing)
+	bool verifyEncoding = false;
+};
+
 
 class TileSaverTask
 {
@@ -39,10 +72,17 @@ public:
 	explicit TileSaverWorker(TileSaver* saver) : saver_(saver) {}
 	void processTask(TileSaverTask& task);
 	void afterTasks() {}
-	void harvestResults() {}
+	void harvestResults();
 
 private:
+	TileData compress(Tip tip, ByteBlock&& data);
+	void verifyEncoding(const TileSaverTask& task, const ByteBlock& data);
+
 	TileSaver* saver_;
+	BlobTesWriter encoder_;		// reused for every tile
+	TileModel tile_;			// only used to verify the encoding
+	std::unique_ptr<ZstdCompressor> zstd_;	// created on first use
+	uint64_t uncompressedBytes_ = 0;
 };
 
 class TileSaver : public TaskEngine<TileSaver, TileSaverWorker, TileSaverTask, TileData>
@@ -50,15 +90,43 @@ class TileSaver : public TaskEngine<TileSaver, TileSaverWorker, TileSaverTask, T
 public:
 	TileSaver(FeatureStore* store, int threadCount);
 
-	void save(const char* fileName, std::vector<std::pair<Tile,Tip>>& tiles, bool wayNodeIds);
+	void save(const char* fileName, std::vector<std::pair<Tile,Tip>>& tiles,
+		const TileSaverSettings& settings);
 	void preProcessOutput();     // CRTP override
 	void processTask(TileData& task);
 	int64_t totalBytesWritten() const { return totalBytesWritten_; }
+	uint32_t changedTileCount() const { return static_cast<uint32_t>(entryCount_) - unchangedTileCount_; }
+	uint32_t deletedTileCount() const { return static_cast<uint32_t>(deletedTips_.size()); }
 
 	static TileData compressTile(Tip tip, ByteBlock&& data);
 
 private:
+	/// Dictionaries larger than this barely improve compression
+	/// (the zstd default), and are costly to digest for each worker
+	static constexpr size_t DICTIONARY_SIZE = 112 * 1024;
+	/// zstd recommends about 100x as much sample data as the
+	/// dictionary size
+	static constexpr size_t MAX_SAMPLE_BYTES = DICTIONARY_SIZE * 100;
+	static constexpr size_t MAX_SAMPLE_TILES = 2000;
+
+	/// Sorts the tiles by the Hilbert distance of their centers
+	///
+	static void sortByHilbertOrder(std::vector<std::pair<Tile,Tip>>& tiles);
+	void initOrder(const std::vector<std::pair<Tile,Tip>>& tiles);
+	void writeTile(TileData&& tile);
+	ByteBlock encodeTile(BlobTesWriter& encoder, Tile tileBounds, Tip tip) const;
+	/// Trains a zstd dictionary on a sample of the given tiles
+	/// (empty if there are too few tiles to train on)
+	///
+	ByteBlock trainDictionary(const std::vector<std::pair<Tile,Tip>>& tiles) const;
+	void reportCompression() const;
+	/// Reads the size and checksum of each tile's TES in the
+	/// given base Bundle, and determines which tiles were deleted
+	///
+	void readBase(const char* fileName, const std::vector<Tip>& missingTips);
+	bool isUnchanged(Tip tip, const ByteBlock& data) const;
 	ByteBlock gatherMetadata() const;
+	ByteBlock gatherDeletedTiles() const;
 	static void writeMetadataSection(uint8_t*& p, TesMetadataType type, const void* src, size_t size);
 	ByteBlock createBlankTileIndex() const;
 
@@ -69,6 +137,33 @@ private:
 	int64_t totalBytesWritten_;
 	int entryCount_;
 	bool wayNodeIds_ = false;
+	TesArchiveHeader::Codec codec_ = TesArchiveHeader::DEFLATE;
+	bool columnarTes_ = false;
+	bool compiledTiles_ = false;
+	bool verifyEncoding_ = false;
+	ByteBlock dictionary_;
+	uint64_t uncompressedBytes_ = 0;		// gathered from the workers
+
+	// Tiles are written in the order in which they were posted;
+	// tiles that are encoded ahead of their turn wait in the
+	// reorder buffer
+	std::vector<uint32_t> ranks_;			// by TIP
+	std::vector<TileData> reorderBuffer_;	// by rank
+	std::vector<bool> arrived_;				// by rank
+	uint32_t nextRank_ = 0;
+
+	// Only used for deltas
+	bool isDelta_ = false;
+	uint32_t baseRevision_ = 0;
+	uint32_t baseFlags_ = 0;
+	/// The uncompressed size (upper 32 bits) and checksum (lower 32 bits)
+	/// of each tile in the base, indexed by TIP (0 if absent)
+	std::vector<uint64_t> baseStamps_;
+	/// Whether the base was saved by this version of gol (if not,
+	/// its stamps are only used to tell which tiles it contains)
+	bool baseStampsComparable_ = false;
+	std::vector<uint32_t> deletedTips_;
+	uint32_t unchangedTileCount_ = 0;
 
 	friend class TileSaverWorker;
 };
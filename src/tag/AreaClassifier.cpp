@@ -94,11 +94,15 @@ AreaClassifier::AreaClassifier(std::vector<Entry>& entries, const GlobalStringLo
 	MutableDataPtr p = new std::byte[ruleTableSize];
 	rules_.reset(p.bytePtr());
 
+	std::vector<std::pair<uint32_t,RulePtr>> globalKeys;
+	std::vector<std::pair<uint32_t,bool>> globalValues;
 	pEntry = entries.data();
 	while (pEntry < end)
 	{
 		Entry* pKey = pEntry++;
 		assert(pKey->isKey);
+		int keyCode = lookup(pKey->string);
+		bool isGlobalKey = keyCode >= 0 && keyCode <= TagValues::MAX_COMMON_KEY;
 		const std::byte* pRule = nullptr;
 		if ((pKey->flags & RulePtr::ACCEPT_ALL) == 0)
 		{
@@ -113,6 +117,11 @@ AreaClassifier::AreaClassifier(std::vector<Entry>& entries, const GlobalStringLo
 					if (pRule == nullptr) pRule = p.bytePtr();
 					p.putUnsignedShort(pEntry->code);
 					p += 2;
+					if (isGlobalKey)
+					{
+						globalValues.emplace_back(
+							(static_cast<uint32_t>(keyCode) << 16) | pEntry->code, true);
+					}
 				}
 				else
 				{
@@ -131,11 +140,11 @@ AreaClassifier::AreaClassifier(std::vector<Entry>& entries, const GlobalStringLo
 			p.putUnsignedShort(0xffff);	// end of global values
 			p += 2;
 		}
-		int code = lookup(pKey->string);
-		if (code >= 0 && code <= TagValues::MAX_COMMON_KEY)
+		if (isGlobalKey)
 		{
-			globalKeyRules_.insert({static_cast<uint_fast32_t>(code),
-				RulePtr(pRule, rules_.get(), pKey->flags)});
+			RulePtr rule(pRule, rules_.get(), pKey->flags);
+			globalKeyRules_.insert({static_cast<uint_fast32_t>(keyCode), rule});
+			globalKeys.emplace_back(static_cast<uint32_t>(keyCode), rule);
 		}
 		else
 		{
@@ -144,6 +153,8 @@ AreaClassifier::AreaClassifier(std::vector<Entry>& entries, const GlobalStringLo
 		}
 	}
 	assert(p.bytePtr() == rules_.get() + ruleTableSize);
+	globalKeyTable_ = PerfectHashTable<RulePtr>(globalKeys);
+	globalValueTable_ = PerfectHashTable<bool>(globalValues);
 
 	/*
 	if(Console::verbosity() >= Console::Verbosity::DEBUG)
@@ -210,26 +221,13 @@ std::vector<AreaClassifier::Entry> AreaClassifier::Parser::parseRules()
 
 int AreaClassifier::isArea(const TagTableModel& tags) const
 {
-	bool isGeneralArea = false;
-	bool isDefiniteWayArea = false;
-	bool isDefiniteRelationArea = false;
-	bool seenDefiniteWayTag = false;
-	bool seenDefiniteRelationTag = false;
-
+	Verdict verdict;
 	for(auto tag : tags.globalTags())
 	{
-		auto it = globalKeyRules_.find(tag.globalKey());
-		if (it != globalKeyRules_.end())
+		const RulePtr* rule = globalKeyTable_.find(tag.globalKey());
+		if (rule)
 		{
-			RulePtr rule = it->second;
-			bool isAreaTag = isArea(rule, tag);
-			bool isDefiniteWayAreaTag = (rule.flags() & RulePtr::DEFINITE_FOR_WAY);
-			seenDefiniteWayTag |= isDefiniteWayAreaTag;
-			isDefiniteWayArea |= isDefiniteWayAreaTag & isAreaTag;
-			bool isDefiniteRelAreaTag = (rule.flags() & RulePtr::DEFINITE_FOR_RELATION);
-			seenDefiniteRelationTag |= isDefiniteRelAreaTag;
-			isDefiniteRelationArea |= isDefiniteRelAreaTag & isAreaTag;
-			isGeneralArea |= isAreaTag;
+			verdict.add(*rule, isGlobalKeyArea(*rule, tag));
 		}
 		/*
 		 // TODO: Can potentially quit early
@@ -239,26 +237,35 @@ int AreaClassifier::isArea(const TagTableModel& tags) const
 		}
 		*/
 	}
+	addLocalKeyTags(tags, verdict);
+	return verdict.result();
+}
 
+int AreaClassifier::isAreaReference(const TagTableModel& tags) const
+{
+	Verdict verdict;
+	for(auto tag : tags.globalTags())
+	{
+		auto it = globalKeyRules_.find(tag.globalKey());
+		if (it != globalKeyRules_.end())
+		{
+			verdict.add(it->second, isArea(it->second, tag));
+		}
+	}
+	addLocalKeyTags(tags, verdict);
+	return verdict.result();
+}
+
+void AreaClassifier::addLocalKeyTags(const TagTableModel& tags, Verdict& verdict) const
+{
 	for(auto tag : tags.localTags())
 	{
 		auto it = localKeyRules_.find(tag.localKey());
 		if (it != localKeyRules_.end())
 		{
-			RulePtr rule = it->second;
-			bool isAreaTag = isArea(rule, tag);
-			bool isDefiniteWayAreaTag = (rule.flags() & RulePtr::DEFINITE_FOR_WAY);
-			seenDefiniteWayTag |= isDefiniteWayAreaTag;
-			isDefiniteWayArea |= isDefiniteWayAreaTag & isAreaTag;
-			bool isDefiniteRelAreaTag = (rule.flags() & RulePtr::DEFINITE_FOR_RELATION);
-			seenDefiniteRelationTag |= isDefiniteRelAreaTag;
-			isDefiniteRelationArea |= isDefiniteRelAreaTag & isAreaTag;
-			isGeneralArea |= isAreaTag;
+			verdict.add(it->second, isArea(it->second, tag));
 		}
 	}
-
-	return ((seenDefiniteWayTag ? isDefiniteWayArea : isGeneralArea) ? AREA_FOR_WAY : 0) |
-		((seenDefiniteRelationTag ? isDefiniteRelationArea : isGeneralArea) ? AREA_FOR_RELATION : 0);
 }
 
 /*
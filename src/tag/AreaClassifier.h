@@ -9,6 +9,7 @@
 #include <clarisma/util/ShortVarString.h>
 #include <geodesk/feature/GlobalStrings.h>
 #include "AbstractTagsParser.h"
+#include "PerfectHashTable.h"
 #include "TagTableModel.h"
 
 
@@ -67,6 +68,13 @@ public:
     static constexpr int AREA_FOR_RELATION = 2;
 
     int isArea(const TagTableModel& tags) const;
+
+	/// Classifies tags the way isArea() did before the rules for
+	/// global keys were compiled into perfect-hash tables (hash map
+	/// lookup of the key, linear scan of its values). Used by
+	/// `gol bench area-rules` to check the compiled tables.
+	///
+	int isAreaReference(const TagTableModel& tags) const;
 	// void dump(BufferWriter& out, const StringCatalog& strings) const;
 
 private:
@@ -93,6 +101,8 @@ private:
             DEFINITE_FOR_RELATION = 8,
 		};
 
+		RulePtr() : data_(0) {}
+
 		RulePtr(const std::byte* p, const std::byte* pBase, int flags) :
 			data_((static_cast<uint32_t>(p - pBase) << 4) |
 				static_cast<uint32_t>(flags)) {}
@@ -120,6 +130,58 @@ private:
 		return false;
 	}
 
+	/// Tracks the rules matched by the tags of a feature
+	///
+	class Verdict
+	{
+	public:
+		void add(RulePtr rule, bool isAreaTag)
+		{
+			bool isDefiniteWayAreaTag = (rule.flags() & RulePtr::DEFINITE_FOR_WAY);
+			seenDefiniteWayTag_ |= isDefiniteWayAreaTag;
+			isDefiniteWayArea_ |= isDefiniteWayAreaTag & isAreaTag;
+			bool isDefiniteRelAreaTag = (rule.flags() & RulePtr::DEFINITE_FOR_RELATION);
+			seenDefiniteRelationTag_ |= isDefiniteRelAreaTag;
+			isDefiniteRelationArea_ |= isDefiniteRelAreaTag & isAreaTag;
+			isGeneralArea_ |= isAreaTag;
+		}
+
+		int result() const
+		{
+			return ((seenDefiniteWayTag_ ? isDefiniteWayArea_ : isGeneralArea_) ? AREA_FOR_WAY : 0) |
+				((seenDefiniteRelationTag_ ? isDefiniteRelationArea_ : isGeneralArea_) ? AREA_FOR_RELATION : 0);
+		}
+
+	private:
+		bool isGeneralArea_ = false;
+		bool isDefiniteWayArea_ = false;
+		bool isDefiniteRelationArea_ = false;
+		bool seenDefiniteWayTag_ = false;
+		bool seenDefiniteRelationTag_ = false;
+	};
+
+	/// Checks the value of a tag with a global key against the
+	/// compiled tables
+	///
+	bool isGlobalKeyArea(RulePtr rule, TagTableModel::Tag tag) const
+	{
+		if(tag.valueType() == TagValueType::GLOBAL_STRING) [[likely]]
+		{
+			uint32_t value = tag.value();
+			if(value == GlobalStrings::NO) return false;
+			if(rule.flags() & RulePtr::ACCEPT_ALL) return true;
+			return globalValueTable_.contains((tag.globalKey() << 16) | value) ^
+				(rule.flags() & RulePtr::REJECT_SOME);
+		}
+		if(tag.valueType() == TagValueType::LOCAL_STRING)
+		{
+			return isArea(rule, tag.stringValue());
+		}
+		return false;
+	}
+
+	void addLocalKeyTags(const TagTableModel& tags, Verdict& verdict) const;
+
 	bool isArea(RulePtr rule, uint_fast32_t value) const
 	{
 		if(value == GlobalStrings::NO) return false;
@@ -167,7 +229,12 @@ private:
 	void dumpRule(BufferWriter& out, RulePtr rule, const StringCatalog& strings) const;
 
 	std::unique_ptr<const std::byte[]> rules_;
-	HashMap<uint_fast32_t, RulePtr> globalKeyRules_;
+	/// Rules of global keys, by key code
+	PerfectHashTable<RulePtr> globalKeyTable_;
+	/// The global-string values listed in the rules of global keys,
+	/// as `(key << 16) | value`
+	PerfectHashTable<bool> globalValueTable_;
+	HashMap<uint_fast32_t, RulePtr> globalKeyRules_;	// only used by isAreaReference()
 	HashMap<std::string_view, RulePtr> localKeyRules_;
 	uint32_t lastDefiniteGlobalKey_;
 
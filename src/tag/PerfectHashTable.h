@@ -0,0 +1,109 @@
+// Copyright (c) 2025 Clarisma / GeoDesk contributors
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#pragma once
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/// A read-only hash table over a fixed set of 32-bit keys,
+/// built so that no two keys share a slot. A lookup is one
+/// multiplication, one shift and one compare.
+///
+/// The key 0xffffffff is reserved to mark empty slots.
+///
+template<typename V>
+class PerfectHashTable
+{
+public:
+	static constexpr uint32_t EMPTY = 0xffff'ffff;
+
+	PerfectHashTable() :
+		multiplier_(1),
+		shift_(31),
+		slots_(new Slot[2])
+	{
+	}
+
+	/// Builds the table. If a key occurs more than once,
+	/// its first value is used.
+	///
+	explicit PerfectHashTable(const std::vector<std::pair<uint32_t,V>>& items)
+	{
+		// Start with a load factor of at most 50%, and double the table
+		// until we find a multiplier without collisions (for the few
+		// dozen keys of a rule set, this typically settles at a table
+		// of a few hundred slots)
+		int bits = 1;
+		while ((size_t{1} << bits) < items.size() * 2) bits++;
+		uint64_t seed = 0x9E3779B97F4A7C15ULL;
+		for (;;)
+		{
+			size_t slotCount = size_t{1} << bits;
+			std::unique_ptr<Slot[]> slots(new Slot[slotCount]);
+			for (int attempt = 0; attempt < MAX_ATTEMPTS; attempt++)
+			{
+				seed ^= seed << 13;
+				seed ^= seed >> 7;
+				seed ^= seed << 17;
+				uint32_t multiplier = static_cast<uint32_t>(seed >> 32) | 1;
+				if (place(items, slots.get(), slotCount, multiplier, 32 - bits))
+				{
+					multiplier_ = multiplier;
+					shift_ = 32 - bits;
+					slots_ = std::move(slots);
+					return;
+				}
+			}
+			bits++;
+			assert(bits < 32);
+		}
+	}
+
+	/// Returns a pointer to the value of the given key,
+	/// or `nullptr` if the key is not in the table
+	///
+	const V* find(uint32_t key) const
+	{
+		const Slot& slot = slots_[(key * multiplier_) >> shift_];
+		return slot.key == key ? &slot.value : nullptr;
+	}
+
+	bool contains(uint32_t key) const
+	{
+		return slots_[(key * multiplier_) >> shift_].key == key;
+	}
+
+	size_t slotCount() const { return size_t{1} << (32 - shift_); }
+
+private:
+	static constexpr int MAX_ATTEMPTS = 64;
+
+	struct Slot
+	{
+		uint32_t key = EMPTY;
+		V value {};
+	};
+
+	static bool place(const std::vector<std::pair<uint32_t,V>>& items,
+		Slot* slots, size_t slotCount, uint32_t multiplier, int shift)
+	{
+		for (size_t i = 0; i < slotCount; i++) slots[i].key = EMPTY;
+		for (const auto& [key, value] : items)
+		{
+			assert(key != EMPTY);
+			Slot& slot = slots[static_cast<uint32_t>(key * multiplier) >> shift];
+			if (slot.key == key) continue;
+			if (slot.key != EMPTY) return false;
+			slot.key = key;
+			slot.value = value;
+		}
+		return true;
+	}
+
+	uint32_t multiplier_;
+	int shift_;
+	std::unique_ptr<Slot[]> slots_;
+};
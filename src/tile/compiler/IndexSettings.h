@@ -4,13 +4,18 @@
 #pragma once
 
 #include <geodesk/feature/FeatureStore.h>
+#include "RTreePacker.h"
 
 class IndexSettings 
 {
 public:
     IndexSettings(const FeatureStore::IndexedKeyMap& keysToCategories, 
-        int rtreeBucketSize, int maxKeyIndexes, int keyIndexMinFeatures) :
+        int rtreeBucketSize, int maxKeyIndexes, int keyIndexMinFeatures,
+        RTreePacking rtreePacking = RTreePacking::HILBERT,
+        bool adaptiveBranchSize = false) :
         rtreeBucketSize_(rtreeBucketSize),
+        rtreePacking_(rtreePacking),
+        adaptiveBranchSize_(adaptiveBranchSize),
         maxKeyIndexes_(maxKeyIndexes),
         keyIndexMinFeatures_(keyIndexMinFeatures),
         keysToCategories_(keysToCategories),
@@ -19,6 +24,8 @@ public:
     }
 
     int rtreeBucketSize() const { return rtreeBucketSize_; }
+    RTreePacking rtreePacking() const { return rtreePacking_; }
+    bool adaptiveBranchSize() const { return adaptiveBranchSize_; }
     int maxKeyIndexes() const { return maxKeyIndexes_; }
     int keyIndexMinFeatures() const { return keyIndexMinFeatures_; }
     int maxIndexedKey() const { return maxIndexedKey_; }
@@ -28,6 +35,16 @@ public:
         return (it != keysToCategories_.end()) ? it->second : 0;
     }
 
+    /// Returns the packing algorithm stored in the settings of a GOL
+    /// (unknown values, which can only stem from newer versions,
+    /// fall back to Hilbert packing)
+    ///
+    static RTreePacking rtreePackingOf(const FeatureStore::Settings& settings)
+    {
+        return settings.rtreeAlgo <= static_cast<int>(RTreePacking::AUTO) ?
+            static_cast<RTreePacking>(settings.rtreeAlgo) : RTreePacking::HILBERT;
+    }
+
 private:
     static int findMaxIndexedKey(const FeatureStore::IndexedKeyMap& map)
     {
@@ -40,6 +57,8 @@ private:
     }
 
     const int rtreeBucketSize_;
+    const RTreePacking rtreePacking_;
+    const bool adaptiveBranchSize_;
     const int maxKeyIndexes_;
     const int keyIndexMinFeatures_;
     const int maxIndexedKey_;
@@ -0,0 +1,334 @@
+// Copyright (c) 2025 Clarisma / GeoDesk contributors
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#include "RTreeBuilder.h"
+#include <vector>
+#include <clarisma/util/log.h>
+#include <geodesk/geom/LonLat.h>
+#include <geodesk/geom/index/hilbert.h>
+#include "tile/model/TIndexLeaf.h"
+#include "tile/model/TIndexTrunk.h"
+#include "tile/model/TNode.h"
+#include "tile/model/TWay.h"
+#include "tile/model/TRelation.h"
+#include "tile/model/TIndex.h"
+#include "IndexSettings.h"
+
+
+RTreeBuilder::RTreeBuilder(TileModel& tile, const IndexSettings& settings) :
+	arena_(tile.arena()),
+	tileBounds_(tile.bounds()),
+	rtreeBucketSize_(settings.rtreeBucketSize()),
+	packing_(settings.rtreePacking()),
+	adaptiveBranchSize_(settings.adaptiveBranchSize())
+{
+}
+
+
+/// Creates the nodes of the spatial index
+///
+class RTreeBuilder::BuildSink
+{
+public:
+	using Node = TIndexBranch*;
+
+	BuildSink(Arena& arena, TFeature** features) :
+		arena_(arena),
+		features_(features)
+	{
+	}
+
+	TIndexBranch* leaf(const uint32_t* items, int count)
+	{
+		TFeature* firstFeature = nullptr;
+		Box bounds;
+		do
+		{
+			count--;
+			TFeature* feature = features_[items[count]];
+			assert(feature->type() == TElement::Type::NODE ||
+				feature->type() == TElement::Type::FEATURE2D);
+			feature->setNext(firstFeature);
+			firstFeature = feature;
+			FeaturePtr f = feature->feature();
+			if (f.isNode())
+			{
+				bounds.expandToInclude(NodePtr(f).xy());
+			}
+			else
+			{
+				bounds.expandToIncludeSimple(f.bounds());
+			}
+		}
+		while (count);
+		// TODO: Do we need to constrain the bbox to the tile bounds?
+		return new(arena_.alloc<TIndexLeaf>()) TIndexLeaf(bounds, firstFeature);
+	}
+
+	TIndexBranch* trunk(TIndexBranch* const* children, int count)
+	{
+		int originalCount = count;
+		TIndexBranch* firstBranch = nullptr;
+		Box bounds;
+		do
+		{
+			count--;
+			TIndexBranch* branch = children[count];
+			branch->setNextSibling(firstBranch);
+			firstBranch = branch;
+			bounds.expandToIncludeSimple(branch->bounds());
+		}
+		while (count);
+		return new(arena_.alloc<TIndexTrunk>()) TIndexTrunk(bounds, firstBranch, originalCount);
+	}
+
+	static Box bounds(TIndexBranch* branch) { return branch->bounds(); }
+
+private:
+	Arena& arena_;
+	TFeature** features_;
+};
+
+
+/// Estimates the cost of small-bbox queries against a spatial index,
+/// without creating it: A node is visited if the query box intersects
+/// its bounds, which for a query box of size q and a randomly placed
+/// query is proportional to (w + q) * (h + q). A visit costs a fixed
+/// amount plus the scanning of the node's entries.
+///
+class RTreeBuilder::CostSink
+{
+public:
+	using Node = Box;
+
+	CostSink(TFeature** features, const Box& tileBounds) :
+		features_(features),
+		querySize_((static_cast<double>(tileBounds.maxX()) - tileBounds.minX()) / QUERY_SIZE_DIVISOR),
+		cost_(0)
+	{
+	}
+
+	double cost() const { return cost_; }
+
+	Box leaf(const uint32_t* items, int count)
+	{
+		Box bounds;
+		for (int i = 0; i < count; i++)
+		{
+			FeaturePtr f = features_[items[i]]->feature();
+			if (f.isNode())
+			{
+				bounds.expandToInclude(NodePtr(f).xy());
+			}
+			else
+			{
+				bounds.expandToIncludeSimple(f.bounds());
+			}
+		}
+		addNode(bounds, count);
+		return bounds;
+	}
+
+	Box trunk(const Box* children, int count)
+	{
+		Box bounds;
+		for (int i = 0; i < count; i++)
+		{
+			bounds.expandToIncludeSimple(children[i]);
+		}
+		addNode(bounds, count);
+		return bounds;
+	}
+
+	static Box bounds(const Box& box) { return box; }
+
+private:
+	/// The query box is this fraction of the tile's width
+	static constexpr double QUERY_SIZE_DIVISOR = 64;
+	/// Cost of visiting a node, relative to scanning one entry
+	static constexpr double NODE_VISIT_COST = 4;
+
+	void addNode(const Box& bounds, int count)
+	{
+		double w = static_cast<double>(bounds.maxX()) - bounds.minX() + querySize_;
+		double h = static_cast<double>(bounds.maxY()) - bounds.minY() + querySize_;
+		cost_ += w * h * (NODE_VISIT_COST + count);
+	}
+
+	TFeature** features_;
+	double querySize_;
+	double cost_;
+};
+
+
+TIndexTrunk* RTreeBuilder::build(TFeature* firstFeature, int count)
+{
+	// The workspace holds the sort keys, the scratch space for the
+	// radix sort, the features (in list order), whose index is
+	// carried in the lower 32 bits of each sort key, and (only needed
+	// by the STR and OMT algorithms) the center of each feature
+	uint64_t* workspace = reinterpret_cast<uint64_t*>(
+		arena_.alloc(count * 4 * sizeof(uint64_t), 8));
+	uint64_t* keys = workspace;
+	uint64_t* scratch = workspace + count;
+	TFeature** features = reinterpret_cast<TFeature**>(workspace + count * 2);
+	Coordinate* centers = reinterpret_cast<Coordinate*>(workspace + count * 3);
+
+	// Sort the features by their distance along the Hilbert Curve
+
+	uint32_t index = 0;
+	TFeature* feature = firstFeature;
+	do
+	{
+		uint32_t distance;
+		FeaturePtr f = feature->feature();
+		if (f.isNode())
+		{
+#ifndef NDEBUG
+			if(!tileBounds_.contains(NodePtr(f).xy()))
+			{
+				LOGS << "node/" << f.id() << " (" << LonLat(NodePtr(f).xy())
+					<< ") lies outside tile bounds " << tileBounds_ << "!\n";
+			}
+#endif
+			centers[index] = NodePtr(f).xy();
+			distance = hilbert::calculateHilbertDistance(centers[index], tileBounds_);
+		}
+		else
+		{
+			Box bounds = Box::simpleIntersection(f.bounds(), tileBounds_);
+			if (!bounds.contains(bounds.center()))
+			{
+				LOGS << f.typedId() << " not contained in tile bounds\n"
+					<< "  feature bbox = " << f.bounds() << "\n"
+					<< "     tile bbox = " << tileBounds_;
+			}
+			assert(bounds.contains(bounds.center()));
+			if (!tileBounds_.containsSimple(bounds))
+			{
+				LOG("%s not contained in tile bounds", f.toString().c_str());
+			}
+			centers[index] = bounds.center();
+			distance = hilbert::calculateHilbertDistance(centers[index], tileBounds_);
+		}
+		keys[index] = (static_cast<uint64_t>(distance) << 32) | index;
+		features[index] = feature;
+		index++;
+		feature = feature->nextFeature();
+	}
+	while (feature != firstFeature);
+	assert(index == count);
+
+	const uint64_t* sorted = sortByDistance(keys, scratch, count);
+
+	// Turn the sorted keys into a list of feature numbers
+	// (in whichever buffer does not hold the sorted keys)
+	uint32_t* order = reinterpret_cast<uint32_t*>(sorted == keys ? scratch : keys);
+	for (int i = 0; i < count; i++)
+	{
+		order[i] = static_cast<uint32_t>(sorted[i]);
+	}
+
+	Candidate candidate { packing_, rtreeBucketSize_ };
+	if (packing_ == RTreePacking::AUTO || adaptiveBranchSize_)
+	{
+		candidate = choose(order, features, centers, count);
+	}
+
+	BuildSink sink(arena_, features);
+	RTreePacker<BuildSink> packer(sink, centers, candidate.branchSize);
+	TIndexBranch* root = packer.pack(candidate.packing, order, count);
+	assert(!root->isLeaf());
+	return static_cast<TIndexTrunk*>(root);
+}
+
+
+/// Picks the packing algorithm and branch size with the lowest
+/// estimated query cost. Considers all algorithms if packing is
+/// AUTO, and half and twice the configured branch size if the
+/// branch size is adaptive.
+///
+RTreeBuilder::Candidate RTreeBuilder::choose(const uint32_t* hilbertOrder,
+	TFeature** features, const Coordinate* centers, int count) const
+{
+	Candidate best { packing_ == RTreePacking::AUTO ?
+		RTreePacking::HILBERT : packing_, rtreeBucketSize_ };
+	if (count <= rtreeBucketSize_ / 2) return best;
+		// A single leaf, regardless of algorithm or branch size
+
+	std::vector<RTreePacking> packings;
+	if (packing_ == RTreePacking::AUTO)
+	{
+		packings = { RTreePacking::HILBERT, RTreePacking::STR, RTreePacking::OMT };
+	}
+	else
+	{
+		packings = { packing_ };
+	}
+	std::vector<int> branchSizes { rtreeBucketSize_ };
+	if (adaptiveBranchSize_)
+	{
+		branchSizes.push_back(std::max(rtreeBucketSize_ / 2, 4));
+		branchSizes.push_back(std::min(rtreeBucketSize_ * 2, 255));
+	}
+
+	double bestCost = 0;
+	std::vector<uint32_t> order(count);
+	for (RTreePacking packing : packings)
+	{
+		for (int branchSize : branchSizes)
+		{
+			std::copy(hilbertOrder, hilbertOrder + count, order.begin());
+			CostSink sink(features, tileBounds_);
+			RTreePacker<CostSink> packer(sink, centers, branchSize);
+			packer.pack(packing, order.data(), count);
+			if (bestCost == 0 || sink.cost() < bestCost)
+			{
+				bestCost = sink.cost();
+				best = { packing, branchSize };
+			}
+		}
+	}
+	return best;
+}
+
+
+uint64_t* RTreeBuilder::sortByDistance(uint64_t* items, uint64_t* scratch, size_t count)
+{
+	if (count < 2) return items;
+
+	// Build the histograms for all four digits in a single pass
+	uint32_t histograms[4][256] = {};
+	for (size_t i = 0; i < count; i++)
+	{
+		uint32_t distance = static_cast<uint32_t>(items[i] >> 32);
+		histograms[0][distance & 0xff]++;
+		histograms[1][(distance >> 8) & 0xff]++;
+		histograms[2][(distance >> 16) & 0xff]++;
+		histograms[3][distance >> 24]++;
+	}
+
+	uint64_t* src = items;
+	uint64_t* dest = scratch;
+	for (int pass = 0; pass < 4; pass++)
+	{
+		uint32_t* histogram = histograms[pass];
+		int shift = 32 + pass * 8;
+		if (histogram[(src[0] >> shift) & 0xff] == count) continue;
+			// All items have the same digit, nothing to do
+		uint32_t offset = 0;
+		for (int i = 0; i < 256; i++)
+		{
+			uint32_t n = histogram[i];
+			histogram[i] = offset;
+			offset += n;
+		}
+		for (size_t i = 0; i < count; i++)
+		{
+			uint64_t item = src[i];
+			dest[histogram[(item >> shift) & 0xff]++] = item;
+		}
+		std::swap(src, dest);
+	}
+	return src;
+}
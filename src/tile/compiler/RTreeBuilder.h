@@ -0,0 +1,56 @@
+// Copyright (c) 2025 Clarisma / GeoDesk contributors
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#pragma once
+#include <utility> // for std::pair
+#include "tile/model/TileModel.h"
+#include "RTreePacker.h"
+
+class IndexSettings;
+class TFeature;
+class TIndexBranch;
+class TIndexLeaf;
+class TIndexTrunk;
+
+class RTreeBuilder
+{
+public:
+	RTreeBuilder(TileModel& tile, const IndexSettings& settings);
+
+	/**
+	 * Builds a spatial index for a set of features. Note that
+	 * features are in a CIRCULAR LIST, and an explicit count
+	 * must be passed (which must match the number of features)
+	 *
+	 * @param firstFeature a circular list of features
+	 * @param the number of features
+	 */
+	TIndexTrunk* build(TFeature* firstFeature, int count);
+
+	/// Sorts items of the form `(distance << 32) | index` by distance
+	/// (LSD radix sort, one pass per byte of the distance), keeping
+	/// items with equal distance in their original order. `scratch`
+	/// must have room for `count` items. Returns whichever of the two
+	/// buffers holds the sorted items.
+	///
+	static uint64_t* sortByDistance(uint64_t* items, uint64_t* scratch, size_t count);
+
+private:
+	struct Candidate
+	{
+		RTreePacking packing;
+		int branchSize;
+	};
+
+	class BuildSink;
+	class CostSink;
+
+	Candidate choose(const uint32_t* hilbertOrder, TFeature** features,
+		const Coordinate* centers, int count) const;
+
+	Arena& arena_;
+	Box tileBounds_;
+	const int rtreeBucketSize_;
+	const RTreePacking packing_;
+	const bool adaptiveBranchSize_;
+};
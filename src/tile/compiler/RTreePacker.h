@@ -0,0 +1,222 @@
+// Copyright (c) 2025 Clarisma / GeoDesk contributors
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include <geodesk/geom/Box.h>
+#include <geodesk/geom/Coordinate.h>
+
+using namespace geodesk;
+
+/// Algorithms for bulk-loading a spatial index. The values are stored
+/// as `rtreeAlgo` in the settings of a GOL.
+///
+enum class RTreePacking : uint8_t
+{
+	HILBERT = 0,	// consecutive runs along a Hilbert curve
+	STR = 1,		// Sort-Tile-Recursive
+	OMT = 2,		// Overlap-Minimizing Top-down
+	AUTO = 3		// cheapest of the above (estimated per index)
+};
+
+/// Packs items into an R-tree using one of the RTreePacking algorithms.
+/// Items are identified by their number, and only their centers are
+/// needed to pack them; the Sink creates the actual nodes:
+///
+/// - `Node leaf(const uint32_t* items, int count)`
+/// - `Node trunk(const Node* children, int count)`
+/// - `Box bounds(const Node& node)`
+///
+/// The root is always a trunk, and all leaves are at the same depth.
+///
+template<typename Sink>
+class RTreePacker
+{
+public:
+	using Node = typename Sink::Node;
+
+	static constexpr int MAX_BRANCH_SIZE = 256;
+
+	RTreePacker(Sink& sink, const Coordinate* centers, int branchSize) :
+		sink_(sink),
+		centers_(centers),
+		branchSize_(branchSize)
+	{
+		assert(branchSize >= 2 && branchSize <= MAX_BRANCH_SIZE);
+	}
+
+	/// Packs the items in `order` (which the STR and OMT algorithms
+	/// rearrange). For HILBERT, the items must already be sorted
+	/// by their distance along the Hilbert curve.
+	///
+	Node pack(RTreePacking packing, uint32_t* order, size_t count)
+	{
+		assert(count > 0);
+		switch (packing)
+		{
+		case RTreePacking::STR:
+			sortTiles(order, count, [this](uint32_t item) { return centers_[item]; });
+			return packLevels(order, count, true);
+		case RTreePacking::OMT:
+			return packOmt(order, count);
+		default:
+			return packLevels(order, count, false);
+		}
+	}
+
+private:
+	/// Creates the leaves from consecutive runs of items, then groups
+	/// consecutive runs of nodes into trunks until a single trunk
+	/// remains. If `str` is set, the nodes of each level are arranged
+	/// into tiles first.
+	///
+	Node packLevels(const uint32_t* order, size_t count, bool str)
+	{
+		std::vector<Node> nodes;
+		nodes.reserve((count + branchSize_ - 1) / branchSize_);
+		for (size_t i = 0; i < count; i += branchSize_)
+		{
+			nodes.push_back(sink_.leaf(order + i,
+				static_cast<int>(std::min<size_t>(branchSize_, count - i))));
+		}
+
+		std::vector<Node> parents;
+		do
+		{
+			if (str && nodes.size() > static_cast<size_t>(branchSize_))
+			{
+				sortNodes(nodes);
+			}
+			parents.clear();
+			for (size_t i = 0; i < nodes.size(); i += branchSize_)
+			{
+				parents.push_back(sink_.trunk(&nodes[i],
+					static_cast<int>(std::min<size_t>(branchSize_, nodes.size() - i))));
+			}
+			std::swap(nodes, parents);
+		}
+		while (nodes.size() > 1);
+		return nodes[0];
+	}
+
+	void sortNodes(std::vector<Node>& nodes)
+	{
+		std::vector<Coordinate> centers;
+		std::vector<uint32_t> order(nodes.size());
+		centers.reserve(nodes.size());
+		for (uint32_t i = 0; i < nodes.size(); i++)
+		{
+			centers.push_back(sink_.bounds(nodes[i]).center());
+			order[i] = i;
+		}
+		sortTiles(order.data(), order.size(),
+			[&centers](uint32_t i) { return centers[i]; });
+		std::vector<Node> sorted;
+		sorted.reserve(nodes.size());
+		for (uint32_t i : order) sorted.push_back(nodes[i]);
+		nodes = std::move(sorted);
+	}
+
+	/// Arranges the entries so that consecutive runs of branchSize_
+	/// entries form roughly square tiles: sorts by x, cuts into
+	/// vertical slices of about sqrt(n / branchSize_) runs each,
+	/// and sorts each slice by y.
+	///
+	template<typename Center>
+	void sortTiles(uint32_t* order, size_t count, Center center) const
+	{
+		size_t runCount = (count + branchSize_ - 1) / branchSize_;
+		size_t sliceCount = static_cast<size_t>(std::ceil(std::sqrt(
+			static_cast<double>(runCount))));
+		size_t sliceSize = (runCount + sliceCount - 1) / sliceCount * branchSize_;
+		sortByX(order, count, center);
+		for (size_t start = 0; start < count; start += sliceSize)
+		{
+			sortByY(order + start, std::min(sliceSize, count - start), center);
+		}
+	}
+
+	Node packOmt(uint32_t* order, size_t count)
+	{
+		int height = 1;
+		uint64_t capacity = branchSize_;
+		while (capacity < count)
+		{
+			capacity *= branchSize_;
+			height++;
+		}
+		if (height == 1)
+		{
+			Node leaf = sink_.leaf(order, static_cast<int>(count));
+			return sink_.trunk(&leaf, 1);
+		}
+		return packOmtSubtree(order, count, height, capacity / branchSize_);
+	}
+
+	/// Splits the entries into at most branchSize_ groups of up to
+	/// `childCapacity` items: cuts the range (sorted by x) into
+	/// about sqrt(groups) vertical slabs, then each slab (sorted
+	/// by y) into groups, and packs each group the same way
+	///
+	Node packOmtSubtree(uint32_t* order, size_t count, int height, uint64_t childCapacity)
+	{
+		if (height == 1) return sink_.leaf(order, static_cast<int>(count));
+
+		size_t childCount = static_cast<size_t>((count + childCapacity - 1) / childCapacity);
+		size_t slabCount = static_cast<size_t>(std::ceil(std::sqrt(
+			static_cast<double>(childCount))));
+		size_t perChild = (count + childCount - 1) / childCount;
+		size_t perSlab = perChild * ((childCount + slabCount - 1) / slabCount);
+		auto center = [this](uint32_t item) { return centers_[item]; };
+
+		Node children[MAX_BRANCH_SIZE];
+		int n = 0;
+		sortByX(order, count, center);
+		for (size_t slabStart = 0; slabStart < count; slabStart += perSlab)
+		{
+			size_t slabEnd = std::min(slabStart + perSlab, count);
+			sortByY(order + slabStart, slabEnd - slabStart, center);
+			for (size_t start = slabStart; start < slabEnd; start += perChild)
+			{
+				assert(n < branchSize_);
+				children[n++] = packOmtSubtree(order + start,
+					std::min(perChild, slabEnd - start), height - 1,
+					childCapacity / branchSize_);
+			}
+		}
+		return sink_.trunk(children, n);
+	}
+
+	// Ties are broken by entry number, so the result never depends
+	// on the initial order of the entries
+
+	template<typename Center>
+	static void sortByX(uint32_t* order, size_t count, Center center)
+	{
+		std::sort(order, order + count, [&center](uint32_t a, uint32_t b)
+		{
+			Coordinate ca = center(a);
+			Coordinate cb = center(b);
+			return ca.x < cb.x || (ca.x == cb.x && a < b);
+		});
+	}
+
+	template<typename Center>
+	static void sortByY(uint32_t* order, size_t count, Center center)
+	{
+		std::sort(order, order + count, [&center](uint32_t a, uint32_t b)
+		{
+			Coordinate ca = center(a);
+			Coordinate cb = center(b);
+			return ca.y < cb.y || (ca.y == cb.y && a < b);
+		});
+	}
+
+	Sink& sink_;
+	const Coordinate* centers_;
+	const int branchSize_;
+};
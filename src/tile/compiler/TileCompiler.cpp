@@ -2,11 +2,16 @@
 // SPDX-License-Identifier: AGPL-3.0-only
 
 #include "TileCompiler.h"
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+#include <clarisma/util/Strings.h>
 #include <clarisma/zip/Zip.h>
 #include <geodesk/feature/FeatureStore.h>
 #include <tile/model/THeader.h>
 #include "IndexSettings.h"
 #include "tile/model/Layout.h"
+#include "tile/model/TFeature2D.h"
 #include "tile/model/TileReader.h"
 #include "tile/tes/TesArchive.h"
 #include "tile/tes/TesReader.h"
@@ -17,6 +22,7 @@ void TileCompiler::modifyTile(Tip tip, Tile tile)
     DataPtr pTile = store_->fetchTile(tip);
     TileReader reader(tile_);
     reader.readTile(tile, TilePtr(pTile));
+    sourceExports_ = tile_.exportTable();
 }
 
 void TileCompiler::addChanges(std::span<const uint8_t> tesData)
@@ -35,9 +41,37 @@ void TileCompiler::addChanges(const TesArchiveEntry& entry, const uint8_t* data)
 ByteBlock TileCompiler::compile()
 {
     const FeatureStore::Settings& settings = store_->header()->settings;
-    IndexSettings indexSettings(store_->keysToCategories(),
+    FeatureStore::IndexedKeyMap keysToCategories = store_->keysToCategories();
+    IndexSettings indexSettings(keysToCategories,
         settings.rtreeBranchSize, settings.maxKeyIndexes,
-        settings.keyIndexMinFeatures);
+        settings.keyIndexMinFeatures, IndexSettings::rtreePackingOf(settings));
+
+    ByteBlock block;
+    std::string mismatch;
+    wasPatched_ = false;
+    if (tile_.sourceSize() != 0)
+    {
+        block = patch(indexSettings);
+        wasPatched_ = block.size() != 0;
+    }
+    if (!wasPatched_)
+    {
+        block = rebuild(indexSettings);
+    }
+    else if (verifyPatches_)
+    {
+        resetLocations();
+        mismatch = verifyPatch(block, rebuild(indexSettings));
+    }
+    tile_.clear();      // ready for the next tile
+    sourceExports_ = nullptr;
+    if (!mismatch.empty()) throw std::runtime_error(mismatch);
+    return block;
+}
+
+
+ByteBlock TileCompiler::rebuild(const IndexSettings& indexSettings)
+{
     THeader indexer(indexSettings);
     indexer.addFeatures(tile_);
     indexer.setExportTable(tile_.exportTable());
@@ -50,4 +84,186 @@ ByteBlock TileCompiler::compile()
 
     uint8_t* newTileData = tile_.write(layout);
     return { newTileData, static_cast<size_t>(layout.size()) };
-}
\ No newline at end of file
+}
+
+
+/// Classifies the changes that the TES has made to a feature of the
+/// source tile. A change is limited to tags if the feature's stub
+/// (apart from its tag pointer) and its body are the same as in the
+/// source tile, and the new tags don't move the feature to a different
+/// spatial index.
+///
+TileCompiler::Change TileCompiler::changeOf(
+    TFeature* feature, const IndexSettings& indexSettings)
+{
+    if (feature->isOriginal()) return Change::NONE;
+    const uint8_t* source = tile_.source().ptr();
+    uint32_t sourceSize = tile_.sourceSize();
+    if (feature->handle() >= sourceSize) return Change::OTHER;  // new feature
+
+    int32_t a = static_cast<int32_t>(feature->anchor());
+    const uint8_t* oldStub = source + feature->handle() - a;
+    const uint8_t* newStub = feature->feature().ptr() - a;
+    uint32_t size = feature->size();
+    if (memcmp(oldStub, newStub, a + 8) != 0 ||
+        memcmp(oldStub + a + 12, newStub + a + 12, size - a - 12) != 0)
+    {
+        return Change::OTHER;
+    }
+
+    if (feature->type() == TElement::Type::FEATURE2D)
+    {
+        // A new body (geometry, members or parent relations changed)
+        // is no longer backed by the source tile
+        const TFeatureBody* body = static_cast<TFeature2D*>(feature)->body();
+        const uint8_t* pBody = body->dataStart();
+        if (pBody < source || pBody + body->size() > source + sourceSize)
+        {
+            return Change::OTHER;
+        }
+    }
+
+    int32_t oldTagPtr = DataPtr(oldStub + a + 8).getInt() & 0xffff'fffe;
+    TTagTable* oldTags = tile_.getTags(feature->handle() + 8 + oldTagPtr);
+    TTagTable* newTags = feature->tags(tile_);
+    if (oldTags == newTags) return Change::NONE;
+    if (oldTags->assignIndexCategory(indexSettings) !=
+        newTags->assignIndexCategory(indexSettings))
+    {
+        return Change::OTHER;
+    }
+    return Change::TAGS;
+}
+
+
+/// Patches the source tile if only the tags of a few of its features
+/// have changed: new tag tables (and any new strings they use) are
+/// appended to the source tile, and the tag pointers of the changed
+/// features are rewritten in place. Everything else (including the
+/// spatial indexes) stays where it is. Returns an empty block if the
+/// tile must be rebuilt instead.
+///
+ByteBlock TileCompiler::patch(const IndexSettings& indexSettings)
+{
+    if (tile_.exportTable() != sourceExports_) return {};
+
+    std::vector<TFeature*> retagged;
+    FeatureTable::Iterator iter = tile_.iterFeatures();
+    while (iter.hasNext())
+    {
+        TFeature* feature = iter.next();
+        Change change = changeOf(feature, indexSettings);
+        if (change == Change::OTHER) return {};
+        if (change == Change::TAGS)
+        {
+            if (retagged.size() == MAX_PATCHED_FEATURES) return {};
+            retagged.push_back(feature);
+        }
+    }
+
+    // Tag tables and strings of the source tile stay where they are,
+    // unless they need a stricter alignment (a string that has become
+    // a local key must be 4-byte aligned), in which case we'll place
+    // a copy
+    uint32_t sourceSize = tile_.sourceSize();
+    for (TReferencedElement* elem : tile_.getElements())
+    {
+        if (elem->handle() >= sourceSize) continue;
+        if (elem->type() != TElement::Type::STRING &&
+            elem->type() != TElement::Type::TAGS)
+        {
+            continue;
+        }
+        int32_t location = static_cast<int32_t>(elem->handle() - elem->anchor());
+        if (elem->alignedLocation(location) == location)
+        {
+            elem->setLocation(location);
+        }
+    }
+
+    Layout layout(tile_);
+    layout.startAt(static_cast<int32_t>(sourceSize));
+    for (TFeature* feature : retagged)
+    {
+        feature->setLocation(static_cast<int32_t>(
+            feature->handle() - feature->anchor()));
+        TTagTable* tags = feature->tags(tile_);
+        if (tags->location() == 0)
+        {
+            layout.place(tags);
+            tags->placeStrings(layout);
+        }
+    }
+    layout.flush();
+    layout.placeBodies();
+
+    uint32_t growth = static_cast<uint32_t>(layout.size()) - sourceSize;
+    if (static_cast<uint64_t>(growth) * 100 >
+        static_cast<uint64_t>(sourceSize) * MAX_PATCH_GROWTH_PERCENT)
+    {
+        resetLocations();
+        return {};
+    }
+
+    uint8_t* newTileData = tile_.writePatch(layout, retagged);
+    return { newTileData, static_cast<size_t>(layout.size()) };
+}
+
+
+void TileCompiler::resetLocations()
+{
+    for (TReferencedElement* elem : tile_.getElements())
+    {
+        elem->setLocation(0);
+    }
+}
+
+
+/// Checks that a patched tile holds the same features, with the same
+/// flags, geometry and tags, as the tile built from scratch. Returns
+/// a description of the first difference, or an empty string if
+/// there is none.
+///
+std::string TileCompiler::verifyPatch(const ByteBlock& patched, const ByteBlock& rebuilt)
+{
+    TileModel patchedTile;
+    TileModel rebuiltTile;
+    patchedTile.wayNodeIds(tile_.wayNodeIds());
+    rebuiltTile.wayNodeIds(tile_.wayNodeIds());
+    TileReader(patchedTile).readTile(tile_.tile(), TilePtr(patched.data()));
+    TileReader(rebuiltTile).readTile(tile_.tile(), TilePtr(rebuilt.data()));
+    if (patchedTile.featureCount() != rebuiltTile.featureCount())
+    {
+        return Strings::combine("Patched tile ",
+            tile_.tile().toString(), " has a different number of features");
+    }
+
+    FeatureTable::Iterator iter = patchedTile.iterFeatures();
+    while (iter.hasNext())
+    {
+        TFeature* feature = iter.next();
+        TFeature* expected = rebuiltTile.getFeature(feature->typedId());
+        bool same = expected != nullptr;
+        if (same)
+        {
+            int32_t a = static_cast<int32_t>(feature->anchor());
+            const uint8_t* p = feature->feature().ptr() - a;
+            const uint8_t* pExpected = expected->feature().ptr() - a;
+            // Compare bounds (or coordinates), ID and flags, except the
+            // is_last flag, which depends on placement
+            same = a == static_cast<int32_t>(expected->anchor()) &&
+                memcmp(p, pExpected, a) == 0 &&
+                (DataPtr(p + a).getInt() & ~1) == (DataPtr(pExpected + a).getInt() & ~1) &&
+                DataPtr(p + a + 4).getInt() == DataPtr(pExpected + a + 4).getInt() &&
+                feature->tags(patchedTile)->toString(patchedTile) ==
+                    expected->tags(rebuiltTile)->toString(rebuiltTile);
+        }
+        if (!same)
+        {
+            return Strings::combine("Patched tile ",
+                tile_.tile().toString(), ": ", feature->typedId().toString(),
+                " differs from rebuilt tile");
+        }
+    }
+    return {};
+}
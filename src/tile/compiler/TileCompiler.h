@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <string>
 #include "geodesk/feature/FeatureStore.h"
 #include "tile/model/TileModel.h"
 
@@ -13,6 +14,7 @@ class FeatureStore;
 using namespace geodesk;
 
 struct TesArchiveEntry;
+class IndexSettings;
 
 class TileCompiler 
 {
@@ -33,7 +35,50 @@ public:
     void addChanges(const TesArchiveEntry& entry, const uint8_t* data);
     ByteBlock compile();
 
+    /// Whether the last compiled tile was patched rather than rebuilt
+    ///
+    bool wasPatched() const { return wasPatched_; }
+
+    /// If enabled, every patched tile is also rebuilt from scratch,
+    /// and compile() throws if the two tiles don't hold the same
+    /// features (this roughly doubles the cost of a patch, so it is
+    /// meant for testing only)
+    ///
+    void verifyPatches(bool b) { verifyPatches_ = b; }
+
+    /// The model of the tile being modified, which can be changed
+    /// directly instead of via addChanges() (used by gol bench)
+    ///
+    TileModel& tile() { return tile_; }
+
+    /// A modified tile is patched if the changes are limited to the
+    /// tags of at most this many features ...
+    ///
+    static constexpr size_t MAX_PATCHED_FEATURES = 256;
+
+    /// ... and the new tag tables and strings grow the tile by no more
+    /// than this percentage (The tag tables that are no longer used
+    /// stay in the tile until it is rebuilt)
+    ///
+    static constexpr uint32_t MAX_PATCH_GROWTH_PERCENT = 5;
+
 private:
+    enum class Change
+    {
+        NONE,       // feature is unchanged
+        TAGS,       // only the feature's tags have changed
+        OTHER       // requires a full rebuild
+    };
+
+    ByteBlock patch(const IndexSettings& indexSettings);
+    ByteBlock rebuild(const IndexSettings& indexSettings);
+    Change changeOf(TFeature* feature, const IndexSettings& indexSettings);
+    void resetLocations();
+    std::string verifyPatch(const ByteBlock& patched, const ByteBlock& rebuilt);
+
     FeatureStore* store_;
     TileModel tile_;
+    const TExportTable* sourceExports_ = nullptr;
+    bool wasPatched_ = false;
+    bool verifyPatches_ = false;
 };
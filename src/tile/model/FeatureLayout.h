@@ -0,0 +1,15 @@
+// Copyright (c) 2025 Clarisma / GeoDesk contributors
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#pragma once
+#include <cstdint>
+
+/// Where Layout places the bodies of features (way coordinates,
+/// member tables, relation tables) and the strings used by their
+/// tags. The tile format is the same either way.
+///
+enum class FeatureLayout : uint8_t
+{
+	COMPACT,	// after all spatial indexes
+	LOCAL		// right after the index leaf of their first user
+};
@@ -2,12 +2,18 @@
 // SPDX-License-Identifier: AGPL-3.0-only
 
 #include "Layout.h"
+#include <algorithm>
 #include "TIndex.h"
+#include "TIndexLeaf.h"
+#include "TFeature2D.h"
+#include "TRelationTable.h"
+#include "TTagTable.h"
 #include <clarisma/util/log.h>
 
-Layout::Layout(TileModel& tile) :
+Layout::Layout(TileModel& tile, FeatureLayout featureLayout) :
     pos_(4),
-    tile_(tile)
+    tile_(tile),
+    featureLayout_(featureLayout)
 {
 }
 
@@ -53,6 +59,70 @@ void Layout::flush()
     while (!deferred_.isEmpty()) put(deferred_.remove());
 }
 
+void Layout::placeAll(std::vector<TElement*>& elements)
+{
+    for (TElement* elem : elements) place(elem);
+    elements.clear();
+}
+
+void Layout::endLeaf(TIndexLeaf* leaf)
+{
+    // Strings first, since they are used by the tag tables
+    // that have just been placed
+    placeAll(leafStrings_);
+    placeAll(leafBodies_);
+#ifdef GOL_BUILD_STATS
+    if (collectPageStats_) leaves_.push_back(leaf);
+#endif
+}
+
+#ifdef GOL_BUILD_STATS
+Layout::PageStats Layout::pageStats() const
+{
+    PageStats stats;
+    std::vector<int32_t> pages;
+    auto addPages = [&pages](const TElement* elem)
+    {
+        if (!elem) return;
+        assert(elem->location() > 0);
+        int32_t end = elem->location() +
+            static_cast<int32_t>(std::max(elem->size(), 1u)) - 1;
+        for (int32_t page = elem->location() / PAGE_SIZE; page <= end / PAGE_SIZE; page++)
+        {
+            pages.push_back(page);
+        }
+    };
+
+    for (TIndexLeaf* leaf : leaves_)
+    {
+        pages.clear();
+        // The features of a leaf are placed consecutively,
+        // and the last is marked
+        TElement* elem = leaf->firstFeature();
+        for (;;)
+        {
+            TFeature* feature = static_cast<TFeature*>(elem);
+            addPages(feature);
+            addPages(feature->tags(tile_));
+            if (feature->isRelationMember())
+            {
+                addPages(feature->parentRelations(tile_));
+            }
+            if (feature->type() == TElement::Type::FEATURE2D)
+            {
+                addPages(static_cast<TFeature2D*>(feature)->body());
+            }
+            if (feature->isLast()) break;
+            elem = elem->next();
+        }
+        std::sort(pages.begin(), pages.end());
+        stats.leafCount++;
+        stats.leafPageCount += std::unique(pages.begin(), pages.end()) - pages.begin();
+    }
+    return stats;
+}
+#endif
+
 #ifdef _DEBUG
 void Layout::count(TElement* e)
 {
@@ -2,18 +2,32 @@
 // SPDX-License-Identifier: AGPL-3.0-only
 
 #pragma once
+#include <vector>
 #include <clarisma/data/FixedQueue.h>
+#include "FeatureLayout.h"
 #include "TileModel.h"
 
+class TIndexLeaf;
+
 class Layout
 {
 public:
-	explicit Layout(TileModel& tile);
+	explicit Layout(TileModel& tile, FeatureLayout featureLayout = FeatureLayout::COMPACT);
 
 	TileModel& tile() const { return tile_; }
+	FeatureLayout featureLayout() const { return featureLayout_; }
 	void place(TElement* elem);
 	void flush();
 
+	/// Places elements after an existing tile of the given size,
+	/// rather than at the start of a new tile
+	///
+	void startAt(int32_t pos)
+	{
+		assert(placed_.first() == nullptr);
+		pos_ = pos;
+	}
+
 	void put(TElement* elem)
 	{
 		put(elem, elem->alignedLocation(pos_));
@@ -25,12 +39,31 @@ public:
 	void addBodyElement(TElement* elem)
 	{
 		assert(elem->location() == 0);
-		bodies_.addTail(elem);
+		if (featureLayout_ == FeatureLayout::COMPACT)
+		{
+			bodies_.addTail(elem);
+		}
+		else if (elem->type() == TElement::Type::STRING)
+		{
+			leafStrings_.push_back(elem);
+		}
+		else
+		{
+			leafBodies_.push_back(elem);
+		}
 		elem->setLocation(-1);
 	}
 
+	/// Called once all features and tag tables of an index leaf have
+	/// been placed. For FeatureLayout::LOCAL, places the strings, then
+	/// the bodies that have been added since the previous leaf.
+	///
+	void endLeaf(TIndexLeaf* leaf);
+
 	void placeBodies()
 	{
+		placeAll(leafStrings_);
+		placeAll(leafBodies_);
 		TElement* elem = bodies_.first();
 		while (elem)
 		{
@@ -55,11 +88,45 @@ private:
 #endif
 	}
 
+	void placeAll(std::vector<TElement*>& elements);
+
 	TileModel& tile_;
 	LinkedQueue<TElement> placed_;
 	LinkedQueue<TElement> bodies_;
+	std::vector<TElement*> leafStrings_;
+	std::vector<TElement*> leafBodies_;
 	FixedQueue<TElement*, DEFERRED_QUEUESIZE> deferred_;
 	int32_t pos_;
+	FeatureLayout featureLayout_;
+
+#ifdef GOL_BUILD_STATS
+public:
+	/// The number of distinct pages that must be read to fetch all
+	/// features of a leaf, along with their tags and bodies (a proxy
+	/// for the page touches of a query that matches the leaf)
+	///
+	struct PageStats
+	{
+		int64_t leafCount = 0;
+		int64_t leafPageCount = 0;
+	};
+
+	/// Leaves are only recorded (and page stats only gathered) if
+	/// enabled before placing the indexes, since this is costly for
+	/// large tiles
+	///
+	void collectPageStats(bool b) { collectPageStats_ = b; }
+
+	/// Only valid once the layout is complete
+	///
+	PageStats pageStats() const;
+
+	static constexpr int PAGE_SIZE = 4096;
+
+private:
+	std::vector<TIndexLeaf*> leaves_;
+	bool collectPageStats_ = false;
+#endif
 
 #ifdef _DEBUG
 	void count(TElement* e);
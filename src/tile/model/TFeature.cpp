@@ -80,7 +80,14 @@ void TFeature::write(const TileModel& tile) const
 	p.putInt((p.getInt() & ~1) | (isLast() ? 1 : 0));
 		// set the is_last flag bit
 		// TODO: may change
-	p += 8;
+	writeTags(tile);
+}
+
+
+void TFeature::writeTags(const TileModel& tile) const
+{
+	int_fast32_t a = anchor();
+	MutableDataPtr p(tile.newTileData() + location() + a + 8);
 	TTagTable* tags = this->tags(tile);
 	p.putInt((tags->location() + tags->anchor() - 
 		location() - a - 8) | (tags->hasLocalTags() ? 1 : 0));
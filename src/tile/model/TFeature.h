@@ -60,6 +60,10 @@ public:
 
 	MutableFeaturePtr makeMutable(TileModel& tile);
 
+	/// Writes only the pointer to the feature's tag table
+	///
+	void writeTags(const TileModel& tile) const;
+
 	/// Returns a pointer to the prepended extra data of type T
 	/// (Allocated by createFeature)
 	/*
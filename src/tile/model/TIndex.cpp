@@ -7,7 +7,7 @@
 #include "TFeature.h"
 #include "TIndexTrunk.h"
 #include "TileModel.h"
-#include "tile/compiler/HilbertIndexBuilder.h"
+#include "tile/compiler/RTreeBuilder.h"
 #include "tile/compiler/IndexSettings.h"
 
 
@@ -60,7 +60,7 @@ void TIndex::Root::add(Root& other)
 }
 
 
-void TIndex::Root::build(HilbertIndexBuilder& rtreeBuilder)
+void TIndex::Root::build(RTreeBuilder& rtreeBuilder)
 {
 	trunk = rtreeBuilder.build(firstFeature, featureCount);
 }
@@ -72,7 +72,7 @@ void TIndex::build(TileModel& tile, const IndexSettings& settings)
 	int minFeaturesPerRoot = settings.keyIndexMinFeatures();
 
 	// LOG("Building index for tile %s", tile.tile().toString().c_str());
-	HilbertIndexBuilder rtreeBuilder(tile, settings.rtreeBucketSize());
+	RTreeBuilder rtreeBuilder(tile, settings);
 
 	// - Sort roots by number of features
 	// - Consolidate Roots with less features than minFeaturesPerRoot 
@@ -6,9 +6,9 @@
 #include "TElement.h"
 
 class FeatureTable;
-class HilbertIndexBuilder;
 class IndexSettings;
 class Layout;
+class RTreeBuilder;
 class TileModel;
 class TFeature;
 class TIndexTrunk;
@@ -50,7 +50,7 @@ private:
 		bool isEmpty() const { return featureCount == 0; }
 		void addFeature(TFeature* feature, uint32_t indexBits);
 		void add(Root& other);
-		void build(HilbertIndexBuilder& rtreeBuilder);
+		void build(RTreeBuilder& rtreeBuilder);
 	};
 
 	int getFeatureCategory(TFeature* feature);
@@ -23,7 +23,9 @@ uint32_t TIndexLeaf::calculateSize(TFeature* firstFeature)
 
 /**
  * Place the feature in this leaf branch, then place any uncommon tag tables
- * that haven't already been placed.
+ * that haven't already been placed. Depending on the FeatureLayout, the
+ * bodies and strings used by these features are placed right after the
+ * tag tables, or once all indexes have been placed.
  */
 void TIndexLeaf::place(Layout& layout)
 {
@@ -82,6 +84,7 @@ void TIndexLeaf::place(Layout& layout)
 		tags->placeStrings(layout);
 		tags = nextTags;
 	}
+	layout.endLeaf(this);
 
 	/*
 	// The location of the leaf branch is that of its first child
@@ -56,6 +56,7 @@ void TileModel::clear()
 	pNewTile_ = nullptr;
 	nextNewHandle_ = 4;
 	currentTileSize_ = 0;
+	tile_ = Tile();
 	arena_.clear();
 }
 
@@ -259,11 +260,31 @@ uint8_t* TileModel::write(Layout& layout)
 
 	pNewTile_ = new uint8_t[layout.size() + 8];
 		// TODO +4 should be enough!
-	MutableDataPtr p(pNewTile_);
-	p.putUnsignedInt(layout.size());
+	writeElements(layout.first());
+	seal(layout.size());
+	return pNewTile_;
+}
+
+
+uint8_t* TileModel::writePatch(Layout& layout, std::span<TFeature* const> retagged)
+{
+	uint32_t sourceSize = this->sourceSize();
+	assert(layout.size() >= static_cast<int32_t>(sourceSize));
+	pNewTile_ = new uint8_t[layout.size() + 8];
+	memcpy(pNewTile_, pCurrentTile_.ptr(), sourceSize);
+	writeElements(layout.first());
+	for (TFeature* feature : retagged)
+	{
+		feature->writeTags(*this);
+	}
+	seal(layout.size());
+	return pNewTile_;
+}
+
 
-	TElement* elem = layout.first();
-	do
+void TileModel::writeElements(TElement* elem)
+{
+	while (elem)
 	{
 		// LOG("%d: Type %d (%d bytes)", elem->location(), elem->type(), elem->size());
 		switch (elem->type())
@@ -305,17 +326,21 @@ uint8_t* TileModel::write(Layout& layout)
 		assert(elem->next() == nullptr || elem->location() + elem->size() <= elem->next()->location());
 		elem = elem->next();
 	}
-	while (elem);
+}
 
+
+void TileModel::seal(int32_t size)
+{
+	MutableDataPtr p(pNewTile_);
+	p.putUnsignedInt(size);
 	Crc32C checksum;
-	checksum.update(pNewTile_, layout.size());
-	(p + layout.size()).putUnsignedIntUnaligned(checksum.get());
+	checksum.update(pNewTile_, size);
+	(p + size).putUnsignedIntUnaligned(checksum.get());
 
 	if (!FeatureStore::isTileValid(reinterpret_cast<std::byte*>(pNewTile_)))
 	{
 		Console::debug("Checksum calculation error");
 	}
-	return pNewTile_;
 }
 
 
@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <span>
 #include <clarisma/alloc/Arena.h>
 #include <clarisma/util/log.h>
 #include <geodesk/feature/FeaturePtr.h>
@@ -22,8 +23,6 @@ class TRelation;
 using namespace clarisma;
 using namespace geodesk;
 
-// TODO: Allow reuse of TileModel?
-
 class TileModel
 {
 public:
@@ -36,7 +35,16 @@ public:
 		nextNewHandle_ = (currentTileSize_ + 3) & 0xffff'fffc;
 	}
 
+	/// Prepares the model for a tile. `tileSize` is the expected size
+	/// of the tile in its GOL encoding, which is used to size the
+	/// lookup tables (a rough estimate will do).
+	///
 	void init(Tile tile, size_t tileSize);
+
+	/// Discards all elements, so the model can be reused for another
+	/// tile. The arena keeps its memory, which saves workers from
+	/// allocating (and faulting in) fresh chunks for every tile.
+	///
 	void clear();
 	
 	TFeature* getFeature(TypedFeatureId typedId) const
@@ -163,6 +171,26 @@ public:
 	uint8_t* newTileData() const { return pNewTile_;	}
 	uint8_t* write(Layout& layout);
 
+	/// Writes a copy of the source tile, followed by the elements placed
+	/// by `layout` (which must start at sourceSize()), and points the
+	/// given features to their new tag tables. All other elements must
+	/// be unchanged and stay where they are in the source tile.
+	///
+	uint8_t* writePatch(Layout& layout, std::span<TFeature* const> retagged);
+
+	/// The source tile (if the model was populated by a TileReader)
+	///
+	TilePtr source() const { return pCurrentTile_; }
+
+	/// The size of the source tile, excluding its checksum; handles
+	/// of elements that were read from this tile are below this size
+	///
+	uint32_t sourceSize() const
+	{
+		return pCurrentTile_.ptr() ?
+			pCurrentTile_.ptr().getInt() & 0x3fff'ffff : 0;
+	}
+
 	/*
 	TElement::Handle existingHandle(DataPtr p) const
 	{
@@ -198,6 +226,9 @@ private:
 		featureCount_++;
 	}
 
+	void writeElements(TElement* first);
+	void seal(int32_t size);
+
 	// TString* addStringOrRollback(TString* str);
 
 	Arena arena_;
@@ -0,0 +1,691 @@
+// Copyright (c) 2025 Clarisma / GeoDesk contributors
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#include "BlobTesWriter.h"
+#include "TesFlags.h"
+#include <algorithm>
+#include <clarisma/util/ShortVarString.h>
+#include <clarisma/util/varint.h>
+#include <geodesk/feature/GlobalTagIterator.h>
+#include <geodesk/feature/LocalTagIterator.h>
+#include <geodesk/feature/MemberTableIterator.h>
+#include <geodesk/feature/NodeTableIterator.h>
+#include <geodesk/feature/RelationTableIterator.h>
+#include <geodesk/feature/TileConstants.h>
+
+// The structure of this class mirrors TesWriter (for writing) and
+// TileReader (for gathering); any change to the TES format or to
+// the way TileReader sizes elements must be made in all three.
+
+ByteBlock BlobTesWriter::write(Tile tile, TilePtr pTile)
+{
+	clear();
+	base_ = pTile;
+	prevXY_ = tile.bounds().bottomLeft();
+	readTileFeatures(pTile);
+	DataPtr exports = pTile + TileConstants::EXPORTS_OFS;
+	int32_t exportsRelPtr = exports.getInt();
+	if (exportsRelPtr) pExports_ = (exports + exportsRelPtr).ptr();
+
+	DynamicBuffer buf(1024 * 1024);
+	BufferWriter out(&buf);
+	for (int i = 0; i < TES_COLUMN_COUNT; i++)
+	{
+		if (columnar_)
+		{
+			if (!columnBuffers_[i])
+			{
+				columnBuffers_[i] = std::make_unique<DynamicBuffer>(64 * 1024);
+			}
+			columnWriters_[i] = std::make_unique<BufferWriter>(columnBuffers_[i].get());
+			columns_[i] = columnWriters_[i].get();
+		}
+		else
+		{
+			columns_[i] = &out;
+		}
+	}
+
+	writeFeatureIndex();
+	writeStrings();
+	writeTagTables();
+	writeRelationTables();
+	writeFeatures();
+	this->out(TesColumn::IDS).writeByte(0); // no removed features
+	writeExportTable();
+	if (columnar_) writeColumns(out);
+	out.flush();
+	return buf.takeBytes();
+}
+
+
+void BlobTesWriter::clear()
+{
+	pExports_ = nullptr;
+	nodeCount_ = 0;
+	wayCount_ = 0;
+	features_.clear();
+	strings_.clear();
+	tagTables_.clear();
+	relationTables_.clear();
+	stringIndex_.clear();
+	tagTableIndex_.clear();
+	relationTableIndex_.clear();
+	featureLocations_.clear();
+}
+
+
+BlobTesWriter::Feature& BlobTesWriter::addFeature(FeaturePtr feature, DataPtr pRelTable)
+{
+	uint32_t tags = addTagTable(feature.tags());
+	tagTables_[tags].users++;
+	int32_t relations = -1;
+	if (pRelTable.ptr())
+	{
+		relations = static_cast<int32_t>(addRelationTable(pRelTable));
+		relationTables_[relations].users++;
+	}
+	features_.push_back({ feature.id() |
+		(static_cast<uint64_t>(feature.typeCode()) << 60),
+		feature, tags, relations, 0, 0 });
+	return features_.back();
+}
+
+
+void BlobTesWriter::readNode(NodePtr node)
+{
+	addFeature(node, node.isRelationMember() ? node.bodyptr() : DataPtr());
+}
+
+
+void BlobTesWriter::readWay(WayPtr way)
+{
+	DataPtr pBody = way.bodyptr();
+	uint32_t relTablePtrSize = way.flags() & 4;
+	uint32_t anchor;
+	if (way.flags() & FeatureFlags::WAYNODE)
+	{
+		DataPtr pNode(pBody);
+		pNode -= relTablePtrSize;		// skip pointer to reltable (4 bytes)
+		for (;;)
+		{
+			pNode -= 2;
+			uint16_t wayNodeFlags = pNode.getUnsignedShort();
+			if (wayNodeFlags & MemberFlags::FOREIGN)
+			{
+				// move extra 2 bytes if wide-tex delta
+				pNode -= (wayNodeFlags & (1 << 3)) >> 2;
+				if (wayNodeFlags & (1 << 2))
+				{
+					// foreign node in different tile
+					pNode -= 2;
+					pNode -= (pNode.getShort() & 1) << 1;
+				}
+			}
+			else
+			{
+				pNode -= 2;		// local node is always 4 bytes
+			}
+			if (wayNodeFlags & MemberFlags::LAST) break;
+		}
+		anchor = static_cast<uint32_t>(pBody - pNode);
+	}
+	else
+	{
+		anchor = relTablePtrSize;
+	}
+
+	const uint8_t* p = pBody;
+	int nodeCount = readVarint32(p);
+	int valueCount = nodeCount * 2;
+	valueCount += wayNodeIds_ ? nodeCount : 0;
+		// 2 coordinate values, plus optional ID
+	skipVarints(p, valueCount);
+
+	Feature& feature = addFeature(way,
+		relTablePtrSize ? (pBody - 4).followUnaligned() : DataPtr());
+	feature.bodySize = static_cast<uint32_t>(p - pBody.ptr() + anchor);
+	feature.bodyAnchor = anchor;
+}
+
+
+void BlobTesWriter::readRelation(RelationPtr relation)
+{
+	DataPtr pBody = relation.bodyptr();
+	DataPtr p = pBody;
+	for (;;)
+	{
+		int memberFlags = p.getUnsignedShort();
+		if (memberFlags & MemberFlags::FOREIGN)
+		{
+			p += 2 + ((memberFlags & (1 << 4)) >> 3);
+			if (memberFlags & (1 << 3))
+			{
+				p += 2 + ((p.getShort() & 1) << 1);
+			}
+		}
+		else
+		{
+			p += 4;
+		}
+		if (memberFlags & MemberFlags::DIFFERENT_ROLE)
+		{
+			int32_t rawRole = p.getUnsignedShort();
+			if ((rawRole & 1) == 0) // local-string role?
+			{
+				rawRole = p.getIntUnaligned();
+				addString(p + (rawRole >> 1));   // signed
+				p += 2;
+			}
+			p += 2;
+		}
+		if (memberFlags & MemberFlags::LAST) break;
+	}
+
+	uint32_t size = p - pBody;
+	bool isMember = relation.flags() & FeatureFlags::RELATION_MEMBER;
+	Feature& feature = addFeature(relation,
+		isMember ? (pBody - 4).followUnaligned() : DataPtr());
+	feature.bodySize = size + (isMember ? 4 : 0);
+	feature.bodyAnchor = relation.flags() & 4;
+}
+
+
+void BlobTesWriter::addString(DataPtr p)
+{
+	auto [it, isNew] = stringIndex_.try_emplace(handleOf(p),
+		static_cast<uint32_t>(strings_.size()));
+	if (isNew) strings_.push_back({ handleOf(p), 0, -1, 0, 0 });
+	strings_[it->second].users++;
+}
+
+
+// Like TileReader::readTagTable(), does not add a user
+uint32_t BlobTesWriter::addTagTable(TagTablePtr pTagTable)
+{
+	DataPtr pTags = pTagTable.ptr();
+	Handle handle = handleOf(pTags);
+	auto it = tagTableIndex_.find(handle);
+	if (it != tagTableIndex_.end()) return it->second;
+
+	uint32_t anchor = 0;
+	if (pTagTable.hasLocalKeys())
+	{
+		DataPtr p = pTags;
+		DataPtr origin = p & 0xffff'ffff'ffff'fffcULL;
+		for (;;)
+		{
+			p -= 4;
+			int32_t key = p.getIntUnaligned();
+			int flags = key & 7;
+			addString(origin + ((key ^ flags) >> 1));
+			p -= 2 + (flags & 2);
+			if ((flags & 3) == 3) addString(p.followUnaligned());  // wide-string value
+			if (flags & 4) break;  // last-tag?
+		}
+		anchor = static_cast<uint32_t>(pTags - p);
+	}
+
+	DataPtr p = pTags;
+	for (;;)
+	{
+		uint16_t key = p.getUnsignedShort();
+		p += 2;
+		if ((key & 3) == 3) addString(p.followUnaligned());  // wide-string value
+		p += (key & 2) + 2;
+		if (key & 0x8000) break;	// last global key
+	}
+	uint32_t size = static_cast<uint32_t>(p - pTags + anchor);
+
+	uint32_t index = static_cast<uint32_t>(tagTables_.size());
+	tagTables_.push_back({ handle, 0, -1, size, anchor });
+	tagTableIndex_.emplace(handle, index);
+	return index;
+}
+
+
+// Does not add a user
+uint32_t BlobTesWriter::addRelationTable(DataPtr pTable)
+{
+	Handle handle = handleOf(pTable);
+	auto it = relationTableIndex_.find(handle);
+	if (it != relationTableIndex_.end()) return it->second;
+
+	RelationTableIterator iter(handle, RelationTablePtr(pTable));
+	while (iter.next()) {}
+	uint32_t size = DataPtr::nearDelta(iter.ptr() - pTable);
+
+	uint32_t index = static_cast<uint32_t>(relationTables_.size());
+	relationTables_.push_back({ handle, 0, -1, size, 0 });
+	relationTableIndex_.emplace(handle, index);
+	return index;
+}
+
+
+// Same order as TesWriter::gatherSharedItems()
+void BlobTesWriter::gatherSharedItems(std::vector<Item>& items, uint32_t minUsers,
+	size_t firstGroupSize, bool isString)
+{
+	assert (firstGroupSize == 127 || firstGroupSize == 63);
+	order_.clear();
+	for (uint32_t i = 0; i < items.size(); i++)
+	{
+		if (items[i].users >= minUsers) order_.push_back(i);
+	}
+
+	std::sort(order_.begin(), order_.end(),
+		[&items](uint32_t a, uint32_t b)
+		{
+			if (items[a].users != items[b].users)
+			{
+				return items[a].users > items[b].users;
+			}
+			return items[a].handle < items[b].handle;
+		});
+
+	if (isString)
+	{
+		auto compare = [this, &items](uint32_t a, uint32_t b)
+		{
+			const ShortVarString* strA = reinterpret_cast<const ShortVarString*>(
+				base_.ptr() + items[a].handle);
+			const ShortVarString* strB = reinterpret_cast<const ShortVarString*>(
+				base_.ptr() + items[b].handle);
+			if (ShortVarString::compare(strA, strB)) return true;
+			if (ShortVarString::compare(strB, strA)) return false;
+			return items[a].handle < items[b].handle;
+		};
+
+		size_t start = 0;
+		size_t end = std::min(firstGroupSize + 1, order_.size());
+		while (start < end)
+		{
+			std::sort(order_.begin() + start, order_.begin() + end, compare);
+			start = end;
+			end = std::min(end * 128, order_.size());
+		}
+	}
+
+	for (size_t i = 0; i < order_.size(); i++)
+	{
+		items[order_[i]].location = static_cast<int32_t>(i);
+	}
+}
+
+
+void BlobTesWriter::writeFeatureIndex()
+{
+	std::sort(features_.begin(), features_.end());
+
+	out(TesColumn::IDS).writeVarint(features_.size());
+	int prevType = 0;
+	uint64_t prevId = 0;
+	for (int i=0; i<features_.size(); i++)
+	{
+		const Feature& feature = features_[i];
+		int type = feature.typeCode();
+		if (type != prevType)
+		{
+			if (type == 1)
+			{
+				nodeCount_ = i;
+			}
+			else
+			{
+				assert(type == 2);
+				wayCount_ = i - nodeCount_;
+				if(prevType==0)
+				{
+					// Only relations follow the nodes
+					out(TesColumn::IDS).writeByte(0);
+				}
+			}
+			out(TesColumn::IDS).writeByte(0);
+			prevType = type;
+			prevId = 0;		// ID space starts over
+		}
+		uint64_t id = feature.id();
+		out(TesColumn::IDS).writeVarint(((id - prevId) << 1) | 1);
+			// Bit 0: changed_flag
+		prevId = id;
+		featureLocations_.emplace(handleOf(feature.ptr), i);
+	}
+}
+
+
+void BlobTesWriter::writeStrings()
+{
+	gatherSharedItems(strings_, 0, 127, true);
+	out(TesColumn::STRINGS).writeVarint(order_.size());
+	for (uint32_t index : order_)
+	{
+		const ShortVarString* s = reinterpret_cast<const ShortVarString*>(
+			base_.ptr() + strings_[index].handle);
+		out(TesColumn::STRINGS).writeBytes(s, s->totalSize());
+	}
+}
+
+
+void BlobTesWriter::writeTagTables()
+{
+	gatherSharedItems(tagTables_, 2, 127, false);
+	out(TesColumn::TAGS).writeVarint(order_.size());
+	for (uint32_t index : order_)
+	{
+		writeTagTable(tagTables_[index]);
+	}
+}
+
+
+void BlobTesWriter::writeRelationTables()
+{
+	gatherSharedItems(relationTables_, 2, 63, false);
+	out(TesColumn::MEMBERS).writeVarint(order_.size());
+	for (uint32_t index : order_)
+	{
+		writeRelationTable(relationTables_[index]);
+	}
+}
+
+
+void BlobTesWriter::writeStringValue(Handle handle)
+{
+	out(TesColumn::TAGS).writeVarint(stringLocation(handle));
+}
+
+
+void BlobTesWriter::writeTagTable(const Item& tags)
+{
+	bool hasLocalTags = tags.anchor != 0;
+	TagTablePtr pTags(base_ + tags.handle, hasLocalTags);
+	out(TesColumn::TAGS).writeVarint(tags.size | (hasLocalTags ? 1 : 0));
+	if (hasLocalTags)
+	{
+		out(TesColumn::TAGS).writeVarint(tags.anchor >> 1);
+		LocalTagIterator localTags(tags.handle, pTags);
+		while (localTags.next())
+		{
+			int32_t keyLocation = stringLocation(localTags.keyStringHandle());
+			out(TesColumn::TAGS).writeVarint((keyLocation << 2) | (localTags.flags() & 3));
+			if (localTags.hasLocalStringValue())
+			{
+				writeStringValue(localTags.stringValueHandleFast());
+			}
+			else
+			{
+				out(TesColumn::TAGS).writeVarint(localTags.value());
+			}
+		}
+	}
+
+	uint32_t prevKey = 0;
+	GlobalTagIterator globalTags(tags.handle, pTags);
+	while (globalTags.next())
+	{
+		uint32_t key = globalTags.key();
+		out(TesColumn::TAGS).writeVarint(((key - prevKey) << 2) | (globalTags.keyBits() & 3));
+		prevKey = key;
+		if (globalTags.hasLocalStringValue())
+		{
+			writeStringValue(globalTags.stringValueHandleFast());
+		}
+		else
+		{
+			out(TesColumn::TAGS).writeVarint(globalTags.value());
+		}
+	}
+}
+
+
+void BlobTesWriter::writeFeatures()
+{
+	for (const Feature& feature : features_)
+	{
+		switch (feature.typeCode())
+		{
+		case 0:
+			writeNode(feature);
+			break;
+		case 1:
+			writeWay(feature);
+			break;
+		case 2:
+			writeRelation(feature);
+			break;
+		}
+	}
+}
+
+
+void BlobTesWriter::writeStub(const Feature& feature, int flags)
+{
+	const Item& tags = tagTables_[feature.tags];
+	flags |= TesFlags::TAGS_CHANGED | TesFlags::GEOMETRY_CHANGED;
+	flags |= (tags.users > 1) ? TesFlags::SHARED_TAGS : 0;
+	flags |= (feature.relations >= 0) ? TesFlags::RELATIONS_CHANGED : 0;
+	out(TesColumn::FLAGS).writeByte(flags);
+
+	if (flags & TesFlags::SHARED_TAGS)
+	{
+		out(TesColumn::TAGS).writeVarint(tags.location);
+	}
+	else
+	{
+		writeTagTable(tags);
+	}
+
+	if (flags & TesFlags::RELATIONS_CHANGED)
+	{
+		const Item& rels = relationTables_[feature.relations];
+		if (rels.users > 1)
+		{
+			// number of a shared reltable, with marker flag
+			out(TesColumn::MEMBERS).writeVarint((rels.location << 1) | 1);
+		}
+		else
+		{
+			writeRelationTable(rels);
+		}
+	}
+}
+
+
+void BlobTesWriter::writeNode(const Feature& feature)
+{
+	NodePtr node(feature.ptr);
+	int flags = (node.flags() & FeatureFlags::WAYNODE) ?
+		TesFlags::NODE_BELONGS_TO_WAY : 0;
+	flags |= (node.flags() & FeatureFlags::SHARED_LOCATION) ?
+		TesFlags::HAS_SHARED_LOCATION : 0;
+	flags |= (node.flags() & FeatureFlags::EXCEPTION_NODE) ?
+		TesFlags::IS_EXCEPTION_NODE : 0;
+	writeStub(feature, flags);
+
+	Coordinate xy = node.xy();
+	out(TesColumn::COORDS).writeSignedVarint(static_cast<int64_t>(xy.x) - prevXY_.x);
+	out(TesColumn::COORDS).writeSignedVarint(static_cast<int64_t>(xy.y) - prevXY_.y);
+	prevXY_ = xy;
+}
+
+
+void BlobTesWriter::writeWay(const Feature& feature)
+{
+	WayPtr wayRef(feature.ptr);
+	bool hasFeatureNodes = (wayRef.flags() & FeatureFlags::WAYNODE);
+	int flags =
+		(hasFeatureNodes ? TesFlags::MEMBERS_CHANGED : 0) |
+		(wayRef.isArea() ? TesFlags::IS_AREA : 0) |
+		(wayNodeIds_ ? TesFlags::NODE_IDS_CHANGED : 0);
+	writeStub(feature, flags);
+
+	DataPtr pBody = wayRef.bodyptr();
+	int anchor = static_cast<int>(feature.bodyAnchor);
+	const uint8_t* p = pBody;
+	size_t coordSize = feature.bodySize - anchor;
+	int coordCount = readVarint32(p);
+
+	// See TesWriter::writeWay() for why we re-encode the first coordinate
+	Box bounds = wayRef.bounds();
+	int_fast32_t xDelta = readSignedVarint32(p);
+	int_fast32_t yDelta = readSignedVarint32(p);
+	Coordinate first(static_cast<int32_t>(bounds.minX() + xDelta),
+		static_cast<int32_t>(bounds.minY() + yDelta));
+
+	out(TesColumn::COORDS).writeVarint(coordCount);
+	out(TesColumn::COORDS).writeSignedVarint(static_cast<int64_t>(first.x) - prevXY_.x);
+	out(TesColumn::COORDS).writeSignedVarint(static_cast<int64_t>(first.y) - prevXY_.y);
+	prevXY_ = first;
+	coordSize -= p - pBody.ptr();
+	out(TesColumn::COORDS).writeBytes(p, coordSize);
+
+	if (hasFeatureNodes)
+	{
+		int skipReltablePointer = (wayRef.flags() & FeatureFlags::RELATION_MEMBER) ? 4 : 0;
+		out(TesColumn::MEMBERS).writeVarint(anchor - skipReltablePointer);
+
+		NodeTableIterator iter(handleOf(pBody) - skipReltablePointer,
+			pBody - skipReltablePointer);
+		while (iter.next())
+		{
+			if (iter.isForeign())
+			{
+				uint32_t zigzagTexDelta = toZigzag(iter.texDelta());
+				if (iter.isInDifferentTile())
+				{
+					out(TesColumn::MEMBERS).writeVarint((zigzagTexDelta << 2) | 3);
+					out(TesColumn::MEMBERS).writeSignedVarint(iter.tipDelta());
+				}
+				else
+				{
+					out(TesColumn::MEMBERS).writeVarint((zigzagTexDelta << 2) | 1);
+				}
+			}
+			else
+			{
+				out(TesColumn::MEMBERS).writeVarint(featureLocation(iter.localHandle()) << 1);
+			}
+		}
+	}
+}
+
+
+void BlobTesWriter::writeRelation(const Feature& feature)
+{
+	RelationPtr relationRef(feature.ptr);
+	int flags =
+		(relationRef.isArea() ? TesFlags::IS_AREA : 0) |
+		TesFlags::MEMBERS_CHANGED | TesFlags::BBOX_CHANGED;
+	writeStub(feature, flags);
+
+	const Box& bounds = relationRef.bounds();
+	out(TesColumn::COORDS).writeSignedVarint(static_cast<int64_t>(bounds.minX()) - prevXY_.x);
+	out(TesColumn::COORDS).writeSignedVarint(static_cast<int64_t>(bounds.minY()) - prevXY_.y);
+	out(TesColumn::COORDS).writeVarint(static_cast<uint64_t>(
+		static_cast<int64_t>(bounds.maxX()) - bounds.minX()));
+	out(TesColumn::COORDS).writeVarint(static_cast<uint64_t>(
+		static_cast<int64_t>(bounds.maxY()) - bounds.minY()));
+	prevXY_ = bounds.bottomLeft();
+
+	DataPtr pBody = relationRef.bodyptr();
+	out(TesColumn::MEMBERS).writeVarint(feature.bodySize - feature.bodyAnchor);
+
+	MemberTableIterator iter(handleOf(pBody), pBody);
+	while (iter.next())
+	{
+		int roleChangedFlag = iter.hasDifferentRole() ? 2 : 0;
+		if (iter.isForeign())
+		{
+			uint32_t zigzagTexDelta = toZigzag(iter.texDelta());
+			if (iter.isInDifferentTile())
+			{
+				out(TesColumn::MEMBERS).writeVarint((zigzagTexDelta << 3) | 5 | roleChangedFlag);
+				out(TesColumn::MEMBERS).writeSignedVarint(iter.tipDelta());
+			}
+			else
+			{
+				out(TesColumn::MEMBERS).writeVarint((zigzagTexDelta << 3) | 1 | roleChangedFlag);
+			}
+		}
+		else
+		{
+			out(TesColumn::MEMBERS).writeVarint(
+				(featureLocation(iter.localHandle()) << 2) | roleChangedFlag);
+		}
+		if (roleChangedFlag)
+		{
+			uint32_t roleValue;
+			if (iter.hasGlobalRole())
+			{
+				roleValue = (iter.globalRoleFast() << 1) | 1;
+			}
+			else
+			{
+				roleValue = stringLocation(iter.localRoleHandleFast()) << 1;
+			}
+			out(TesColumn::MEMBERS).writeVarint(roleValue);
+		}
+	}
+}
+
+
+void BlobTesWriter::writeRelationTable(const Item& relTable)
+{
+	out(TesColumn::MEMBERS).writeVarint(relTable.size);
+	RelationTableIterator iter(relTable.handle, RelationTablePtr(base_ + relTable.handle));
+	while (iter.next())
+	{
+		if (iter.isForeign())
+		{
+			uint32_t zigzagTexDelta = toZigzag(iter.texDelta());
+			if (iter.isInDifferentTile())
+			{
+				out(TesColumn::MEMBERS).writeVarint((zigzagTexDelta << 1) | 1);
+				out(TesColumn::MEMBERS).writeSignedVarint(iter.tipDelta());
+			}
+			else
+			{
+				out(TesColumn::MEMBERS).writeVarint((zigzagTexDelta << 1) | 0);
+			}
+		}
+		else
+		{
+			int relNumber = featureLocation(iter.localHandle()) - nodeCount_ - wayCount_;
+			out(TesColumn::MEMBERS).writeVarint(relNumber << 1);
+		}
+	}
+}
+
+
+void BlobTesWriter::writeExportTable()
+{
+	if (!pExports_)
+	{
+		out(TesColumn::IDS).writeByte(0);
+		return;
+	}
+	DataPtr p(pExports_);
+	uint32_t count = (p - 4).getUnsignedInt();
+	out(TesColumn::IDS).writeVarint(count << 1);
+	for (uint32_t i = 0; i < count; i++)
+	{
+		out(TesColumn::IDS).writeVarint(featureLocation(handleOf(p.follow())));
+		p += 4;
+	}
+}
+
+
+void BlobTesWriter::writeColumns(BufferWriter& out)
+{
+	ByteBlock columns[TES_COLUMN_COUNT];
+	out.writeVarint(TES_COLUMN_COUNT);
+	for (int i = 0; i < TES_COLUMN_COUNT; i++)
+	{
+		columnWriters_[i]->flush();
+		columns[i] = columnBuffers_[i]->takeBytes();
+		out.writeVarint(columns[i].size());
+	}
+	for (const ByteBlock& column : columns)
+	{
+		out.writeBytes(column.data(), column.size());
+	}
+}
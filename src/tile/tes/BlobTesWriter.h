@@ -0,0 +1,140 @@
+// Copyright (c) 2025 Clarisma / GeoDesk contributors
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <clarisma/alloc/Block.h>
+#include <clarisma/data/HashMap.h>
+#include <clarisma/util/Buffer.h>
+#include <clarisma/util/BufferWriter.h>
+#include <geodesk/geom/Coordinate.h>
+#include <geodesk/geom/Tile.h>
+#include "tile/model/TElement.h"
+#include "tile/model/TileReaderBase.h"
+#include "TesColumn.h"
+
+/// Encodes a tile as TES straight from its blob, without building
+/// a TileModel. The output is byte-for-byte the same as that of
+/// TileReader followed by TesWriter.
+///
+/// The tile is walked twice: the first pass gathers the features,
+/// strings, tag tables and relation tables (with their number of
+/// users), the second writes them. Elements are identified by their
+/// offset in the blob, which is the same handle TileReader assigns.
+///
+/// A writer can be reused for any number of tiles (but not by
+/// multiple threads at once).
+///
+class BlobTesWriter : public TileReaderBase<BlobTesWriter>
+{
+public:
+	using Handle = TElement::Handle;
+
+	void wayNodeIds(bool b) { wayNodeIds_ = b; }
+	void columnar(bool b) { columnar_ = b; }
+
+	ByteBlock write(Tile tile, TilePtr pTile);
+
+private:
+	struct Feature
+	{
+		uint64_t typeAndId;
+		FeaturePtr ptr;
+		uint32_t tags;			// index into tagTables_
+		int32_t relations;		// index into relationTables_, or -1
+		uint32_t bodySize;		// ways and relations only
+		uint32_t bodyAnchor;	// (same as TWayBody/TRelationBody)
+
+		uint64_t id() const { return typeAndId & 0xff'ffff'ffff'ffffULL; }
+		int typeCode() const { return static_cast<int>(typeAndId >> 60); }
+
+		bool operator<(const Feature& other) const
+		{
+			return typeAndId < other.typeAndId;
+		}
+	};
+
+	/// A string, tag table or relation table
+	///
+	struct Item
+	{
+		Handle handle;
+		uint32_t users;
+		int32_t location;		// -1 unless shared
+		uint32_t size;			// tables only
+		uint32_t anchor;		// tag tables only
+	};
+
+	void clear();
+	void readNode(NodePtr node);
+	void readWay(WayPtr way);
+	void readRelation(RelationPtr relation);
+	Feature& addFeature(FeaturePtr feature, DataPtr pRelTable);
+	void addString(DataPtr p);
+	uint32_t addTagTable(TagTablePtr pTagTable);
+	uint32_t addRelationTable(DataPtr pTable);
+	Handle handleOf(DataPtr p) const
+	{
+		return static_cast<Handle>(p.ptr() - base_.ptr());
+	}
+
+	void gatherSharedItems(std::vector<Item>& items, uint32_t minUsers,
+		size_t firstGroupSize, bool isString);
+	void writeFeatureIndex();
+	void writeStrings();
+	void writeTagTables();
+	void writeRelationTables();
+	void writeTagTable(const Item& tags);
+	void writeStringValue(Handle handle);
+	void writeRelationTable(const Item& relTable);
+	void writeFeatures();
+	void writeStub(const Feature& feature, int flags);
+	void writeNode(const Feature& feature);
+	void writeWay(const Feature& feature);
+	void writeRelation(const Feature& feature);
+	void writeExportTable();
+	void writeColumns(BufferWriter& out);
+
+	BufferWriter& out(TesColumn column)
+	{
+		return *columns_[static_cast<int>(column)];
+	}
+
+	int32_t featureLocation(Handle handle) const
+	{
+		auto it = featureLocations_.find(handle);
+		assert(it != featureLocations_.end());
+		return it->second;
+	}
+
+	int32_t stringLocation(Handle handle) const
+	{
+		auto it = stringIndex_.find(handle);
+		assert(it != stringIndex_.end());
+		return strings_[it->second].location;
+	}
+
+	bool wayNodeIds_ = false;
+	bool columnar_ = false;
+	TilePtr base_;
+	const uint8_t* pExports_ = nullptr;
+	Coordinate prevXY_;
+	int nodeCount_ = 0;
+	int wayCount_ = 0;
+	std::vector<Feature> features_;
+	std::vector<Item> strings_;
+	std::vector<Item> tagTables_;
+	std::vector<Item> relationTables_;
+	clarisma::HashMap<Handle,uint32_t> stringIndex_;
+	clarisma::HashMap<Handle,uint32_t> tagTableIndex_;
+	clarisma::HashMap<Handle,uint32_t> relationTableIndex_;
+	clarisma::HashMap<Handle,int32_t> featureLocations_;
+	std::vector<uint32_t> order_;		// used to sort shared items
+	BufferWriter* columns_[TES_COLUMN_COUNT];
+	std::unique_ptr<DynamicBuffer> columnBuffers_[TES_COLUMN_COUNT];
+	std::unique_ptr<BufferWriter> columnWriters_[TES_COLUMN_COUNT];
+
+	friend class TileReaderBase<BlobTesWriter>;
+};
@@ -37,4 +37,20 @@ std::unique_ptr<uint64_t[]> TesArchive::computeOffsets() const
     }
     assert(currentOfs == fileSize_);
     return offsets;
-}
\ No newline at end of file
+}
+
+uint32_t TesArchiveHeader::currentCompilerVersion()
+{
+    // GEODESK_GOL_VERSION is "major.minor.patch"
+    uint32_t parts[3] = {};
+    const char* p = GEODESK_GOL_VERSION;
+    for (int i = 0; i < 3; i++)
+    {
+        while (*p >= '0' && *p <= '9')
+        {
+            parts[i] = parts[i] * 10 + (*p++ - '0');
+        }
+        if (*p++ != '.') break;
+    }
+    return (parts[0] << 16) | (parts[1] << 8) | parts[2];
+}
@@ -16,9 +16,20 @@ enum class TesMetadataType
 	SETTINGS = 2,
 	TILE_INDEX = 3,
 	STRING_TABLE = 4,
-	INDEXED_KEYS = 5
+	INDEXED_KEYS = 5,
+	DELETED_TILES = 6	// TIPs (uint32_t each) of tiles removed since the base
 };
 
+/// The metadata sections of a complete Bundle (one bit per
+/// TesMetadataType); it must have all of these, and no others
+///
+constexpr int TES_METADATA_SECTIONS =
+	(1 << static_cast<int>(TesMetadataType::PROPERTIES)) |
+	(1 << static_cast<int>(TesMetadataType::SETTINGS)) |
+	(1 << static_cast<int>(TesMetadataType::TILE_INDEX)) |
+	(1 << static_cast<int>(TesMetadataType::STRING_TABLE)) |
+	(1 << static_cast<int>(TesMetadataType::INDEXED_KEYS));
+
 struct TesArchiveHeader
 {
 	static constexpr uint32_t MAGIC = 0xE0F6B060;	//	(60 B0 F6 E0) "gob of geo"
@@ -33,11 +44,59 @@ struct TesArchiveHeader
 	uint32_t revision = 0;
 	clarisma::DateTime revisionTimestamp;
 	uint32_t metadataChunkSize = 0;
-	uint32_t reserved[3] = {};
+	uint32_t codec = DEFLATE;
+	uint32_t dictionarySize = 0;
+	uint32_t compilerVersion = 0;	// gol that wrote the tiles (0 if unknown)
 
 	enum Flags
 	{
 		WAYNODE_IDS = 1 << 0,
+		COLUMNAR_TES = 1 << 1,	// tiles are version 3 TES (requires 2.1)
+
+		/// Only tiles changed since `baseRevision` (requires 2.1):
+		/// a delta holds only the tiles whose contents differ from
+		/// those of a complete Bundle of the same tileset, and a
+		/// DELETED_TILES metadata section listing the tiles that
+		/// are no longer present. A delta's metadata has no other
+		/// sections, since it can only be applied to an existing library.
+		///
+		/// Changes are detected via the uncompressed size and checksum
+		/// at the start of each tile's chunk, which is why a delta uses
+		/// the same TES flavor (WAYNODE_IDS, COLUMNAR_TES) as its base.
+		/// The checksums are only compared if the base was saved by the
+		/// same version of gol (`compilerVersion`), since the encoding of
+		/// a tile may change between releases.
+		///
+		DELTA = 1 << 2,
+
+		/// Tiles are blobs, not TES (requires 2.1): each tile is stored
+		/// in the binary format of the library it was saved from, so
+		/// loading it only takes uncompressing. This format may change
+		/// between releases, hence any version of gol other than
+		/// `compilerVersion` (see currentCompilerVersion()) has to
+		/// rebuild the tiles, which is as slow as loading TES.
+		///
+		COMPILED_TILES = 1 << 3,
+	};
+
+	/// Returns the version of this build of gol, as
+	/// `major << 16 | minor << 8 | patch`
+	///
+	static uint32_t currentCompilerVersion();
+
+	/// How the metadata and tiles are compressed. Archives that use
+	/// any codec other than DEFLATE (or any flag other than
+	/// WAYNODE_IDS) are written as version 2.1, so readers that
+	/// only know version 2.0 reject them.
+	///
+	/// For ZSTD, the catalog holds a dictionary (`dictionarySize`
+	/// bytes, between the entries and the catalog checksum) that
+	/// was trained on a sample of the archive's tiles.
+	///
+	enum Codec
+	{
+		DEFLATE = 0,
+		ZSTD = 1
 	};
 };
 
@@ -2,6 +2,8 @@
 // SPDX-License-Identifier: AGPL-3.0-only
 
 #include "TesArchiveWriter.h"
+#include <algorithm>
+#include <filesystem>
 #include <clarisma/util/Strings.h>
 #include <clarisma/zip/Zip.h>
 
@@ -18,12 +20,15 @@ TesArchiveWriter::TesArchiveWriter()
 
 
 void TesArchiveWriter::open(const char* fileName, const clarisma::UUID& guid, uint32_t revision,
-    DateTime timestamp, int tileCount, bool wayNodeIds)
+    DateTime timestamp, int tileCount, uint32_t flags,
+    TesArchiveHeader::Codec codec, std::span<const uint8_t> dictionary)
 {
+    assert(codec == TesArchiveHeader::ZSTD || dictionary.empty());
     fileName_ = fileName;
     tempFileName_ = Strings::combine(fileName, ".tmp");
-    catalogPayloadSize_ = sizeof(TesArchiveHeader) +
+    size_t entriesEnd = sizeof(TesArchiveHeader) +
         sizeof(TesArchiveEntry) * tileCount;
+    catalogPayloadSize_ = entriesEnd + dictionary.size();
     size_t catalogSize = catalogPayloadSize_ + sizeof(uint32_t);
     catalog_.reset(new byte[catalogSize]);
     out_.open(tempFileName_, File::OpenMode::CREATE |
@@ -33,13 +38,34 @@ void TesArchiveWriter::open(const char* fileName, const clarisma::UUID& guid, ui
     TesArchiveHeader* header = reinterpret_cast<TesArchiveHeader*>(catalog_.get());
     new (header) TesArchiveHeader();
     header->guid = guid;
-    header->flags = wayNodeIds ? TesArchiveHeader::Flags::WAYNODE_IDS : 0;
+    header->flags = flags;
     header->revision = revision;
     header->revisionTimestamp = timestamp;
     header->tileCount = tileCount;
+    if (codec != TesArchiveHeader::DEFLATE ||
+        (flags & ~TesArchiveHeader::Flags::WAYNODE_IDS))
+    {
+        header->formatVersionMinor = 1;
+        header->codec = codec;
+        header->dictionarySize = static_cast<uint32_t>(dictionary.size());
+        if (!dictionary.empty())
+        {
+            memcpy(catalog_.get() + entriesEnd, dictionary.data(), dictionary.size());
+        }
+    }
     pNextEntry_ = reinterpret_cast<TesArchiveEntry*>(catalog_.get() + sizeof(TesArchiveHeader));
     out_.seek(catalogSize);
-        // Skip Header, Entries, checksum
+        // Skip Header, Entries, dictionary, checksum
+}
+
+void TesArchiveWriter::setBaseRevision(uint32_t revision)
+{
+    reinterpret_cast<TesArchiveHeader*>(catalog_.get())->baseRevision = revision;
+}
+
+void TesArchiveWriter::setCompilerVersion(uint32_t version)
+{
+    reinterpret_cast<TesArchiveHeader*>(catalog_.get())->compilerVersion = version;
 }
 
 void TesArchiveWriter::writeMetadata(TileData&& data)
@@ -59,6 +85,14 @@ void TesArchiveWriter::writeTile(TileData&& data)
 
 void TesArchiveWriter::close()
 {
+    const TesArchiveEntry* pFirstEntry = reinterpret_cast<const TesArchiveEntry*>(
+        catalog_.get() + sizeof(TesArchiveHeader));
+    uint32_t tileCount = static_cast<uint32_t>(pNextEntry_ - pFirstEntry);
+    if (tileCount < reinterpret_cast<TesArchiveHeader*>(catalog_.get())->tileCount)
+    {
+        shrinkCatalog(tileCount);
+        return;
+    }
     uint32_t* pChecksum = reinterpret_cast<uint32_t*>(catalog_.get() + catalogPayloadSize_);
     *pChecksum = Crc32C::compute(catalog_.get(), catalogPayloadSize_);
     out_.writeAllAt(0, catalog_.get(), catalogPayloadSize_ + sizeof(uint32_t));
@@ -69,6 +103,43 @@ void TesArchiveWriter::close()
     tempFileName_.clear();
 }
 
+// Fewer tiles than reserved were written, so we shift the metadata
+// and tiles down to close the gap behind the last entry
+void TesArchiveWriter::shrinkCatalog(uint32_t tileCount)
+{
+    TesArchiveHeader* header = reinterpret_cast<TesArchiveHeader*>(catalog_.get());
+    uint64_t reservedSize = catalogPayloadSize_ + sizeof(uint32_t);
+    memmove(pNextEntry_, catalog_.get() + catalogPayloadSize_ - header->dictionarySize,
+        header->dictionarySize);
+    header->tileCount = tileCount;
+    catalogPayloadSize_ = static_cast<uint32_t>(sizeof(TesArchiveHeader) +
+        sizeof(TesArchiveEntry) * tileCount + header->dictionarySize);
+    uint32_t* pChecksum = reinterpret_cast<uint32_t*>(catalog_.get() + catalogPayloadSize_);
+    *pChecksum = Crc32C::compute(catalog_.get(), catalogPayloadSize_);
+    uint64_t catalogSize = catalogPayloadSize_ + sizeof(uint32_t);
+    uint64_t bodySize = out_.size() - reservedSize;
+
+    File in;
+    in.open(tempFileName_, File::OpenMode::READ);
+    in.seek(reservedSize);
+    constexpr size_t BUFFER_SIZE = 4 * 1024 * 1024;
+    std::unique_ptr<uint8_t[]> buf(new uint8_t[BUFFER_SIZE]);
+    for (uint64_t ofs = 0; ofs < bodySize; ofs += BUFFER_SIZE)
+    {
+        size_t chunkSize = static_cast<size_t>(std::min<uint64_t>(bodySize - ofs, BUFFER_SIZE));
+        in.readAll(buf.get(), chunkSize);
+        out_.writeAllAt(catalogSize + ofs, buf.get(), chunkSize);
+    }
+    in.close();
+    out_.writeAllAt(0, catalog_.get(), catalogSize);
+    out_.force();
+    out_.close();
+    std::filesystem::resize_file(tempFileName_, catalogSize + bodySize);
+    File::rename(tempFileName_.c_str(), fileName_);
+    fileName_ = nullptr;
+    tempFileName_.clear();
+}
+
 TileData TesArchiveWriter::createTes(Tip tip, clarisma::ByteBlock&& block)
 {
     ByteBlock compressed = Zip::deflateRaw(block);
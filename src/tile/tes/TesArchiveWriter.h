@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: AGPL-3.0-only
 
 #pragma once
+#include <span>
 #include <clarisma/alloc/Block.h>
 #include <clarisma/io/File.h>
 #include <clarisma/util/DateTime.h>
@@ -11,8 +12,19 @@
 class TesArchiveWriter 
 {
 public:
+    /// Creates the archive. `flags` are TesArchiveHeader::Flags.
+    /// For TesArchiveHeader::ZSTD, `dictionary` is stored in the
+    /// catalog (it may be empty).
+    ///
+    /// `tileCount` is the maximum number of tiles; if fewer are
+    /// written (as in a delta), close() shrinks the catalog.
+    ///
     void open(const char* fileName, const clarisma::UUID& guid, uint32_t revision,
-        clarisma::DateTime timestamp, int tileCount, bool wayNodeIds);
+        clarisma::DateTime timestamp, int tileCount, uint32_t flags,
+        TesArchiveHeader::Codec codec = TesArchiveHeader::DEFLATE,
+        std::span<const uint8_t> dictionary = {});
+    void setBaseRevision(uint32_t revision);
+    void setCompilerVersion(uint32_t version);
     void writeMetadata(TileData&& data);
     void writeTile(TileData&& data);
     void close();
@@ -20,6 +32,8 @@ public:
     static TileData createTes(Tip tip, clarisma::ByteBlock&& block);
 
 private:
+    void shrinkCatalog(uint32_t tileCount);
+
     std::unique_ptr<std::byte> catalog_;
     TesArchiveEntry* pNextEntry_ = nullptr;
     uint32_t catalogPayloadSize_ = 0;
@@ -0,0 +1,34 @@
+// Copyright (c) 2025 Clarisma / GeoDesk contributors
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#pragma once
+
+/// The columns of a columnar (version 3) TES. The fields are the
+/// same as in a version 2 TES, but instead of interleaving them
+/// feature by feature, each kind goes into its own column, so the
+/// compressor sees long runs of similar data:
+///
+/// - IDS: the feature index (delta-coded IDs), removed features
+///   and exports
+/// - STRINGS: the shared strings
+/// - TAGS: tag tables and references to shared tag tables
+/// - FLAGS: the change flags of each feature
+/// - COORDS: node coordinates, way geometries (zigzag deltas)
+///   and relation bounds
+/// - MEMBERS: way-node tables, member tables and relation tables
+///
+/// A columnar TES starts with the number of columns, followed by
+/// the size of each column (all varints), followed by the columns
+/// themselves in the order listed above.
+///
+enum class TesColumn
+{
+	IDS,
+	STRINGS,
+	TAGS,
+	FLAGS,
+	COORDS,
+	MEMBERS
+};
+
+constexpr int TES_COLUMN_COUNT = 6;
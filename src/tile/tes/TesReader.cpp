@@ -32,10 +32,16 @@ TesReader::TesReader(TileModel& tile) :
 }
 
 
-void TesReader::read(const uint8_t* data, size_t size)
+void TesReader::read(const uint8_t* data, size_t size, bool columnar)
 {
 	p_ = data;
 	// TODO: set size so we can check against overruns
+	for (int i = 0; i < TES_COLUMN_COUNT; i++)
+	{
+		cursors_[i] = &p_;
+		ends_[i] = data + size;
+	}
+	if (columnar) readColumns(data, size);
 	readFeatureIndex();
 	readStrings();
 	readTagTables();
@@ -46,9 +52,53 @@ void TesReader::read(const uint8_t* data, size_t size)
 }
 
 
+void TesReader::readColumns(const uint8_t* data, size_t size)
+{
+	const uint8_t* end = data + size;
+	uint32_t columnCount = readVarint32(p_);
+	if (columnCount < TES_COLUMN_COUNT || columnCount > 64)
+	{
+		invalid("Expected %d columns instead of %d", TES_COLUMN_COUNT, columnCount);
+	}
+	uint32_t columnSizes[TES_COLUMN_COUNT];
+	for (uint32_t i = 0; i < columnCount; i++)
+	{
+		uint32_t columnSize = readVarint32(p_);
+		if (i < TES_COLUMN_COUNT) columnSizes[i] = columnSize;
+			// ignore any columns added by later versions
+	}
+	const uint8_t* p = p_;
+	for (int i = 0; i < TES_COLUMN_COUNT; i++)
+	{
+		if (columnSizes[i] > end - p)
+		{
+			invalid("Column %d exceeds the size of the TES", i);
+		}
+		columns_[i] = p;
+		cursors_[i] = &columns_[i];
+		p += columnSizes[i];
+		ends_[i] = p;
+	}
+}
+
+
+void TesReader::verifyFullyRead()
+{
+	for (int i = 0; i < TES_COLUMN_COUNT; i++)
+	{
+		if (*cursors_[i] != ends_[i])
+		{
+			// (negative if we read past the end)
+			invalid("Column %d has %lld unread bytes", i,
+				static_cast<long long>(ends_[i] - *cursors_[i]));
+		}
+	}
+}
+
+
 void TesReader::readFeatureIndex()
 {
-	featureCount_ = readVarint32(p_);
+	featureCount_ = readVarint32(in(TesColumn::IDS));
 	features_[0] = tile_.arena().allocArray<TaggedPtr<TFeature, 1>>(featureCount_);
 	TaggedPtr<TFeature, 1>* end = features_[0] + featureCount_;
 	features_[1] = end;		// in case there are no ways
@@ -58,7 +108,7 @@ void TesReader::readFeatureIndex()
 	uint64_t prevId = 0;
 	while (ppFeature < end)
 	{
-		uint64_t ref = readVarint64(p_);
+		uint64_t ref = readVarint64(in(TesColumn::IDS));
 		if (ref == 0)
 		{
 			type++;
@@ -92,7 +142,7 @@ void TesReader::readFeatureIndex()
 
 void TesReader::readStrings()
 {
-	stringCount_ = readVarint32(p_);
+	stringCount_ = readVarint32(in(TesColumn::STRINGS));
 	strings_ = tile_.arena().allocArray<TString*>(stringCount_);
 	for (uint32_t i = 0; i < stringCount_; i++)
 	{
@@ -103,25 +153,25 @@ void TesReader::readStrings()
 
 TString* TesReader::readString()
 {
-	const ShortVarString* s = reinterpret_cast<const ShortVarString*>(p_);
+	const ShortVarString* s = reinterpret_cast<const ShortVarString*>(in(TesColumn::STRINGS));
 	uint32_t size = s->totalSize();
 	TString* str = tile_.addString(s->toStringView());
 	// LOG("STRING \"%s\"", reinterpret_cast<const ShortVarString*>(p_)->toString().c_str());
-	p_ += size;
+	in(TesColumn::STRINGS) += size;
 	return str;
 }
 
 
 TTagTable* TesReader::readTagTable()
 {
-	uint32_t taggedSize = readVarint32(p_);
+	uint32_t taggedSize = readVarint32(in(TesColumn::TAGS));
 	uint32_t size = taggedSize & 0xffff'fffe;
 	uint32_t localTagsSize = 0;
 	bool needsFixup = false;
 	if (taggedSize & 1) // has local keys
 	{
 		needsFixup = true;
-		localTagsSize = readVarint32(p_) << 1;
+		localTagsSize = readVarint32(in(TesColumn::TAGS)) << 1;
 		if (localTagsSize > size - 4)
 		{
 			invalid("Size of locals(% d) too large for tag - table size % d",
@@ -135,7 +185,7 @@ TTagTable* TesReader::readTagTable()
 	DataPtr pEnd = tags->data() - localTagsSize;
 	while (writer.ptr() != pEnd)
 	{
-		uint32_t keyBits = readVarint32(p_);
+		uint32_t keyBits = readVarint32(in(TesColumn::TAGS));
 		TString* keyString = getString(keyBits >> 2);
 		keyString->setAlignment(TElement::Alignment::DWORD);
 
@@ -145,7 +195,7 @@ TTagTable* TesReader::readTagTable()
 		// 4-byte aligned), we will miss such an aligned key
 		// Need a separate lookup table
 
-		uint32_t value = readVarint32(p_);
+		uint32_t value = readVarint32(in(TesColumn::TAGS));
 		int valueFlags = keyBits & 3;
 		if (valueFlags == 3)
 		{
@@ -163,10 +213,10 @@ TTagTable* TesReader::readTagTable()
 	do
 	{
 		// key is delta-coded
-		uint32_t keyBits = readVarint32(p_) + prevKeyShifted;
+		uint32_t keyBits = readVarint32(in(TesColumn::TAGS)) + prevKeyShifted;
 		prevKeyShifted = keyBits & 0xfffc;
 		int valueFlags = keyBits & 3;
-		uint32_t value = readVarint32(p_);
+		uint32_t value = readVarint32(in(TesColumn::TAGS));
 		if(valueFlags == 3)
 		{
 			writer.writeGlobalTag(keyBits >> 2, getString(value));
@@ -186,7 +236,7 @@ TTagTable* TesReader::readTagTable()
 
 void TesReader::readTagTables()
 {
-	sharedTagTableCount_ = readVarint32(p_);
+	sharedTagTableCount_ = readVarint32(in(TesColumn::TAGS));
 	tagTables_ = tile_.arena().allocArray<TTagTable*>(sharedTagTableCount_);
 	for (uint32_t i = 0; i < sharedTagTableCount_; i++)
 	{
@@ -198,7 +248,7 @@ void TesReader::readTagTables()
 
 TRelationTable* TesReader::readRelationTable()
 {
-	uint32_t size = readVarint32(p_);
+	uint32_t size = readVarint32(in(TesColumn::MEMBERS));
 	return readRelationTableContents(size);
 }
 
@@ -211,11 +261,11 @@ TRelationTable* TesReader::readRelationTableContents(uint32_t size)
 	bool needsFixup = false;
 	do
 	{
-		uint32_t rel = readVarint32(p_);
+		uint32_t rel = readVarint32(in(TesColumn::MEMBERS));
 		if (rel & 1)
 		{
 			// different tile
-			TipDelta tipDelta = readSignedVarint32(p_);
+			TipDelta tipDelta = readSignedVarint32(in(TesColumn::MEMBERS));
 			TexDelta texDelta = fromZigzag(rel >> 1);
 			isForeign = true;
 				// In a RelationTable, local relations always come first;
@@ -246,7 +296,8 @@ TRelationTable* TesReader::readRelationTableContents(uint32_t size)
 
 void TesReader::readRelationTables()
 {
-	uint32_t count = readVarint32(p_);
+	uint32_t count = readVarint32(in(TesColumn::MEMBERS));
+	sharedRelationTableCount_ = count;
 	LOGS << "Reading " << count << " relation tables.";
 	relationTables_ = tile_.arena().allocArray<TRelationTable*>(count);
 	for (uint32_t i = 0; i < count; i++)
@@ -297,13 +348,13 @@ uint32_t TesReader::readFeatureChange(TFeature* f, TRelationTable** pRels)
 	// LOGS << "Reading stub for " << f->typedId();
 	MutableFeaturePtr pFeature = f->makeMutable(tile_);
 	
-	uint32_t flags = *p_++;
+	uint32_t flags = *in(TesColumn::FLAGS)++;
 	if (flags & TesFlags::TAGS_CHANGED)
 	{
 		TTagTable* tags;
 		if (flags & TesFlags::SHARED_TAGS)
 		{
-			tags = getTagTable(readVarint32(p_));
+			tags = getTagTable(readVarint32(in(TesColumn::TAGS)));
 		}
 		else
 		{
@@ -330,7 +381,7 @@ uint32_t TesReader::readFeatureChange(TFeature* f, TRelationTable** pRels)
 	*pRels = nullptr;
 	if (flags & TesFlags::RELATIONS_CHANGED)
 	{
-		uint32_t relsSizeOrRef = readVarint32(p_);
+		uint32_t relsSizeOrRef = readVarint32(in(TesColumn::MEMBERS));
 		if (relsSizeOrRef != 0)	// 0 means feature no longer has a reltable
 		{
 			if (relsSizeOrRef & 1)
@@ -368,8 +419,8 @@ Coordinate TesReader::readCoordinate(Coordinate prev)
 {
 	// Read deltas first, because eval order of the args passed to Coordinate
 	// constructor is unspecified
-	int64_t xDelta = readSignedVarint64(p_);
-	int64_t yDelta = readSignedVarint64(p_);
+	int64_t xDelta = readSignedVarint64(in(TesColumn::COORDS));
+	int64_t yDelta = readSignedVarint64(in(TesColumn::COORDS));
 	return Coordinate(static_cast<int32_t>(static_cast<int64_t>(prev.x) + xDelta),
 		static_cast<int32_t>(static_cast<int64_t>(prev.y) + yDelta));
 }
@@ -385,8 +436,8 @@ Coordinate TesReader::readFirstCoordinate()
 Box TesReader::readBounds()
 {
 	Coordinate bottomLeft = readFirstCoordinate();
-	uint64_t w = readVarint64(p_);
-	uint64_t h = readVarint64(p_);
+	uint64_t w = readVarint64(in(TesColumn::COORDS));
+	uint64_t h = readVarint64(in(TesColumn::COORDS));
 	return Box(bottomLeft.x, bottomLeft.y,
 		static_cast<int32_t>(static_cast<int64_t>(bottomLeft.x) + w),
 		static_cast<int32_t>(static_cast<int64_t>(bottomLeft.y) + h));
@@ -485,11 +536,11 @@ void TesReader::readWayChange(TWay* way)
 
 	if (flags & TesFlags::GEOMETRY_CHANGED)
 	{
-		uint32_t coordCount = readVarint32(p_);
+		uint32_t coordCount = readVarint32(in(TesColumn::COORDS));
 		// LOG("Prev coord = %d, %d", prevXY_.x, prevXY_.y);
 		Coordinate first = readFirstCoordinate();
 		// LOG("1st coord = %d, %d", first.x, first.y);
-		pCoords = p_;
+		pCoords = in(TesColumn::COORDS);
 		Box bounds(first);
 		Coordinate node = first;
 		for (int i = 1; i < coordCount; i++)	// We don't start at 0 because we already have the 1st coord
@@ -500,9 +551,9 @@ void TesReader::readWayChange(TWay* way)
 
 		if (flags & TesFlags::NODE_IDS_CHANGED)
 		{
-			pNodeIds = p_;
-			skipVarints(p_, coordCount);
-			coordsSize = (tile_.wayNodeIds() ? p_ : pNodeIds) - pCoords;
+			pNodeIds = in(TesColumn::COORDS);
+			skipVarints(in(TesColumn::COORDS), coordCount);
+			coordsSize = (tile_.wayNodeIds() ? in(TesColumn::COORDS) : pNodeIds) - pCoords;
 			// We advance the pointer so IDs will be copied along with
 			// the coords (no need to set pNodeIds/nodeIdsSize)
 		}
@@ -527,7 +578,7 @@ void TesReader::readWayChange(TWay* way)
 				nodeIdsSize = pOldCoords - pNodeIds;
 				// Now pNodeIds/nodeIdsSize are set to the old node IDs
 			}
-			coordsSize = p_ - pCoords;
+			coordsSize = in(TesColumn::COORDS) - pCoords;
 		}
 
 		uint8_t* pNew = countAndFirst;
@@ -585,7 +636,7 @@ void TesReader::readWayChange(TWay* way)
 	if (flags & TesFlags::MEMBERS_CHANGED)
 	{
 		// Node Table will be built using data from the TES
-		memberTableSize = readVarint32(p_);
+		memberTableSize = readVarint32(in(TesColumn::MEMBERS));
 		if (memberTableSize == 0)
 		{
 			// The way no longer has a node table
@@ -678,7 +729,7 @@ bool TesReader::readWayNodeTable(TElement::Handle handle, uint8_t* pTable, uint3
 		// Remember, node table is built backwards!
 	while (writer.ptr() > end)
 	{
-		uint32_t node = readVarint32(p_);
+		uint32_t node = readVarint32(in(TesColumn::MEMBERS));
 		if (node & 1)
 		{
 			// foreign node
@@ -686,7 +737,7 @@ bool TesReader::readWayNodeTable(TElement::Handle handle, uint8_t* pTable, uint3
 			if (node & 2)
 			{
 				// different tile
-				TipDelta tipDelta = readSignedVarint32(p_);
+				TipDelta tipDelta = readSignedVarint32(in(TesColumn::MEMBERS));
 				writer.writeForeignNode(tipDelta, texDelta);
 			}
 			else
@@ -734,7 +785,7 @@ void TesReader::readRelationChange(TRelation* rel)
 
 	if (flags & TesFlags::MEMBERS_CHANGED)
 	{
-		tableSize = readVarint32(p_); 	// TODO: multiple by 2?
+		tableSize = readVarint32(in(TesColumn::MEMBERS)); 	// TODO: multiple by 2?
 		assert((tableSize % 2) == 0);		// TODO: may change
 	}
 	else
@@ -776,7 +827,7 @@ void TesReader::readRelationChange(TRelation* rel)
 		DataPtr end = writer.ptr() + tableSize;
 		while (writer.ptr() < end)
 		{
-			uint32_t member = readVarint32(p_);
+			uint32_t member = readVarint32(in(TesColumn::MEMBERS));
 			int roleChangeFlag = (member & 2) ? MemberFlags::DIFFERENT_ROLE : 0;
 			if (member & 1)
 			{
@@ -785,7 +836,7 @@ void TesReader::readRelationChange(TRelation* rel)
 				if (member & 4)
 				{
 					// different tile
-					TipDelta tipDelta = readSignedVarint32(p_);
+					TipDelta tipDelta = readSignedVarint32(in(TesColumn::MEMBERS));
 					writer.writeForeignMember(tipDelta, texDelta, roleChangeFlag);
 				}
 				else
@@ -801,7 +852,7 @@ void TesReader::readRelationChange(TRelation* rel)
 			}
 			if (roleChangeFlag)
 			{
-				uint32_t role = readVarint32(p_);
+				uint32_t role = readVarint32(in(TesColumn::MEMBERS));
 				if (role & 1)
 				{
 					writer.writeGlobalRole(role >> 1);
@@ -833,7 +884,7 @@ void TesReader::readRelationChange(TRelation* rel)
 TString* TesReader::getString(int number) const
 {
 	// #ifdef GEODESK_SAFE
-	if (number > stringCount_)
+	if (number >= stringCount_)
 	{
 		invalid("String #%d exceeds range (%d strings)", number, stringCount_);
 	}
@@ -844,7 +895,7 @@ TString* TesReader::getString(int number) const
 TTagTable* TesReader::getTagTable(int number) const
 {
 	// #ifdef GEODESK_SAFE
-	if (number > sharedTagTableCount_)
+	if (number >= sharedTagTableCount_)
 	{
 		invalid("Tagtable #%d exceeds range (%d tagtables)", number, sharedTagTableCount_);
 	}
@@ -854,7 +905,11 @@ TTagTable* TesReader::getTagTable(int number) const
 
 TRelationTable* TesReader::getRelationTable(int number) const
 {
-	// TODO: SAFE check range
+	if (number >= sharedRelationTableCount_)
+	{
+		invalid("Relation table #%d exceeds range (%d relation tables)",
+			number, sharedRelationTableCount_);
+	}
 	return relationTables_[number];
 }
 
@@ -907,12 +962,12 @@ TRelation* TesReader::getRelation(int number) const
 
 void TesReader::readRemovedFeatures()
 {
-	uint32_t count = readVarint32(p_);
+	uint32_t count = readVarint32(in(TesColumn::IDS));
 	int type = 0;
 	uint64_t prevId = 0;
 	while(count)
 	{
-		uint64_t ref = readVarint64(p_);
+		uint64_t ref = readVarint64(in(TesColumn::IDS));
 		if (ref == 0)
 		{
 			type++;
@@ -934,14 +989,14 @@ void TesReader::readRemovedFeatures()
 
 void TesReader::readExports()
 {
-	uint32_t taggedCount = readVarint32(p_);
+	uint32_t taggedCount = readVarint32(in(TesColumn::IDS));
 	uint32_t count = taggedCount >> 1;
 	if(count)
 	{
 		TFeature** features = tile_.arena().allocArray<TFeature*>(count);
 		for(int i=0; i<count; i++)
 		{
-			uint32_t ref = readVarint32(p_);
+			uint32_t ref = readVarint32(in(TesColumn::IDS));
 			features[i] = getFeature(ref);
 		}
 		tile_.createExportTable(features, nullptr, count);
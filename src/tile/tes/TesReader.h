@@ -6,6 +6,7 @@
 #include <clarisma/util/log.h>
 #include <clarisma/util/MutableDataPtr.h>
 #include <clarisma/util/TaggedPtr.h>
+#include "TesColumn.h"
 #include "TesException.h"
 #include "tile/model/MutableFeaturePtr.h"
 #include "tile/model/TileModel.h"
@@ -15,9 +16,20 @@ class TesReader
 {
 public:
 	explicit TesReader(TileModel& tile);
-	void read(const uint8_t* data, size_t size);
+
+	/// Reads a version 2 TES or, if `columnar` is set,
+	/// a version 3 TES (see TesColumn)
+	///
+	void read(const uint8_t* data, size_t size, bool columnar = false);
+
+	/// Throws unless read() consumed the TES exactly (every
+	/// column, if columnar) -- a stricter check than the loader
+	/// needs, used by `gol check`
+	///
+	void verifyFullyRead();
 
 private:
+	void readColumns(const uint8_t* data, size_t size);
 	void readFeatureIndex();
 	TString* readString();
 	void readStrings();
@@ -50,7 +62,6 @@ private:
 	template <typename... Args>
 	static void invalid(const char* message, Args... args) 
 	{
-		printf(message, args...);
 		throw TesException(message, args...);
 	}
 
@@ -63,8 +74,18 @@ private:
 		uint32_t newSize;
 	};
 
+	/// The read position within the given column
+	///
+	const uint8_t*& in(TesColumn column)
+	{
+		return *cursors_[static_cast<int>(column)];
+	}
+
 	TileModel& tile_;
 	const uint8_t* p_;
+	const uint8_t* columns_[TES_COLUMN_COUNT];
+	const uint8_t** cursors_[TES_COLUMN_COUNT];	// all &p_ unless columnar
+	const uint8_t* ends_[TES_COLUMN_COUNT];
 	TString** strings_;
 	TTagTable** tagTables_;
 	TRelationTable** relationTables_;
@@ -3,6 +3,7 @@
 
 #include "TesWriter.h"
 #include "TesFlags.h"
+#include <clarisma/alloc/Block.h>
 #include <geodesk/feature/GlobalTagIterator.h>
 #include <geodesk/feature/LocalTagIterator.h>
 #include <geodesk/feature/MemberTableIterator.h>
@@ -20,13 +21,26 @@
 // - fix gatherSharedItems() -- wrong minimums
 // - write shared reltables
 
-TesWriter::TesWriter(TileModel& tile, Buffer* out) :
+TesWriter::TesWriter(TileModel& tile, Buffer* out, bool columnar) :
 	tile_(tile),
 	out_(out),
 	prevXY_(tile.bounds().bottomLeft()),
 	nodeCount_(0),
 	wayCount_(0)
 {
+	for (int i = 0; i < TES_COLUMN_COUNT; i++)
+	{
+		if (columnar)
+		{
+			columnBuffers_[i] = std::make_unique<DynamicBuffer>(64 * 1024);
+			columnWriters_[i] = std::make_unique<BufferWriter>(columnBuffers_[i].get());
+			columns_[i] = columnWriters_[i].get();
+		}
+		else
+		{
+			columns_[i] = &out_;
+		}
+	}
 }
 
 
@@ -38,12 +52,30 @@ void TesWriter::write()
 	writeTagTables();
 	writeRelationTables();  
 	writeFeatures();
-	out_.writeByte(0); // no removed features
+	out(TesColumn::IDS).writeByte(0); // no removed features
 	writeExportTable();
+	if (columnWriters_[0]) writeColumns();
 	out_.flush();
 }
 
 
+void TesWriter::writeColumns()
+{
+	ByteBlock columns[TES_COLUMN_COUNT];
+	out_.writeVarint(TES_COLUMN_COUNT);
+	for (int i = 0; i < TES_COLUMN_COUNT; i++)
+	{
+		columnWriters_[i]->flush();
+		columns[i] = columnBuffers_[i]->takeBytes();
+		out_.writeVarint(columns[i].size());
+	}
+	for (const ByteBlock& column : columns)
+	{
+		out_.writeBytes(column.data(), column.size());
+	}
+}
+
+
 void TesWriter::writeFeatureIndex()
 {
 	assert(nodeCount_ == 0);
@@ -56,7 +88,7 @@ void TesWriter::writeFeatureIndex()
 	}
 	std::sort(features_.begin(), features_.end());
 
-	out_.writeVarint(features_.size());
+	out(TesColumn::IDS).writeVarint(features_.size());
 	int prevType = 0;
 	uint64_t prevId = 0;
 	for (int i=0; i<features_.size(); i++)
@@ -78,15 +110,15 @@ void TesWriter::writeFeatureIndex()
 					// In case there are only relations (i.e. we go
 					// from type 0 straight to type 2),
 					// write an additional 0-terminator
-					out_.writeByte(0);
+					out(TesColumn::IDS).writeByte(0);
 				}
 			}
-			out_.writeByte(0);
+			out(TesColumn::IDS).writeByte(0);
 			prevType = type;
 			prevId = 0;		// ID space starts over 
 		}
 		uint64_t id = feature.id();
-		out_.writeVarint(((id - prevId) << 1) | 1);
+		out(TesColumn::IDS).writeVarint(((id - prevId) << 1) | 1);
 			// Bit 0: changed_flag
 		prevId = id;
 		feature.feature()->setLocation(i);
@@ -103,11 +135,11 @@ void TesWriter::writeStrings()
 		// If a string exceeds 16M users, its counter could wrap to 0
 		// TesWriter will never encounter unused strings if it uses
 		// a Model that only loads tile data
-	out_.writeVarint(sharedElements_.size());
+	out(TesColumn::STRINGS).writeVarint(sharedElements_.size());
 	for (auto& e : sharedElements_)
 	{
 		TString* s = static_cast<TString*>(e);
-		out_.writeBytes(s->data(), s->size());
+		out(TesColumn::STRINGS).writeBytes(s->data(), s->size());
 		// LOG("STRING \"%s\"", s->string()->toString().c_str());
 	}
 	LOG("Wrote %d strings.", sharedElements_.size());
@@ -117,7 +149,7 @@ void TesWriter::writeStrings()
 void TesWriter::writeTagTables()
 {
 	gatherSharedItems(tile_.tagTables(), 2, 127);
-	out_.writeVarint(sharedElements_.size());
+	out(TesColumn::TAGS).writeVarint(sharedElements_.size());
 	for (const auto& e : sharedElements_)
 	{
 		writeTagTable(static_cast<TTagTable*>(e));
@@ -129,7 +161,7 @@ void TesWriter::writeTagTables()
 void TesWriter::writeRelationTables()
 {
 	gatherSharedItems(tile_.relationTables(), 2, 63);
-	out_.writeVarint(sharedElements_.size());
+	out(TesColumn::MEMBERS).writeVarint(sharedElements_.size());
 	for (const auto& e : sharedElements_)
 	{
 		writeRelationTable(static_cast<TRelationTable*>(e));
@@ -154,8 +186,11 @@ void TesWriter::gatherSharedItems(const ElementDeduplicator<T>& items,
 	std::sort(sharedElements_.begin(), sharedElements_.end(),
 		[](const TSharedElement* a, const TSharedElement* b)
 		{
-			// Sort in descending order based on number of users
-			return a->users() > b->users();
+			// Sort in descending order based on number of users;
+			// break ties by handle, so the order (and hence the TES)
+			// does not depend on how the items happen to be stored
+			if (a->users() != b->users()) return a->users() > b->users();
+			return a->handle() < b->handle();
 		});
 
 	if (compare)
@@ -166,7 +201,13 @@ void TesWriter::gatherSharedItems(const ElementDeduplicator<T>& items,
 		{
 			// Within each group, sort elements in their natural order
 			std::sort(sharedElements_.begin() + start, 
-				sharedElements_.begin() + end, compare);
+				sharedElements_.begin() + end,
+				[compare](const TSharedElement* a, const TSharedElement* b)
+				{
+					if (compare(a, b)) return true;
+					if (compare(b, a)) return false;
+					return a->handle() < b->handle();
+				});
 			start = end;
 			end = std::min(end * 128, sharedElements_.size());
 		}
@@ -208,7 +249,7 @@ void TesWriter::writeStringValue(TElement::Handle handle)
 {
 	TString* str = tile_.getString(handle);
 	assert(str);
-	out_.writeVarint(str->location());
+	out(TesColumn::TAGS).writeVarint(str->location());
 }
 
 void TesWriter::writeTagTable(const TTagTable* tags)
@@ -216,23 +257,23 @@ void TesWriter::writeTagTable(const TTagTable* tags)
 	assert(tags->anchor() <= tags->size() - 4);
 	assert((tags->size() & 1) == 0);
 	TagTablePtr pTags = tags->tags();
-	out_.writeVarint(tags->size() | (tags->hasLocalTags() ? 1 : 0));
+	out(TesColumn::TAGS).writeVarint(tags->size() | (tags->hasLocalTags() ? 1 : 0));
 	if (tags->hasLocalTags())
 	{
-		out_.writeVarint(tags->anchor() >> 1);
+		out(TesColumn::TAGS).writeVarint(tags->anchor() >> 1);
 		LocalTagIterator localTags(tags->handle(), pTags);
 		while (localTags.next())
 		{
 			TString* keyStr = tile_.getString(localTags.keyStringHandle());
 			assert(keyStr);
-			out_.writeVarint((keyStr->location() << 2) | (localTags.flags() & 3));
+			out(TesColumn::TAGS).writeVarint((keyStr->location() << 2) | (localTags.flags() & 3));
 			if (localTags.hasLocalStringValue())
 			{
 				writeStringValue(localTags.stringValueHandleFast());
 			}
 			else
 			{
-				out_.writeVarint(localTags.value());
+				out(TesColumn::TAGS).writeVarint(localTags.value());
 			}
 		}
 	}
@@ -244,7 +285,7 @@ void TesWriter::writeTagTable(const TTagTable* tags)
 		uint32_t key = globalTags.key();
 		assert((prevKey == 0) ? (key >= prevKey) : (key > prevKey));
 			// Global keys must be unique and ascending
-		out_.writeVarint(((key - prevKey) << 2) | (globalTags.keyBits() & 3));
+		out(TesColumn::TAGS).writeVarint(((key - prevKey) << 2) | (globalTags.keyBits() & 3));
 		prevKey = key;
 		if (globalTags.hasLocalStringValue())
 		{
@@ -252,7 +293,7 @@ void TesWriter::writeTagTable(const TTagTable* tags)
 		}
 		else
 		{
-			out_.writeVarint(globalTags.value());
+			out(TesColumn::TAGS).writeVarint(globalTags.value());
 		}
 	}
 }
@@ -283,11 +324,11 @@ void TesWriter::writeStub(const TFeature* feature, int flags)
 	flags |= TesFlags::TAGS_CHANGED | TesFlags::GEOMETRY_CHANGED;
 	flags |= (tags->users() > 1) ? TesFlags::SHARED_TAGS : 0;
 	flags |= feature->isRelationMember() ? TesFlags::RELATIONS_CHANGED : 0;
-	out_.writeByte(flags);
+	out(TesColumn::FLAGS).writeByte(flags);
 
 	if (flags & TesFlags::SHARED_TAGS)
 	{
-		out_.writeVarint(tags->location());
+		out(TesColumn::TAGS).writeVarint(tags->location());
 	}
 	else
 	{
@@ -300,7 +341,7 @@ void TesWriter::writeStub(const TFeature* feature, int flags)
 		if (rels->users() > 1)
 		{
 			// number of a shared reltable, with marker flag
-			out_.writeVarint((rels->location() << 1) | 1);	
+			out(TesColumn::MEMBERS).writeVarint((rels->location() << 1) | 1);	
 		}
 		else
 		{
@@ -321,8 +362,8 @@ void TesWriter::writeNode(TNode* node)
 	writeStub(node, flags);
 
 	Coordinate xy = node->xy();
-	out_.writeSignedVarint(static_cast<int64_t>(xy.x) - prevXY_.x);
-	out_.writeSignedVarint(static_cast<int64_t>(xy.y) - prevXY_.y);
+	out(TesColumn::COORDS).writeSignedVarint(static_cast<int64_t>(xy.x) - prevXY_.x);
+	out(TesColumn::COORDS).writeSignedVarint(static_cast<int64_t>(xy.y) - prevXY_.y);
 	prevXY_ = xy;
 }
 
@@ -383,17 +424,17 @@ void TesWriter::writeWay(TWay* way)
 	Coordinate first(static_cast<int32_t>(bounds.minX() + xDelta),
         static_cast<int32_t>(bounds.minY() + yDelta));
 
-	out_.writeVarint(coordCount);
-	out_.writeSignedVarint(static_cast<int64_t>(first.x) - prevXY_.x);
-	out_.writeSignedVarint(static_cast<int64_t>(first.y) - prevXY_.y);
+	out(TesColumn::COORDS).writeVarint(coordCount);
+	out(TesColumn::COORDS).writeSignedVarint(static_cast<int64_t>(first.x) - prevXY_.x);
+	out(TesColumn::COORDS).writeSignedVarint(static_cast<int64_t>(first.y) - prevXY_.y);
 	prevXY_ = first;
 	coordSize -= p - pBody.ptr();
-	out_.writeBytes(p, coordSize);
+	out(TesColumn::COORDS).writeBytes(p, coordSize);
 
 	if (hasFeatureNodes)
 	{
 		int skipReltablePointer = (wayRef.flags() & FeatureFlags::RELATION_MEMBER) ? 4 : 0;
-		out_.writeVarint(anchor - skipReltablePointer);
+		out(TesColumn::MEMBERS).writeVarint(anchor - skipReltablePointer);
 
 		// TODO: This is unintuitive; we need to adjust both the handle
 		//  and the pointer if a reltable is present
@@ -405,19 +446,19 @@ void TesWriter::writeWay(TWay* way)
 				uint32_t zigzagTexDelta = toZigzag(iter.texDelta());
 				if (iter.isInDifferentTile())
 				{
-					out_.writeVarint((zigzagTexDelta << 2) | 3);
-					out_.writeSignedVarint(iter.tipDelta());
+					out(TesColumn::MEMBERS).writeVarint((zigzagTexDelta << 2) | 3);
+					out(TesColumn::MEMBERS).writeSignedVarint(iter.tipDelta());
 				}
 				else
 				{
-					out_.writeVarint((zigzagTexDelta << 2) | 1);
+					out(TesColumn::MEMBERS).writeVarint((zigzagTexDelta << 2) | 1);
 				}
 			}
 			else
 			{
 				TReferencedElement* wayNode = tile_.getElement(iter.localHandle());
 				assert(wayNode);
-				out_.writeVarint(wayNode->location() << 1);
+				out(TesColumn::MEMBERS).writeVarint(wayNode->location() << 1);
 			}
 		}
 	}
@@ -444,7 +485,7 @@ void TesWriter::writeRelation(TRelation* relation)
 	writeBounds(relationRef);
 
 	int anchor = body->anchor();
-	out_.writeVarint(body->size() - anchor);
+	out(TesColumn::MEMBERS).writeVarint(body->size() - anchor);
 
 	MemberTableIterator iter(body->handle(), pBody);
 	while (iter.next())
@@ -455,12 +496,12 @@ void TesWriter::writeRelation(TRelation* relation)
 			uint32_t zigzagTexDelta = toZigzag(iter.texDelta());
 			if (iter.isInDifferentTile())
 			{
-				out_.writeVarint((zigzagTexDelta << 3) | 5 | roleChangedFlag);
-				out_.writeSignedVarint(iter.tipDelta());
+				out(TesColumn::MEMBERS).writeVarint((zigzagTexDelta << 3) | 5 | roleChangedFlag);
+				out(TesColumn::MEMBERS).writeSignedVarint(iter.tipDelta());
 			}
 			else
 			{
-				out_.writeVarint((zigzagTexDelta << 3) | 1 | roleChangedFlag);
+				out(TesColumn::MEMBERS).writeVarint((zigzagTexDelta << 3) | 1 | roleChangedFlag);
 			}
 		}
 		else
@@ -472,7 +513,7 @@ void TesWriter::writeRelation(TRelation* relation)
 			{
 				LOGS << "- " << member->id() << "\n";
 			}
-			out_.writeVarint((member->location() << 2) | roleChangedFlag);
+			out(TesColumn::MEMBERS).writeVarint((member->location() << 2) | roleChangedFlag);
 		}
 		if (roleChangedFlag)
 		{
@@ -487,7 +528,7 @@ void TesWriter::writeRelation(TRelation* relation)
 				assert(str);
 				roleValue = str->location() << 1;
 			}
-			out_.writeVarint(roleValue);
+			out(TesColumn::MEMBERS).writeVarint(roleValue);
 		}
 	}
 }
@@ -496,11 +537,11 @@ void TesWriter::writeRelation(TRelation* relation)
 void TesWriter::writeBounds(FeaturePtr feature)
 {
 	const Box& bounds = feature.bounds();
-	out_.writeSignedVarint(static_cast<int64_t>(bounds.minX()) - prevXY_.x);
-	out_.writeSignedVarint(static_cast<int64_t>(bounds.minY()) - prevXY_.y);
-	out_.writeVarint(static_cast<uint64_t>(
+	out(TesColumn::COORDS).writeSignedVarint(static_cast<int64_t>(bounds.minX()) - prevXY_.x);
+	out(TesColumn::COORDS).writeSignedVarint(static_cast<int64_t>(bounds.minY()) - prevXY_.y);
+	out(TesColumn::COORDS).writeVarint(static_cast<uint64_t>(
 		static_cast<int64_t>(bounds.maxX()) - bounds.minX()));
-	out_.writeVarint(static_cast<uint64_t>(
+	out(TesColumn::COORDS).writeVarint(static_cast<uint64_t>(
 		static_cast<int64_t>(bounds.maxY()) - bounds.minY()));
 	prevXY_ = bounds.bottomLeft();
 }
@@ -513,7 +554,7 @@ void TesWriter::writeRelationTable(const TRelationTable* relTable)
 	{
 		LOG("Relation table with size %d", relTable->size());
 	}
-	out_.writeVarint(relTable->size());
+	out(TesColumn::MEMBERS).writeVarint(relTable->size());
 	RelationTablePtr p (relTable->data());
 	RelationTableIterator iter(relTable->handle(), p);
 	bool seenForeign = false;
@@ -526,8 +567,8 @@ void TesWriter::writeRelationTable(const TRelationTable* relTable)
 			uint32_t zigzapTexDelta = toZigzag(iter.texDelta());
 			if (iter.isInDifferentTile())
 			{
-				out_.writeVarint((zigzapTexDelta << 1) | 1);
-				out_.writeSignedVarint(iter.tipDelta());
+				out(TesColumn::MEMBERS).writeVarint((zigzapTexDelta << 1) | 1);
+				out(TesColumn::MEMBERS).writeSignedVarint(iter.tipDelta());
 				seenTileChange = true;
 			}
 			else
@@ -536,7 +577,7 @@ void TesWriter::writeRelationTable(const TRelationTable* relTable)
 				assert(seenTileChange);
 					// The first foreign relation must always have the
 					// different_tile flag set
-				out_.writeVarint((zigzapTexDelta << 1) | 0);
+				out(TesColumn::MEMBERS).writeVarint((zigzapTexDelta << 1) | 0);
 			}
 			seenForeign = true;
 		}
@@ -552,7 +593,7 @@ void TesWriter::writeRelationTable(const TRelationTable* relTable)
 			assert(rel);
 			assert(rel->location() >= 0 && rel->location() < features_.size());
 			int relNumber = rel->location() - nodeCount_ - wayCount_;
-			out_.writeVarint(relNumber << 1);
+			out(TesColumn::MEMBERS).writeVarint(relNumber << 1);
 		}
 	}
 }
@@ -563,18 +604,18 @@ void TesWriter::writeExportTable()
 	TExportTable* exports = tile_.exportTable();
 	if(exports == nullptr)
 	{
-		out_.writeByte(0);
+		out(TesColumn::IDS).writeByte(0);
 		return;
 	}
 	TFeature** features = exports->features();
 	assert(features);
 	size_t count = exports->count();
-	out_.writeVarint(count << 1);
+	out(TesColumn::IDS).writeVarint(count << 1);
 	for(int i=0; i<count; i++)
 	{
 		TFeature* feature = features[i];
 		assert(feature);
-		out_.writeVarint(feature->location());
+		out(TesColumn::IDS).writeVarint(feature->location());
 	}
 }
 
@@ -3,11 +3,14 @@
 
 #pragma once
 
+#include <memory>
+#include <clarisma/util/Buffer.h>
 #include <clarisma/util/BufferWriter.h>
 #include <geodesk/geom/Box.h>
 #include <geodesk/geom/Coordinate.h>
 #include "tile/model/TileModel.h"
 #include "tile/model/TFeature.h"
+#include "TesColumn.h"
 
 class TNode;
 class TWay;
@@ -16,7 +19,10 @@ class TRelation;
 class TesWriter
 {
 public:
-	TesWriter(TileModel& tile, Buffer* out);
+	/// Writes the tile as a version 2 TES or, if `columnar`
+	/// is set, a version 3 TES (see TesColumn)
+	///
+	TesWriter(TileModel& tile, Buffer* out, bool columnar = false);
 
 	void write();
 
@@ -66,8 +72,17 @@ private:
 	void writeStub(const TFeature* feature, int flags);
 	void writeBounds(FeaturePtr feature);
 	void writeExportTable();
+	void writeColumns();
+
+	BufferWriter& out(TesColumn column)
+	{
+		return *columns_[static_cast<int>(column)];
+	}
 
 	BufferWriter out_;
+	BufferWriter* columns_[TES_COLUMN_COUNT];	// all &out_ unless columnar
+	std::unique_ptr<DynamicBuffer> columnBuffers_[TES_COLUMN_COUNT];
+	std::unique_ptr<BufferWriter> columnWriters_[TES_COLUMN_COUNT];
 	TileModel& tile_;
 	Coordinate prevXY_;
 	std::vector<SortedFeature> features_;
@@ -0,0 +1,56 @@
+// Copyright (c) 2025 Clarisma / GeoDesk contributors
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#include "TailLatencyTracker.h"
+#include <clarisma/cli/Console.h>
+#include <clarisma/cli/ConsoleWriter.h>
+
+using namespace clarisma;
+
+void TailLatencyTracker::begin()
+{
+	std::lock_guard lock(mutex_);
+	lastCompleted_.clear();
+	start_ = Clock::now();
+}
+
+void TailLatencyTracker::taskCompleted()
+{
+	Clock::time_point now = Clock::now();
+	std::thread::id thread = std::this_thread::get_id();
+	std::lock_guard lock(mutex_);
+	for (auto& entry : lastCompleted_)
+	{
+		if (entry.first == thread)
+		{
+			entry.second = now;
+			return;
+		}
+	}
+	lastCompleted_.emplace_back(thread, now);
+}
+
+void TailLatencyTracker::end()
+{
+	Clock::time_point now = Clock::now();
+	std::lock_guard lock(mutex_);
+	std::chrono::duration<double> idle(0);
+	for (const auto& entry : lastCompleted_)
+	{
+		idle += now - entry.second;
+	}
+	int idleWorkers = threadCount_ - static_cast<int>(lastCompleted_.size());
+	if (idleWorkers > 0) idle += (now - start_) * idleWorkers;
+	idleCoreSeconds_ += idle.count();
+	elapsedSeconds_ += std::chrono::duration<double>(now - start_).count();
+}
+
+void TailLatencyTracker::report(const char* phase) const
+{
+	if (Console::verbosity() < Console::Verbosity::VERBOSE) return;
+	char buf[128];
+	snprintf(buf, sizeof(buf),
+		"%s: %.1f idle core-seconds at end of tasks (%.1f%% of %d threads x %.1fs)",
+		phase, idleCoreSeconds_, idlePercentage(), threadCount_, elapsedSeconds_);
+	ConsoleWriter().timestamp() << buf;
+}
@@ -0,0 +1,52 @@
+// Copyright (c) 2025 Clarisma / GeoDesk contributors
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#pragma once
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/// Measures how much core time is lost at the end of a phase (or of
+/// a batch within a phase), when some workers have run out of tasks
+/// while others are still busy.
+///
+/// Worker threads call taskCompleted() after each task; end() then
+/// adds up, for every worker, the time between its last completed
+/// task and the end of the phase. Workers that didn't complete any
+/// task are counted as idle for the entire phase.
+///
+class TailLatencyTracker
+{
+public:
+	explicit TailLatencyTracker(int threadCount) :
+		threadCount_(threadCount) {}
+
+	void begin();
+	void taskCompleted();
+	void end();
+
+	double idleCoreSeconds() const { return idleCoreSeconds_; }
+	double elapsedSeconds() const { return elapsedSeconds_; }
+
+	/// Percentage of the phase's total core time that was spent idle
+	///
+	double idlePercentage() const
+	{
+		double coreSeconds = elapsedSeconds_ * threadCount_;
+		return coreSeconds > 0 ? idleCoreSeconds_ * 100 / coreSeconds : 0;
+	}
+
+	void report(const char* phase) const;
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	std::mutex mutex_;
+	std::vector<std::pair<std::thread::id, Clock::time_point>> lastCompleted_;
+	Clock::time_point start_;
+	double idleCoreSeconds_ = 0;
+	double elapsedSeconds_ = 0;
+	int threadCount_;
+};
@@ -2,14 +2,17 @@
 // SPDX-License-Identifier: AGPL-3.0-only
 
 #include "TileTaskEngine.h"
+#include <algorithm>
 #include <clarisma/cli/Console.h>
+#include <geodesk/feature/TileIndexEntry.h>
 #include <geodesk/query/TileIndexWalker.h>
 
 TileTaskEngine::TileTaskEngine(FeatureStore& store, int threadCount) :
 	TaskEngine(threadCount),
 	store_(store),
 	workCompleted_(0),
-	workPerTile_(0)
+	workPerTile_(0),
+	tail_(threadCount)
 {
 }
 
@@ -34,17 +37,62 @@ void TileTaskEngine::run()
 	}
 	while (tiw.next());
 
+	if (largestFirst_) sortLargestFirst(tiles);
+
 	workPerTile_ = 100.0 / tiles.size();
 	workCompleted_ = 0;
 
 	preProcess();		// TODO: This could be done on the output thread
 	start();
+	tail_.begin();
 	for (const auto& tile : tiles)
 	{
 		prepareTile(tile.first, tile.second);
 		postWork(TileTask(tile.first, tile.second));
 	}
 	end();
+	tail_.end();
+	tail_.report("Tasks");
+}
+
+
+// Tiles are stored in contiguous runs of pages, so we estimate the size
+// of each tile by the distance from its first page to the first page
+// of the next tile; this only needs the tile index, so we don't have
+// to touch the tiles themselves (free pages in between make a tile
+// appear larger, which is good enough for scheduling)
+void TileTaskEngine::sortLargestFirst(std::vector<std::pair<Tip, Tile>>& tiles) const
+{
+	DataPtr tileIndex = store_.tileIndex();
+	std::vector<std::pair<uint32_t, size_t>> pages;
+	pages.reserve(tiles.size());
+	for (size_t i = 0; i < tiles.size(); i++)
+	{
+		pages.emplace_back(TileIndexEntry((tileIndex + tiles[i].first * 4).getUnsignedInt()).page(), i);
+	}
+	std::sort(pages.begin(), pages.end());
+
+	std::vector<std::pair<uint32_t, size_t>> sizes;
+	sizes.reserve(tiles.size());
+	for (size_t i = 0; i < pages.size(); i++)
+	{
+		// The size of the last tile is unknown, so we hand it out
+		// first rather than risk starting a large tile at the end
+		uint32_t size = i + 1 < pages.size() ?
+			pages[i + 1].first - pages[i].first : UINT32_MAX;
+		sizes.emplace_back(size, pages[i].second);
+	}
+	std::sort(sizes.begin(), sizes.end(),
+		[](const auto& a, const auto& b)
+		{
+			// Break ties by tile-index order, so the order is
+			// the same for every run
+			return a.first > b.first || (a.first == b.first && a.second < b.second);
+		});
+	std::vector<std::pair<Tip, Tile>> ordered;
+	ordered.reserve(tiles.size());
+	for (const auto& size : sizes) ordered.push_back(tiles[size.second]);
+	tiles = std::move(ordered);
 }
 
 
@@ -59,4 +107,5 @@ void TileTaskEngine::processTask(TileOutputTask& task)
 void TileTaskContext::processTask(TileTask& task)  // CRTP override
 {
 	engine_->processTile(task.tip(), task.tile());
+	engine_->tail_.taskCompleted();
 }
\ No newline at end of file
@@ -3,12 +3,14 @@
 
 #pragma once
 
+#include <vector>
 #include <clarisma/alloc/Block.h>
 #include <clarisma/io/File.h>
 #include <clarisma/thread/TaskEngine.h>
 #include <clarisma/util/log.h>
 #include <geodesk/feature/Tip.h>
 #include <geodesk/geom/Tile.h>
+#include "TailLatencyTracker.h"
 
 class TileTaskEngine;
 namespace geodesk {
@@ -73,6 +75,7 @@ public:
 
 	void run();
 	void processTask(TileOutputTask& task);		// CRTP override
+	void setLargestFirst(bool b) { largestFirst_ = b; }
 	
 	void postOutput(Tip tip, ByteBlock&& data)
 	{
@@ -89,9 +92,15 @@ protected:
 	FeatureStore& store() const { return store_; };
 
 private:
+	void sortLargestFirst(std::vector<std::pair<Tip, Tile>>& tiles) const;
+
 	FeatureStore& store_;
 	double workPerTile_;
 	double workCompleted_;
+	TailLatencyTracker tail_;
+	bool largestFirst_ = false;
+		// If set, tiles are handed out in order of their size
+		// (largest first) rather than in tile-index order
 
 	friend class TileTaskContext;
 };
@@ -21,4 +21,8 @@ def run(args, *, input=None, env=None):
     return result
 
 gol = "d:\\geodesk\\tests\\monaco"
-mapdata_dir = "e:\\geodesk\\mapdata\\"
\ No newline at end of file
+mapdata_dir = "e:\\geodesk\\mapdata\\"
+def has_command(name):
+    # Some commands are only built with GOL_DIAGNOSTICS or GOL_EXPERIMENTAL
+    res = run([name])
+    return "Unknown command" not in res.stdout + res.stderr
@@ -0,0 +1,41 @@
+import os
+import shutil
+from conftest import run, gol, mapdata_dir
+
+def test_check_gob():
+    res = run(["build", "check-src", mapdata_dir + "liguria", "-Y"])
+    assert res.returncode == 0
+    res = run(["save", "check-src"])
+    assert res.returncode == 0
+    res = run(["check", "check-src.gob"])
+    assert res.returncode == 0
+
+    # Flip a byte in the last tile; its checksum no longer matches
+    shutil.copyfile("check-src.gob", "check-bad.gob")
+    size = os.path.getsize("check-bad.gob")
+    with open("check-bad.gob", "r+b") as f:
+        f.seek(size - 16)
+        b = f.read(1)
+        f.seek(size - 16)
+        f.write(bytes([b[0] ^ 0xff]))
+    res = run(["check", "check-bad.gob"])
+    assert res.returncode != 0
+    assert not os.path.exists("check-bad.gol")
+
+def test_check_gob_relations():
+    # Monaco's tiles hold relations (its boundaries and routes), so
+    # their TES contains relation tables that members refer to
+    res = run(["query", gol, "r", "-f", "count"])
+    assert res.returncode == 0
+    relation_count = int(res.stdout)
+    assert relation_count > 0
+    res = run(["save", gol, "check-rels"])
+    assert res.returncode == 0
+    res = run(["check", "check-rels.gob"])
+    assert res.returncode == 0
+
+    res = run(["load", "check-rels", "check-rels", "-Y"])
+    assert res.returncode == 0
+    res = run(["query", "check-rels", "r", "-f", "count"])
+    assert res.returncode == 0
+    assert int(res.stdout) == relation_count
@@ -0,0 +1,53 @@
+import filecmp
+import os
+import shutil
+import time
+from conftest import run, mapdata_dir
+
+def load_seconds(gol, gob):
+    start = time.perf_counter()
+    res = run(["load", gol, gob, "-Y"])
+    assert res.returncode == 0
+    return time.perf_counter() - start
+
+def test_compiled():
+    res = run(["build", "compiled-src", mapdata_dir + "liguria", "-Y"])
+    assert res.returncode == 0
+    res = run(["save", "compiled-src", "compiled-tes"])
+    assert res.returncode == 0
+    res = run(["save", "compiled-src", "compiled-bin", "--compiled"])
+    assert res.returncode == 0
+    res = run(["check", "compiled-bin.gob"])
+    assert res.returncode == 0
+
+    print("format,gob_size,load_seconds")
+    for name in ["compiled-tes", "compiled-bin"]:
+        seconds = load_seconds(name + "-loaded", name)
+        print(f"{name},{os.path.getsize(name + '.gob')},{seconds:.3f}")
+
+    # Both must yield the same tiles
+    res = run(["save", "compiled-bin-loaded", "compiled-roundtrip"])
+    assert res.returncode == 0
+    assert filecmp.cmp("compiled-roundtrip.gob", "compiled-tes.gob", shallow=False)
+
+def test_compiled_corrupt():
+    res = run(["build", "compiled-src", mapdata_dir + "liguria", "-Y"])
+    assert res.returncode == 0
+    res = run(["save", "compiled-src", "compiled-bin", "--compiled"])
+    assert res.returncode == 0
+
+    # Flip a byte in the last tile; loading must fail with an error
+    # rather than crash
+    shutil.copyfile("compiled-bin.gob", "compiled-bad.gob")
+    size = os.path.getsize("compiled-bad.gob")
+    with open("compiled-bad.gob", "r+b") as f:
+        f.seek(size - 16)
+        b = f.read(1)
+        f.seek(size - 16)
+        f.write(bytes([b[0] ^ 0xff]))
+    res = run(["load", "compiled-bad", "compiled-bad", "-Y"])
+    assert res.returncode != 0
+    assert (res.stdout + res.stderr).strip() != ""
+
+if __name__ == "__main__":
+    test_compiled()
@@ -0,0 +1,112 @@
+import os
+import filecmp
+import glob
+import pytest
+from conftest import run, has_command, mapdata_dir
+
+# Western half of Liguria
+part_bbox = "7.4,43.7,8.6,44.7"
+
+@pytest.fixture(scope="module")
+def libraries():
+    # Loading into a library left over from an earlier run would
+    # add to it rather than create it
+    for path in glob.glob("delta-*.gol") + glob.glob("delta-*.gob"):
+        os.remove(path)
+
+    res = run(["build", "delta-src", mapdata_dir + "liguria", "-Y"])
+    assert res.returncode == 0
+    res = run(["save", "delta-src"])
+    assert res.returncode == 0
+
+    # A library with all tiles, and one with only some of them
+    res = run(["load", "delta-all", "delta-src", "-Y"])
+    assert res.returncode == 0
+    res = run(["save", "delta-all"])
+    assert res.returncode == 0
+    res = run(["load", "delta-part", "delta-src", "-b", part_bbox, "-Y"])
+    assert res.returncode == 0
+    res = run(["save", "delta-part"])
+    assert res.returncode == 0
+
+    # The tiles that part lacks
+    res = run(["save", "delta-all", "delta-up", "--since", "delta-part"])
+    assert res.returncode == 0
+
+def test_delta_added_tiles(libraries):
+    # part + delta must equal all
+    res = run(["load", "delta-up-applied", "delta-part", "-Y"])
+    assert res.returncode == 0
+    res = run(["load", "delta-up-applied", "delta-up"])
+    assert res.returncode == 0
+    res = run(["save", "delta-up-applied"])
+    assert res.returncode == 0
+    assert filecmp.cmp("delta-up-applied.gob", "delta-all.gob", shallow=False)
+
+def test_delta_deleted_tiles(libraries):
+    # all + delta must equal part
+    res = run(["save", "delta-part", "delta-down", "--since", "delta-all"])
+    assert res.returncode == 0
+    res = run(["load", "delta-down-applied", "delta-all", "-Y"])
+    assert res.returncode == 0
+    res = run(["load", "delta-down-applied", "delta-down"])
+    assert res.returncode == 0
+    res = run(["save", "delta-down-applied"])
+    assert res.returncode == 0
+    assert filecmp.cmp("delta-down-applied.gob", "delta-part.gob", shallow=False)
+
+def test_delta_needs_base(libraries):
+    res = run(["save", "delta-all", "delta-same", "--since", "delta-all"])
+    assert res.returncode == 0
+    # A delta cannot create a library
+    res = run(["load", "delta-missing", "delta-same", "-Y"])
+    assert res.returncode != 0
+
+# A cafe in Genoa, which changes the contents of a tile that
+# the base already has
+new_node_osc = """<?xml version="1.0" encoding="UTF-8"?>
+<osmChange version="0.6">
+<create>
+<node id="99999999999" version="1" lat="44.4076" lon="8.9342">
+<tag k="amenity" v="cafe"/>
+</node>
+</create>
+</osmChange>
+"""
+
+@pytest.mark.skipif(not has_command("update"), reason="requires GOL_EXPERIMENTAL")
+def test_delta_changed_tile(libraries, tmp_path):
+    osc = tmp_path / "new-node.osc"
+    osc.write_text(new_node_osc)
+    res = run(["load", "delta-changed", "delta-src", "-Y"])
+    assert res.returncode == 0
+    res = run(["update", "delta-changed", str(osc)])
+    assert res.returncode == 0
+    res = run(["save", "delta-changed"])
+    assert res.returncode == 0
+
+    # all + delta must equal changed
+    res = run(["save", "delta-changed", "delta-change", "--since", "delta-all"])
+    assert res.returncode == 0
+    res = run(["load", "delta-change-applied", "delta-all", "-Y"])
+    assert res.returncode == 0
+    res = run(["load", "delta-change-applied", "delta-change"])
+    assert res.returncode == 0
+    res = run(["save", "delta-change-applied"])
+    assert res.returncode == 0
+    assert filecmp.cmp("delta-change-applied.gob", "delta-changed.gob", shallow=False)
+
+    # Only the changed tiles are saved
+    assert os.path.getsize("delta-change.gob") < os.path.getsize("delta-all.gob") / 10
+
+def test_delta_rejects_area(libraries):
+    res = run(["load", "delta-area", "delta-all", "-Y"])
+    assert res.returncode == 0
+    # Applying part of a delta would leave the library at a
+    # revision that it only partially has
+    res = run(["load", "delta-area", "delta-up", "-b", part_bbox])
+    assert res.returncode != 0
+    # Nor can a delta be saved for part of a library
+    res = run(["save", "delta-all", "delta-area-up", "--since", "delta-part",
+        "-b", part_bbox])
+    assert res.returncode != 0
@@ -0,0 +1,17 @@
+import random
+import pytest
+from conftest import run, has_command, mapdata_dir
+
+@pytest.mark.skipif(not has_command("bench"), reason="requires GOL_DIAGNOSTICS")
+def test_patch():
+    res = run(["build", "patch-src", mapdata_dir + "liguria", "-Y"])
+    assert res.returncode == 0
+    # Retags random features of every tile, then checks that each
+    # patched tile matches the same tile rebuilt from scratch
+    seed = random.randrange(1, 2 ** 62)
+    res = run(["bench", "tile-patch", "patch-src", "3", str(seed)])
+    print(res.stdout)
+    assert res.returncode == 0, f"failed with seed {seed}"
+
+if __name__ == "__main__":
+    test_patch()
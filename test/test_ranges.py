@@ -0,0 +1,66 @@
+import filecmp
+import http.server
+import os
+import threading
+from conftest import run, mapdata_dir
+
+# Area around Genoa
+area_bbox = "8.7,44.3,9.1,44.5"
+
+class RangeHandler(http.server.SimpleHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+
+    def do_GET(self):
+        path = self.translate_path(self.path)
+        size = os.path.getsize(path)
+        with open(path, "rb") as f:
+            range = self.headers.get("Range")
+            if range:
+                start, end = range.split("=")[1].split("-")
+                start = int(start)
+                end = int(end) if end else size - 1
+                f.seek(start)
+                data = f.read(end - start + 1)
+                self.send_response(206)
+                self.send_header("Content-Range", f"bytes {start}-{end}/{size}")
+            else:
+                data = f.read()
+                self.send_response(200)
+        self.send_header("Content-Length", str(len(data)))
+        self.send_header("ETag", '"gob"')
+        self.end_headers()
+        self.wfile.write(data)
+
+    def log_message(self, format, *args):
+        pass
+
+def test_ranges():
+    res = run(["build", "ranges-src", mapdata_dir + "liguria", "-Y"])
+    assert res.returncode == 0
+    res = run(["save", "ranges-src", "ranges-index", "--tile-order", "index"])
+    assert res.returncode == 0
+    res = run(["save", "ranges-src", "ranges-hilbert"])
+    assert res.returncode == 0
+
+    server = http.server.ThreadingHTTPServer(("127.0.0.1", 0), RangeHandler)
+    threading.Thread(target=server.serve_forever, daemon=True).start()
+    url = f"http://127.0.0.1:{server.server_address[1]}/"
+    try:
+        for name in ["ranges-index", "ranges-hilbert"]:
+            res = run(["load", name + "-area", url + name + ".gob",
+                "-b", area_bbox, "-v", "-Y"])
+            assert res.returncode == 0
+            for line in (res.stdout + res.stderr).splitlines():
+                if "range(s)" in line:
+                    print(f"{name}: {line.strip()}")
+    finally:
+        server.shutdown()
+
+    # The order of tiles in the Bundle must not affect what is loaded
+    for name in ["ranges-index", "ranges-hilbert"]:
+        res = run(["save", name + "-area"])
+        assert res.returncode == 0
+    assert filecmp.cmp("ranges-index-area.gob", "ranges-hilbert-area.gob", shallow=False)
+
+if __name__ == "__main__":
+    test_ranges()
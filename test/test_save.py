@@ -23,5 +23,14 @@ def test_save():
         size_gob = os.path.getsize(file + ".gob")
         print(f"{file},{size_pbf},{size_gol},{size_gob},{size_gol/size_pbf:.3f},{size_gob/size_pbf:.3f}")
 
+def test_save_verify_encoding():
+    # BlobTesWriter must produce the same TES as reading each tile
+    # into a TileModel and writing it with TesWriter
+    res = run(["build", "encoding-src", mapdata_dir + "liguria", "-w", "-Y"])
+    assert res.returncode == 0
+    for options in [[], ["--columnar"], ["-w"], ["-w", "--columnar"]]:
+        res = run(["save", "encoding-src", "encoding-out", "--verify-encoding"] + options)
+        assert res.returncode == 0, res.stdout + res.stderr
+
 if __name__ == "__main__":
     test_save()
\ No newline at end of file
@@ -0,0 +1,59 @@
+#!/usr/bin/env python3
+# Compares cold-cache bbox query times of GOLs built with different
+# tile layouts (--tile-layout). Dropping the page cache requires root
+# on Linux; elsewhere, the queries run against a warm cache and the
+# results are mostly meaningless.
+
+import argparse
+import os
+import subprocess
+import sys
+import time
+
+def drop_caches():
+    if sys.platform.startswith("linux") and os.geteuid() == 0:
+        subprocess.run(["sync"], check=True)
+        with open("/proc/sys/vm/drop_caches", "w") as f:
+            f.write("3\n")
+        return True
+    return False
+
+def build(gol, pbf, golpath, layout):
+    subprocess.run([gol, "build", golpath, pbf, "-Y", "-q",
+        "--tile-layout", layout], check=True)
+
+def query(gol, golpath, bbox):
+    start = time.perf_counter()
+    subprocess.run([gol, "query", golpath, "*", "-b", bbox, "-f", "count"],
+        check=True, stdout=subprocess.DEVNULL)
+    return time.perf_counter() - start
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Measure cold-cache bbox queries for each tile layout")
+    parser.add_argument("pbf", help="OSM PBF file to build from")
+    parser.add_argument("bbox", nargs="+", help="Bounding boxes (W,S,E,N)")
+    parser.add_argument("--gol", default="gol", help="Path of the gol executable")
+    parser.add_argument("--layouts", default="none,hilbert,zoom",
+        help="Comma-separated list of layouts to compare")
+    parser.add_argument("--runs", type=int, default=3, help="Runs per query")
+    args = parser.parse_args()
+
+    base = os.path.splitext(os.path.splitext(args.pbf)[0])[0]
+    for layout in args.layouts.split(","):
+        golpath = f"{base}-{layout}.gol"
+        build(args.gol, args.pbf, golpath, layout)
+        total = 0
+        for bbox in args.bbox:
+            best = None
+            for _ in range(args.runs):
+                cold = drop_caches()
+                t = query(args.gol, golpath, bbox)
+                best = t if best is None else min(best, t)
+            total += best
+            print(f"{layout:8} {bbox:40} {best * 1000:10.1f} ms"
+                + ("" if cold else " (warm cache)"))
+        print(f"{layout:8} {'total':40} {total * 1000:10.1f} ms")
+
+if __name__ == "__main__":
+    main()